@@ -7,6 +7,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -201,7 +202,7 @@ void create_new_game(scene_t *scene, body_t *ball, body_t *paddle) {
   ball_paddle_collision(scene, ball, paddle);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
   srand(time(0));
   scene_t *demo = scene_init();
   body_t *paddle;
@@ -209,6 +210,13 @@ int main() {
   body_t *ball = create_ball(demo);
   create_boxes(demo, ball);
   sdl_init(min, max);
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--batched") == 0) {
+      sdl_set_render_mode(RENDER_BATCHED);
+    } else if (strcmp(argv[arg], "--sweep-and-prune") == 0) {
+      scene_set_broadphase_mode(demo, BROADPHASE_SWEEP_AND_PRUNE);
+    }
+  }
   create_pegs(demo, ball);
   ball_paddle_collision(demo, ball, paddle);
   while (!sdl_is_done()) {
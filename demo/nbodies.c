@@ -6,6 +6,7 @@
 #include "sdl_wrapper.h"
 #include "sprite.h"
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
 const int SCREEN_SIZE_X = 1000;
@@ -53,10 +54,13 @@ void add_gravity(scene_t *scene) {
   }
 }
 
-int main() {
+int main(int argc, char *argv[]) {
   scene_t *scene = scene_init();
   make_bodies(scene);
   sdl_init(min, max);
+  if (argc > 1 && strcmp(argv[1], "--batched") == 0) {
+    sdl_set_render_mode(RENDER_BATCHED);
+  }
   // srand(time(0));
   add_gravity(scene);
 
@@ -5,6 +5,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #define CIRCLE_POINTS 40
@@ -218,13 +219,20 @@ void add_walls(scene_t *scene) {
   scene_add_body(scene, body);
 }
 
-int main(void) {
+int main(int argc, char *argv[]) {
   // Initialize the random number generator
   srand(time(NULL));
 
   // Initialize scene
   sdl_init(VEC_ZERO, MAX);
   scene_t *scene = scene_init();
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--batched") == 0) {
+      sdl_set_render_mode(RENDER_BATCHED);
+    } else if (strcmp(argv[arg], "--sweep-and-prune") == 0) {
+      scene_set_broadphase_mode(scene, BROADPHASE_SWEEP_AND_PRUNE);
+    }
+  }
 
   // Add elements to the scene
   add_gravity_body(scene);
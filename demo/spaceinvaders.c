@@ -5,6 +5,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -208,7 +209,7 @@ int invaders_shoot(scene_t *scene, body_t *defender, int i) {
   return i;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
   srand(time(0));
   scene_t *demo = scene_init();
   body_t *defender = make_defender(demo);
@@ -216,6 +217,13 @@ int main() {
   make_invaders(demo, defender);
   int i = 0;
   sdl_init(min, max);
+  for (int arg = 1; arg < argc; arg++) {
+    if (strcmp(argv[arg], "--batched") == 0) {
+      sdl_set_render_mode(RENDER_BATCHED);
+    } else if (strcmp(argv[arg], "--sweep-and-prune") == 0) {
+      scene_set_broadphase_mode(demo, BROADPHASE_SWEEP_AND_PRUNE);
+    }
+  }
   sdl_event_args(aux);
   while (!sdl_is_done()) {
     i++;
@@ -44,6 +44,8 @@ typedef struct game_state {
   scene_t *scene;
   body_t *rocket;
   body_t *score_display;
+  // Owned by the scene
+  particle_field_t *shooting_stars;
   game_texts_t *texts;
 
   int ticks;
@@ -58,6 +60,8 @@ typedef struct game_state {
   vector_t arena_max;
 
   int thrust_ticks_remaining;
+  animation_t *rocket_idle_animation;
+  animation_t *rocket_thrust_animation;
 
   bool quit_game;
 } game_state_t;
@@ -19,14 +19,30 @@
 
 typedef struct game_state game_state_t;
 
+/**
+ * The textures to pack into the renderer's texture atlas: the rocket's
+ * animation frames and the asteroid, fence, and endzone textures.
+ */
+extern char *GB_ATLAS_TEXTURES[];
+extern const size_t GB_ATLAS_TEXTURE_COUNT;
+
 enum space_body_type_t *space_body_type_init(enum space_body_type_t b);
 
 /**
- * Makes a shooting star.
+ * Adds the particle field that shooting stars fly across the screen in.
  *
  * @param scene a pointer to a scene returned from scene_init()
+ * @return the field, which the scene owns
  */
-void game_build_shooting_star(scene_t *scene);
+particle_field_t *game_build_shooting_stars(scene_t *scene);
+
+/**
+ * Makes a shooting star, and forgets the ones that have crossed the arena.
+ *
+ * @param state a pointer to a game_state_t struct whose shooting_stars
+ *   field was returned from game_build_shooting_stars()
+ */
+void game_build_shooting_star(game_state_t *state);
 
 /**
  * Draws the background and the stars.
@@ -42,6 +58,23 @@ void game_build_draw_starry_night(scene_t *scene);
  */
 void game_build_draw_asteroids(game_state_t *state);
 
+/**
+ * Creates the rocket's idle and thrust animations.
+ * They are shared by every rocket, and freed with the game state.
+ *
+ * @param state the game state
+ */
+void game_build_rocket_animations(game_state_t *state);
+
+/**
+ * Shows a rocket's thrust animation while the game state has thrust ticks
+ * remaining, and its idle animation otherwise.
+ *
+ * @param state the game state
+ * @param rocket a rocket returned from game_build_rocket()
+ */
+void game_build_update_rocket_animation(game_state_t *state, body_t *rocket);
+
 /**
  * Creates the rocket.
  *
@@ -85,9 +118,12 @@ void game_build_endzone(game_state_t *state);
  * The asteroid is randomly assigned to be a GOOD_OBSTACLE or BAD_OBSTACLE.
  *
  * @param state a pointer to a game_state_t struct
+ * @param shape the asteroids' shared collision proxy, from
+ *   shape_intern_circle() with GB_ASTEROID_RADIUS
  * @param centroid a pointer to the rocket in the scene.
  */
-void game_build_asteroid(game_state_t *state, vector_t centroid);
+void game_build_asteroid(game_state_t *state, shape_t *shape,
+                         vector_t centroid);
 
 /**
  * Builds the score, timer, health, and level messages
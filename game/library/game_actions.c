@@ -107,6 +107,7 @@ void game_setup(game_state_t *state, vector_t screen_min, vector_t screen_max)
 {
     scene_t *scene = scene_init();
     game_build_draw_starry_night(scene);
+    state->shooting_stars = game_build_shooting_stars(scene);
     body_t *score_display =
         game_build_score_keeper(scene, SCORE_DISPLAY_WIDTH, SCORE_DISPLAY_HEIGHT);
     state->scene = scene;
@@ -137,6 +138,7 @@ void game_actions_thrust_rocket(double angle, double scale,
     body_add_impulse(state->rocket,
                      vec_multiply(GA_ROCKET_VELOCITY_SCALE, move_vector));
     state->thrust_ticks_remaining = GA_MAX_THRUST_TICKS;
+    game_build_update_rocket_animation(state, state->rocket);
 }
 
 void handle_key_press(char key, key_event_type_t type, double held_time,
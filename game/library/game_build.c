@@ -30,23 +30,38 @@ const rgb_color_t GB_BACKGROUND_COLOR = {.r = 0, .g = 0, .b = .55};
 const int GB_DISTANCE_BETWEEN_STARS = 125;
 const double GB_FREQUENCY_FOR_STARS = 50.0;
 const rgb_color_t GB_STAR_COLOR = {.r = 1, .g = 1, .b = 1};
-const int GB_STAR_NUM_OF_POINTS = 4;
-const int GB_STAR_MIN_LENGTH = 2;
-const int GB_STAR_MAX_LENGTH = 4;
+const double GB_STAR_SIZE = 3;
 
 const int GB_ROCKET_RADIUS = 30;
 const double GB_ROCKET_MASS = 100;
 const rgb_color_t GB_ROCKET_COLOR = {.r = 0, .g = 0, .b = 0};
 
 const int GB_SHOOTING_STAR_RADIUS = 3;
-const int GB_SHOOTING_STAR_MASS = INFINITY;
 const rgb_color_t GB_SHOOTING_STAR_COLOR = {.r = 1, .g = 1, .b = 1};
 const vector_t GB_SHOOTING_STAR_VELCOITY = {.x = 700, .y = 0};
 
 const rgb_color_t SCORE_DISPLAY_COLOR = {.r = 1, .g = 0, .b = 0};
 const vector_t SCORE_DISPLAY_LEFT = {.x = 40, .y = GB_SCREEN_SIZE_Y - 25};
 
-const int ROCKET_TEXTURE_COUNT = 4;
+char *GB_ROCKET_IDLE_TEXTURE = "game/textures/rocket/rocket_idle.png";
+char *GB_ROCKET_THRUST_TEXTURES[] = {"game/textures/rocket/rocket1.png",
+                                     "game/textures/rocket/rocket2.png",
+                                     "game/textures/rocket/rocket3.png",
+                                     "game/textures/rocket/rocket4.png"};
+const size_t GB_ROCKET_TICKS_PER_FRAME = 1;
+
+char *GB_ATLAS_TEXTURES[] = {"game/textures/rocket/rocket_idle.png",
+                             "game/textures/rocket/rocket1.png",
+                             "game/textures/rocket/rocket2.png",
+                             "game/textures/rocket/rocket3.png",
+                             "game/textures/rocket/rocket4.png",
+                             "game/textures/good_asteroid.png",
+                             "game/textures/bad_asteroid.png",
+                             "game/textures/vertical_fence.png",
+                             "game/textures/horizontal_fence.png",
+                             "game/textures/endzone.png"};
+const size_t GB_ATLAS_TEXTURE_COUNT =
+    sizeof(GB_ATLAS_TEXTURES) / sizeof(*GB_ATLAS_TEXTURES);
 
 const int GB_TEXT_WIDTH = 100;
 const int GB_TEXT_HEIGHT = 30;
@@ -97,6 +112,16 @@ const rgb_color_t GB_RED = {.r = 1, .g = 0, .b = 0};
 
 const int GB_MAX_THRUST_TICKS = 10;
 
+// The layers bodies are drawn in, back to front (see body_set_render_layer())
+const int GB_STAR_LAYER = -1;
+const int GB_SCREEN_LAYER = 0;
+const int GB_SHOOTING_STAR_LAYER = 1;
+const int GB_OBSTACLE_LAYER = 2;
+const int GB_ROCKET_LAYER = 3;
+const int GB_SCORE_DISPLAY_LAYER = 4;
+const int GB_HELP_LAYER = 5;
+const int GB_STATIONARY_ROCKET_LAYER = 6;
+
 enum space_body_type_t
 {
     GOOD_OBSTACLE,
@@ -118,17 +143,25 @@ enum space_body_type_t *space_body_type_init(enum space_body_type_t b)
     return body_type;
 }
 
-void game_build_shooting_star(scene_t *scene)
+particle_field_t *game_build_shooting_stars(scene_t *scene)
+{
+    particle_field_t *shooting_stars = particle_field_init();
+    particle_field_set_velocity(shooting_stars, GB_SHOOTING_STAR_VELCOITY);
+    particle_field_set_render_layer(shooting_stars, GB_SHOOTING_STAR_LAYER);
+    scene_add_particle_field(scene, shooting_stars);
+    return shooting_stars;
+}
+
+void game_build_shooting_star(game_state_t *state)
 {
-    list_t *shooting_star_list = sprite_make_circle(GB_SHOOTING_STAR_RADIUS);
-    body_t *shooting_star = body_init_with_info(
-        shooting_star_list, GB_SHOOTING_STAR_MASS, GB_SHOOTING_STAR_COLOR,
-        space_body_type_init(STAR), free);
+    // Forget the stars that have crossed the arena
+    vector_t keep_min = {.x = ARENA_MIN.x, .y = -INFINITY};
+    vector_t keep_max = {.x = ARENA_MAX.x, .y = INFINITY};
+    particle_field_remove_outside(state->shooting_stars, keep_min, keep_max);
+
     vector_t pos = {.x = 0, .y = rand() % (int)ARENA_MAX.x};
-    vector_t velocity = GB_SHOOTING_STAR_VELCOITY;
-    body_set_velocity(shooting_star, velocity);
-    body_set_centroid(shooting_star, pos);
-    scene_add_body(scene, shooting_star);
+    particle_field_add(state->shooting_stars, pos, GB_SHOOTING_STAR_RADIUS,
+                       GB_SHOOTING_STAR_COLOR);
 }
 
 void game_build_draw_starry_night(scene_t *scene)
@@ -152,44 +185,39 @@ char *endzone_resource_path(game_state_t *state)
     return "game/textures/endzone.png";
 }
 
-char *rocket_resource_path(game_state_t *state)
+void game_build_rocket_animations(game_state_t *state)
 {
-    // If the body does not yet exist or it is not moving, return the idle image.
-    if (!state->rocket || state->thrust_ticks_remaining == 0)
+    state->rocket_idle_animation = animation_init(GB_ROCKET_TICKS_PER_FRAME);
+    animation_add_frame(state->rocket_idle_animation, GB_ROCKET_IDLE_TEXTURE);
+    state->rocket_thrust_animation = animation_init(GB_ROCKET_TICKS_PER_FRAME);
+    size_t frame_count =
+        sizeof(GB_ROCKET_THRUST_TEXTURES) / sizeof(*GB_ROCKET_THRUST_TEXTURES);
+    for (size_t i = 0; i < frame_count; i++)
     {
-        return "game/textures/rocket/rocket_idle.png\0";
+        animation_add_frame(state->rocket_thrust_animation,
+                            GB_ROCKET_THRUST_TEXTURES[i]);
     }
+}
 
-    // Rocket is moving, get animation frame
-    int texture_idx = 1 + (state->ticks % ROCKET_TEXTURE_COUNT);
-
-    switch (texture_idx)
-    {
-    case 1:
-        return "game/textures/rocket/rocket1.png\0";
-        break;
-    case 2:
-        return "game/textures/rocket/rocket2.png\0";
-        break;
-    case 3:
-        return "game/textures/rocket/rocket3.png\0";
-        break;
-    default:
-        return "game/textures/rocket/rocket4.png\0";
-        break;
-    }
+void game_build_update_rocket_animation(game_state_t *state, body_t *rocket)
+{
+    body_set_animation(rocket, state->thrust_ticks_remaining > 0
+                                   ? state->rocket_thrust_animation
+                                   : state->rocket_idle_animation);
 }
 
 body_t *game_build_rocket(scene_t *scene, game_state_t *state, void *type)
 {
-    list_t *rocket_shape = sprite_make_circle(GB_ROCKET_RADIUS);
+    list_t *rocket_shape =
+        sprite_make_circle_points(GB_ROCKET_RADIUS, SPRITE_CIRCLE_PROXY_POINTS);
     body_t *rocket =
         body_init_with_info(rocket_shape, GB_ROCKET_MASS, GB_ROCKET_COLOR,
                             type, free);
+    body_set_circle_lod(rocket, GB_ROCKET_RADIUS);
     body_set_centroid(rocket, GB_ROCKET_INITIAL_POS);
     body_set_movable(rocket, true);
-    body_set_texture_path_func(rocket, (texture_path_func_t)rocket_resource_path,
-                               state, NULL);
+    body_set_render_layer(rocket, GB_ROCKET_LAYER);
+    game_build_update_rocket_animation(state, rocket);
     scene_add_body(scene, rocket);
     body_set_camera_mode(rocket, FOLLOW);
     return rocket;
@@ -202,29 +230,27 @@ void game_build_sky(scene_t *scene)
     body_t *background =
         body_init_with_info(background_list, INFINITY, GB_BACKGROUND_COLOR,
                             space_body_type_init(BACKGROUND_OBJECT), free);
+    body_set_static_background(background, true);
     scene_add_body(scene, background);
 }
 
 void game_build_stars(scene_t *scene)
 {
-
+    particle_field_t *stars = particle_field_init();
+    particle_field_set_camera_mode(stars, SCENE);
+    particle_field_set_render_layer(stars, GB_STAR_LAYER);
     for (double i = ARENA_MIN.y - 5; i < ARENA_MAX.y / GB_FREQUENCY_FOR_STARS; i++)
     {
         for (double j = ARENA_MIN.x - 10; j < ARENA_MAX.x / GB_FREQUENCY_FOR_STARS;
              j++)
         {
-            list_t *star_list = sprite_make_star(
-                GB_STAR_NUM_OF_POINTS, GB_STAR_MIN_LENGTH, GB_STAR_MAX_LENGTH);
-            body_t *star = body_init_with_info(star_list, INFINITY, GB_STAR_COLOR,
-                                               space_body_type_init(STAR), free);
             vector_t pos = {.x = i * GB_DISTANCE_BETWEEN_STARS,
                             .y = j * GB_DISTANCE_BETWEEN_STARS +
                                  ((int)i % 2) * GB_DISTANCE_BETWEEN_STARS / 2.0};
-            body_set_centroid(star, pos);
-            body_set_camera_mode(star, SCENE);
-            scene_add_body(scene, star);
+            particle_field_add(stars, pos, GB_STAR_SIZE, GB_STAR_COLOR);
         }
     }
+    scene_add_particle_field(scene, stars);
 }
 
 double get_rand()
@@ -248,6 +274,9 @@ void game_build_draw_asteroids(game_state_t *state)
 
     // amount on either side of perfect center the asteroid can move
     double render_range = GB_ASTEROID_CONTAINER_LENGTH - 2 * GB_ASTEROID_RADIUS;
+    // Every asteroid shares one shape, so none of them builds its vertices
+    shape_t *shape =
+        shape_intern_circle(GB_ASTEROID_RADIUS, SPRITE_CIRCLE_PROXY_POINTS);
 
     for (int x = 0; x < squares_x; x++)
     {
@@ -262,10 +291,11 @@ void game_build_draw_asteroids(game_state_t *state)
                                      .y =
                                          y_offset + (y * GB_ASTEROID_CONTAINER_LENGTH)};
 
-                game_build_asteroid(state, centroid);
+                game_build_asteroid(state, shape, centroid);
             }
         }
     }
+    shape_release(shape);
 }
 
 void game_build_endzone(game_state_t *state)
@@ -284,6 +314,7 @@ void game_build_endzone(game_state_t *state)
     body_set_movable(endzone, false);
     game_actions_rocket_endzone_collision(state, endzone);
     body_set_camera_mode(endzone, SCENE);
+    body_set_render_layer(endzone, GB_OBSTACLE_LAYER);
     body_set_texture_path_func(endzone, (texture_path_func_t)endzone_resource_path,
                                state, NULL);
     scene_add_body(state->scene, endzone);
@@ -298,6 +329,7 @@ void add_vertical_fence_to_scene(game_state_t *state, list_t *shape, vector_t ce
     body_set_movable(fence, false);
     game_actions_rocket_fence_collision(state, fence);
     body_set_camera_mode(fence, SCENE);
+    body_set_render_layer(fence, GB_OBSTACLE_LAYER);
     body_set_texture_path_func(fence, (texture_path_func_t)vertical_fence_resource_path,
                                state, NULL);
     scene_add_body(state->scene, fence);
@@ -312,6 +344,7 @@ void add_horizontal_fence_to_scene(game_state_t *state, list_t *shape, vector_t
     body_set_movable(fence, false);
     game_actions_rocket_fence_collision(state, fence);
     body_set_camera_mode(fence, SCENE);
+    body_set_render_layer(fence, GB_OBSTACLE_LAYER);
     body_set_texture_path_func(fence, (texture_path_func_t)horizontal_fence_resource_path,
                                state, NULL);
     scene_add_body(state->scene, fence);
@@ -343,9 +376,9 @@ void game_build_fence(game_state_t *state)
     add_vertical_fence_to_scene(state, left_shape, left_centroid);
 }
 
-void game_build_asteroid(game_state_t *state, vector_t centroid)
+void game_build_asteroid(game_state_t *state, shape_t *shape,
+                         vector_t centroid)
 {
-    list_t *circle = sprite_make_circle(GB_ASTEROID_RADIUS);
     bool is_good_asteroid = rand() % 2 == 0;
     char *texture_path = GB_GOOD_ASTEROID_TEXTURE;
     rgb_color_t color;
@@ -361,14 +394,15 @@ void game_build_asteroid(game_state_t *state, vector_t centroid)
         color = GB_GOOD_ASTEROID_COLOR;
         obstacle_type = space_body_type_init(BAD_OBSTACLE);
     }
-    body_t *asteroid =
-        body_init_with_info(circle, GB_ASTEROID_MASS, color, obstacle_type, free);
+    body_t *asteroid = body_init_with_shape(shape, centroid, GB_ASTEROID_MASS,
+                                            color, obstacle_type, free);
     body_set_static_texture_path(asteroid, texture_path);
-    body_set_centroid(asteroid, centroid);
+    body_set_circle_lod(asteroid, GB_ASTEROID_RADIUS);
     body_set_movable(asteroid, false);
     game_actions_rocket_obstacles_collision(state->scene, state->rocket, asteroid,
                                             state);
     body_set_camera_mode(asteroid, SCENE);
+    body_set_render_layer(asteroid, GB_OBSTACLE_LAYER);
     scene_add_body(state->scene, asteroid);
 }
 
@@ -383,6 +417,7 @@ body_t *game_build_score_keeper(scene_t *scene, double width, double height)
     score_centroid.x += width / 2;
     body_set_centroid(score_display, score_centroid);
     body_set_movable(score_display, false);
+    body_set_render_layer(score_display, GB_SCORE_DISPLAY_LAYER);
     scene_add_body(scene, score_display);
     return score_display;
 }
@@ -467,6 +502,7 @@ void game_build_blue_back(game_state_t *state)
     list_t *screen_rect =
         sprite_make_rect(GB_min.x, GB_max.x, GB_min.y, GB_max.y);
     body_t *background = body_init_with_info(screen_rect, 0, GB_BACKGROUND_COLOR, space_body_type_init(HELP_DISPLAY), free);
+    body_set_render_layer(background, GB_HELP_LAYER);
     scene_add_body(state->scene, background);
 }
 
@@ -478,6 +514,7 @@ void game_build_help_screen(game_state_t *state)
     vector_t centroid = {.x = GB_SCREEN_SIZE_X / 2.0, .y = GB_SCREEN_SIZE_Y / 2.0};
     body_set_centroid(help, centroid);
     body_set_movable(help, false);
+    body_set_render_layer(help, GB_HELP_LAYER);
     scene_add_body(state->scene, help);
     state->needs_restart = false;
 }
@@ -487,6 +524,7 @@ void game_build_stationary_rocket(game_state_t *state, vector_t rocket_position)
     body_t *rocket = game_build_rocket(state->scene, state, (enum space_body_type_t *)space_body_type_init(HELP_DISPLAY));
     body_set_centroid(rocket, rocket_position);
     body_set_rotation(rocket, M_PI / 2.0);
+    body_set_render_layer(rocket, GB_STATIONARY_ROCKET_LAYER);
 }
 
 void game_build_stationary_rockets(game_state_t *state)
@@ -506,6 +544,7 @@ void game_build_welcome_background(game_state_t *state)
     vector_t centroid = {.x = GB_SCREEN_SIZE_X / 2.0, .y = GB_SCREEN_SIZE_Y / 2.0};
     body_set_centroid(welcome, centroid);
     body_set_movable(welcome, false);
+    body_set_render_layer(welcome, GB_SCREEN_LAYER);
     scene_add_body(state->scene, welcome);
 }
 
@@ -517,6 +556,7 @@ void game_build_lost_background(game_state_t *state)
     vector_t centroid = {.x = GB_SCREEN_SIZE_X / 2.0, .y = GB_SCREEN_SIZE_Y / 2.0};
     body_set_centroid(lost, centroid);
     body_set_movable(lost, false);
+    body_set_render_layer(lost, GB_SCREEN_LAYER);
     scene_add_body(state->scene, lost);
 }
 
@@ -528,5 +568,6 @@ void game_build_won_background(game_state_t *state)
     vector_t centroid = {.x = GB_SCREEN_SIZE_X / 2.0, .y = GB_SCREEN_SIZE_Y / 2.0};
     body_set_centroid(won, centroid);
     body_set_movable(won, false);
+    body_set_render_layer(won, GB_SCREEN_LAYER);
     scene_add_body(state->scene, won);
 }
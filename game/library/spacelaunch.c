@@ -10,6 +10,7 @@
 #include "collision.h"
 #include "color.h"
 #include "forces.h"
+#include "frame_clock.h"
 #include "game_actions.h"
 #include "game_build.h"
 #include "scene.h"
@@ -52,6 +53,11 @@ const int TEXT_HEIGHT = 30;
 
 const int TIME_LEVEL_SCALE = 10;
 
+const char ASSET_MANIFEST_FILE[] = "game/assets.manifest";
+// Written by `make` from the manifest; the game runs without it, but slower
+const char ASSET_BUNDLE_FILE[] = "game/assets.bundle";
+const double STARTUP_MS_PER_S = 1e3;
+
 void screen_game_render(game_state_t *state)
 {
   if (state->needs_restart)
@@ -67,11 +73,12 @@ void screen_game_render(game_state_t *state)
   if (state->thrust_ticks_remaining > 0)
   {
     state->thrust_ticks_remaining -= 1;
+    game_build_update_rocket_animation(state, state->rocket);
   }
 
   if (state->ticks % SHOOTING_STAR_ADD_INTERVAL == 0)
   {
-    game_build_shooting_star(state->scene);
+    game_build_shooting_star(state);
   }
   game_actions_check_for_game_over(state);
 }
@@ -84,6 +91,7 @@ void screen_game_over_render(game_state_t *state)
     scene_free(state->scene);
     state->scene = scene_init();
     state->rocket = NULL;
+    state->shooting_stars = NULL;
     state->needs_restart = false;
     state->level = 1;
     text_t *score =
@@ -105,6 +113,7 @@ void screen_game_win_render(game_state_t *state)
     state->scene = scene_init();
     game_build_won_background(state);
     state->rocket = NULL;
+    state->shooting_stars = NULL;
     state->needs_restart = false;
     text_t *score =
         text_init("SCORE: ", END_GAME_SCORE_POSITION, END_GAME_SCORE_SIZE,
@@ -127,27 +136,100 @@ void screen_game_win_render(game_state_t *state)
 void game_state_free(game_state_t *state)
 {
   scene_free(state->scene);
+  animation_free(state->rocket_idle_animation);
+  animation_free(state->rocket_thrust_animation);
   free(state->texts);
   free(state);
 }
 
+/**
+ * Reports how long startup took, once every asset has been loaded.
+ * Progress is reported after the frame that uploaded the assets is shown,
+ * so the last report is the time to the first fully loaded frame.
+ *
+ * @param loaded the number of assets loaded so far
+ * @param total the number of assets to load
+ * @param start_time when the game started, from frame_clock_now()
+ */
+void report_loading_progress(size_t loaded, size_t total, double *start_time)
+{
+  if (loaded == total)
+  {
+    printf("Loaded %zu assets; first interactive frame after %.1f ms\n",
+           total, (frame_clock_now() - *start_time) * STARTUP_MS_PER_S);
+  }
+}
+
+/**
+ * Advances the current screen by one tick.
+ * Runs on sdl_run_simulation()'s worker thread, so it must not draw.
+ *
+ * @param state the game state
+ * @return the scene to draw, or NULL if the player quit
+ */
+scene_t *game_step(game_state_t *state)
+{
+  if (state->quit_game)
+  {
+    return NULL;
+  }
+  double dt = time_since_last_tick();
+  if (state->needs_restart)
+  {
+    state->ticks = 0;
+  }
+  switch (state->current_screen)
+  {
+  case SCREEN_START:
+    game_beginning_setup(state);
+    break;
+  case SCREEN_HELP:
+    game_help_setup(state);
+    break;
+  case SCREEN_GAME:
+    screen_game_render(state);
+    // The physics advance in fixed steps; the timer follows the physics
+    state->timer -= scene_tick_fixed(state->scene, dt);
+    break;
+  case SCREEN_GAME_OVER:
+    screen_game_over_render(state);
+    break;
+  case SCREEN_GAME_WIN:
+    screen_game_win_render(state);
+    break;
+
+  default:
+    break;
+  }
+  return state->scene;
+}
+
 int main(int argc, char *argv[])
 {
+  double start_time = frame_clock_now();
+
   // Initialize random number generator
   srand(time(NULL));
 
   // Initialize the game state
   game_state_t *state = malloc(sizeof(game_state_t));
   state->texts = NULL;
+  state->shooting_stars = NULL;
   state->current_screen = SCREEN_START;
   state->needs_restart = true;
   state->thrust_ticks_remaining = 0;
   state->quit_game = false;
   state->texts = malloc(sizeof(game_texts_t));
+  game_build_rocket_animations(state);
 
   // Initialize SDL
   TTF_Init();
   sdl_init(min, max);
+  // Decode the textures and fonts in the background while the welcome
+  // screen is shown
+  sdl_load_assets(ASSET_MANIFEST_FILE, ASSET_BUNDLE_FILE,
+                  (asset_progress_t)report_loading_progress, &start_time);
+  sdl_load_texture_atlas(GB_ATLAS_TEXTURES, GB_ATLAS_TEXTURE_COUNT);
   sdl_event_args(state);
   sdl_on_key((key_handler_t)handle_key_press);
 
@@ -165,45 +247,11 @@ int main(int argc, char *argv[])
   // SDL_QueueAudio(deviceId, *wavBuffer, *wavLength);
   // SDL_PauseAudioDevice(deviceId, 0);
 
-  // Render the correct screen each tick.
-  while (!sdl_is_done())
-  {
-    if (state->quit_game)
-    {
-      break;
-    }
-    double dt = time_since_last_tick();
-    if (state->needs_restart)
-    {
-      state->ticks = 0;
-    }
-    switch (state->current_screen)
-    {
-    case SCREEN_START:
-      game_beginning_setup(state);
-      break;
-    case SCREEN_HELP:
-      game_help_setup(state);
-      break;
-    case SCREEN_GAME:
-      screen_game_render(state);
-      state->timer -= dt;
-      scene_tick(state->scene, dt);
-      break;
-    case SCREEN_GAME_OVER:
-      screen_game_over_render(state);
-      break;
-    case SCREEN_GAME_WIN:
-      screen_game_win_render(state);
-      break;
-
-    default:
-      break;
-    }
-    sdl_render_scene(state->scene);
-  }
-  TTF_Quit();
+  // Step the game on a worker thread while the last step is drawn
+  sdl_run_simulation((simulation_step_t)game_step, state);
   game_state_free(state);
+  sdl_quit();
+  TTF_Quit();
 
   // SDL_CloseAudioDevice(deviceId);
   // SDL_FreeWAV(*wavBuffer);
@@ -0,0 +1,161 @@
+#ifndef __AABB_TREE_H__
+#define __AABB_TREE_H__
+
+#include "broadphase.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A dynamic bounding volume tree: a balanced binary tree of boxes, where
+ * each inner box contains its two children, and the leaves are the boxes
+ * of the objects put in the tree. Finding the objects near a box or along
+ * a ray only visits the branches whose boxes it touches.
+ *
+ * Each object is stored with a fat box: its box grown by the tree's margin.
+ * Moving an object only changes the tree once it leaves its fat box, so
+ * objects that move a little each tick rarely cost anything. New leaves go
+ * wherever grows the boxes' perimeters the least (the surface area
+ * heuristic), and the tree is rebalanced with rotations as it changes.
+ */
+typedef struct aabb_tree aabb_tree_t;
+
+/**
+ * Returned instead of a proxy where there is none.
+ */
+extern const size_t AABB_TREE_NULL;
+
+/**
+ * Called for each object whose fat box overlaps the box of a query.
+ *
+ * @param aux the auxiliary value passed to aabb_tree_query()
+ * @param proxy the object's proxy
+ * @param data the object's data, as passed to aabb_tree_insert()
+ * @return true to keep searching, or false to stop the query
+ */
+typedef bool (*aabb_tree_query_func_t)(void *aux, size_t proxy, void *data);
+
+/**
+ * Called for each object whose fat box a ray reaches before the closest
+ * hit found so far, to test the ray against the object itself.
+ *
+ * @param aux the auxiliary value passed to aabb_tree_raycast()
+ * @param proxy the object's proxy
+ * @param data the object's data, as passed to aabb_tree_insert()
+ * @return the distance along the ray where it hits the object,
+ *   or a negative number if it misses
+ */
+typedef double (*aabb_tree_ray_func_t)(void *aux, size_t proxy, void *data);
+
+/**
+ * Allocates an empty tree.
+ *
+ * @param margin how far each fat box reaches past its object's box
+ * @return a pointer to the newly allocated tree
+ */
+aabb_tree_t *aabb_tree_init(double margin);
+
+/**
+ * Releases a tree. The objects' data is not freed.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ */
+void aabb_tree_free(aabb_tree_t *tree);
+
+/**
+ * Puts an object in a tree.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @param box the object's box
+ * @param data a value to pass back with the object in queries
+ * @return the object's proxy, which stays the same until it is removed
+ */
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t box, void *data);
+
+/**
+ * Takes an object out of a tree.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @param proxy a proxy returned from aabb_tree_insert()
+ */
+void aabb_tree_remove(aabb_tree_t *tree, size_t proxy);
+
+/**
+ * Updates the box of an object that moved.
+ * The tree only changes if the box left the object's fat box.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @param proxy a proxy returned from aabb_tree_insert()
+ * @param box the object's new box
+ * @return whether the object was moved in the tree
+ */
+bool aabb_tree_move(aabb_tree_t *tree, size_t proxy, aabb_t box);
+
+/**
+ * Gets the fat box of an object.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @param proxy a proxy returned from aabb_tree_insert()
+ * @return a box containing the object's box as last inserted or moved
+ */
+aabb_t aabb_tree_get_fat_box(aabb_tree_t *tree, size_t proxy);
+
+/**
+ * Gets the data of an object.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @param proxy a proxy returned from aabb_tree_insert()
+ * @return the data passed to aabb_tree_insert()
+ */
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t proxy);
+
+/**
+ * Gets the number of objects in a tree.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @return how many objects were inserted and not removed
+ */
+size_t aabb_tree_size(aabb_tree_t *tree);
+
+/**
+ * Gets the height of a tree, which stays about log2 of its size.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @return the number of edges from the root to the deepest leaf,
+ *   or 0 for an empty tree
+ */
+size_t aabb_tree_height(aabb_tree_t *tree);
+
+/**
+ * Finds the objects whose fat boxes overlap a box.
+ * func may search the tree again, but must not change it.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @param box the box to search
+ * @param func called for each object found
+ * @param aux an auxiliary value to pass to func
+ */
+void aabb_tree_query(aabb_tree_t *tree, aabb_t box,
+                     aabb_tree_query_func_t func, void *aux);
+
+/**
+ * Finds the closest object a ray hits.
+ * Objects are tested with func, in no particular order, and only if the
+ * ray reaches their fat boxes before the closest hit found so far.
+ * func may search the tree again, but must not change it.
+ *
+ * @param tree a pointer returned from aabb_tree_init()
+ * @param origin where the ray starts
+ * @param direction a unit vector along the ray
+ * @param max_distance how far the ray reaches
+ * @param func tests the ray against an object
+ * @param aux an auxiliary value to pass to func
+ * @param distance if not NULL, set to the distance to the closest hit
+ * @return the proxy of the closest object hit, or AABB_TREE_NULL
+ */
+size_t aabb_tree_raycast(aabb_tree_t *tree, vector_t origin,
+                         vector_t direction, double max_distance,
+                         aabb_tree_ray_func_t func, void *aux,
+                         double *distance);
+
+#endif // #ifndef __AABB_TREE_H__
@@ -0,0 +1,94 @@
+#ifndef __ANIMATION_H__
+#define __ANIMATION_H__
+
+#include <stddef.h>
+
+/**
+ * A sequence of images that a body cycles through, showing each one for a
+ * fixed number of ticks. An animation can be shared by many bodies.
+ *
+ * Each frame also stores a handle, which whoever owns the animation can use
+ * to remember where it found the frame's image. The renderer never reads
+ * or writes handles: it draws from snapshots that only hold the path of the
+ * frame each body shows (see render_snapshot.h), since the simulation may
+ * change or free the animation while a snapshot is drawn.
+ */
+typedef struct animation animation_t;
+
+/**
+ * The handle of a frame that the renderer has not looked up yet.
+ */
+extern const size_t ANIMATION_NO_HANDLE;
+
+/**
+ * Allocates an animation with no frames.
+ * Asserts that ticks_per_frame is positive.
+ *
+ * @param ticks_per_frame the number of ticks each frame is shown for
+ * @return a pointer to the newly allocated animation
+ */
+animation_t *animation_init(size_t ticks_per_frame);
+
+/**
+ * Releases an animation. The frame paths are not freed.
+ *
+ * @param animation a pointer to an animation returned from animation_init()
+ */
+void animation_free(animation_t *animation);
+
+/**
+ * Appends a frame to an animation.
+ *
+ * @param animation a pointer to an animation returned from animation_init()
+ * @param texture_path the path to the frame's image, which must outlive
+ *   the animation
+ */
+void animation_add_frame(animation_t *animation, char *texture_path);
+
+/**
+ * Gets the number of frames in an animation.
+ *
+ * @param animation a pointer to an animation returned from animation_init()
+ * @return the number of frames added with animation_add_frame()
+ */
+size_t animation_frame_count(animation_t *animation);
+
+/**
+ * Gets the index of the frame shown at a tick.
+ * Asserts that the animation has at least one frame.
+ *
+ * @param animation a pointer to an animation returned from animation_init()
+ * @param tick the number of ticks since the animation started
+ * @return the index of the frame to show
+ */
+size_t animation_frame_at(animation_t *animation, size_t tick);
+
+/**
+ * Gets the path to a frame's image.
+ *
+ * @param animation a pointer to an animation returned from animation_init()
+ * @param index the index of the frame
+ * @return the path passed to animation_add_frame()
+ */
+char *animation_get_frame(animation_t *animation, size_t index);
+
+/**
+ * Gets the renderer's handle for a frame.
+ *
+ * @param animation a pointer to an animation returned from animation_init()
+ * @param index the index of the frame
+ * @return the handle, or ANIMATION_NO_HANDLE if none has been set
+ */
+size_t animation_get_frame_handle(animation_t *animation, size_t index);
+
+/**
+ * Sets the renderer's handle for a frame.
+ *
+ * @param animation a pointer to an animation returned from animation_init()
+ * @param index the index of the frame
+ * @param handle the value animation_get_frame_handle() will return
+ */
+void animation_set_frame_handle(animation_t *animation, size_t index,
+                                size_t handle);
+
+#endif // #ifndef __ANIMATION_H__
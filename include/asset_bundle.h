@@ -0,0 +1,106 @@
+#ifndef __ASSET_BUNDLE_H__
+#define __ASSET_BUNDLE_H__
+
+#include "asset_manifest.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A single file holding assets that are ready to use: images as decoded
+ * RGBA pixels and fonts as the contents of their files. Bundles are written
+ * at build time by the pack_assets tool and mapped into memory when opened,
+ * so loading an asset from one needs no decoding and no file operations.
+ *
+ * A bundle is an index (a header, then one fixed-size entry per asset)
+ * followed by the assets' data. Values are stored in the byte order of the
+ * machine that packed the bundle; bundles from other machines are rejected.
+ */
+typedef struct asset_bundle asset_bundle_t;
+
+/**
+ * One asset in a bundle.
+ */
+typedef struct bundle_asset
+{
+  asset_type_t type;
+  const char *path;
+  // The size of an image in pixels; 0 for fonts
+  int width, height;
+  // An image's pixels in SDL_PIXELFORMAT_RGBA32 order, row by row with no
+  // padding, or the contents of a font file
+  const void *data;
+  size_t size;
+} bundle_asset_t;
+
+/**
+ * The longest path that can be stored in a bundle.
+ */
+extern const size_t ASSET_BUNDLE_MAX_PATH;
+
+/**
+ * Reads a whole file into memory, e.g. a font to be bundled or loaded.
+ *
+ * @param path the path of the file
+ * @param size set to the number of bytes read, or 0 if nothing was read
+ * @return the file's contents, to be freed with free(), or NULL if the file
+ *   does not exist, cannot be read, or is empty
+ */
+void *asset_read_file(const char *path, size_t *size);
+
+/**
+ * Writes assets into a bundle file, replacing it if it exists.
+ *
+ * @param path the path of the bundle file
+ * @param assets the assets to write
+ * @param count the number of assets
+ * @return whether the bundle was written; if not, the reason is reported
+ *   to stderr
+ */
+bool asset_bundle_write(const char *path, bundle_asset_t *assets,
+                        size_t count);
+
+/**
+ * Maps a bundle file into memory and checks its index.
+ *
+ * @param path the path of the bundle file
+ * @return a pointer to the opened bundle, or NULL if there is no file there
+ *   or it is not a valid bundle (which is reported to stderr)
+ */
+asset_bundle_t *asset_bundle_open(const char *path);
+
+/**
+ * Unmaps a bundle. Every pointer into it becomes invalid.
+ *
+ * @param bundle a pointer to a bundle returned from asset_bundle_open()
+ */
+void asset_bundle_close(asset_bundle_t *bundle);
+
+/**
+ * Gets the number of assets in a bundle.
+ *
+ * @param bundle a pointer to a bundle returned from asset_bundle_open()
+ * @return the number of assets
+ */
+size_t asset_bundle_size(asset_bundle_t *bundle);
+
+/**
+ * Gets an asset in a bundle. Its path and data point into the bundle.
+ *
+ * @param bundle a pointer to a bundle returned from asset_bundle_open()
+ * @param index the index of the asset
+ * @return the asset
+ */
+bundle_asset_t asset_bundle_get(asset_bundle_t *bundle, size_t index);
+
+/**
+ * Finds an asset in a bundle by its path.
+ *
+ * @param bundle a pointer to a bundle returned from asset_bundle_open()
+ * @param path the path the asset was packed from
+ * @param asset where to store the asset, if it is found
+ * @return whether the bundle has an asset with the path
+ */
+bool asset_bundle_find(asset_bundle_t *bundle, const char *path,
+                       bundle_asset_t *asset);
+
+#endif // #ifndef __ASSET_BUNDLE_H__
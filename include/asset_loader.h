@@ -0,0 +1,100 @@
+#ifndef __ASSET_LOADER_H__
+#define __ASSET_LOADER_H__
+
+#include "asset_bundle.h"
+#include "asset_manifest.h"
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Decodes the assets in a manifest on background threads.
+ * Images are decoded into RGBA surfaces and fonts are read into memory,
+ * so the thread that owns the renderer only has to upload them.
+ * Assets found in a bundle are used straight from it, without decoding.
+ */
+typedef struct asset_loader asset_loader_t;
+
+/**
+ * An asset that has been decoded, handed to the caller by
+ * asset_loader_poll(). The caller owns its surface or data.
+ */
+typedef struct loaded_asset
+{
+  asset_type_t type;
+  // Owned by the loader's manifest
+  const char *path;
+  // The point size of a font, from the manifest
+  int point_size;
+  // An image's pixels, or NULL if it could not be loaded.
+  // Free with SDL_FreeSurface().
+  SDL_Surface *surface;
+  // The contents of a font file, or NULL if it could not be read.
+  // Free with free(), unless it is borrowed.
+  void *data;
+  size_t size;
+  // Whether data points into the loader's bundle, which must then outlive
+  // every use of it
+  bool borrowed;
+} loaded_asset_t;
+
+/**
+ * Starts decoding every asset in a manifest, in manifest order,
+ * on as many threads as there are CPUs (up to a small limit).
+ * Assets that are in the bundle are taken from it; the rest are loaded from
+ * their files. IMG_Init() must have been called for the image formats of
+ * the files that are loaded.
+ *
+ * @param manifest the assets to load, which must outlive the loader
+ * @param bundle a bundle of packed assets, or NULL to load every asset from
+ *   its file. Surfaces and fonts taken from the bundle point into it.
+ * @return a pointer to the newly allocated loader
+ */
+asset_loader_t *asset_loader_start(asset_manifest_t *manifest,
+                                   asset_bundle_t *bundle);
+
+/**
+ * Stops the loader's threads, once they finish the assets they are
+ * decoding, and releases every asset that was not taken.
+ *
+ * @param loader a pointer to a loader returned from asset_loader_start()
+ */
+void asset_loader_free(asset_loader_t *loader);
+
+/**
+ * Takes the next asset that has finished decoding, without waiting.
+ * Each asset is taken once; assets that fail to load are taken too,
+ * with no surface or data.
+ *
+ * @param loader a pointer to a loader returned from asset_loader_start()
+ * @param asset where to store the asset
+ * @return whether an asset was taken
+ */
+bool asset_loader_poll(asset_loader_t *loader, loaded_asset_t *asset);
+
+/**
+ * Checks whether an asset in the manifest has not been taken yet.
+ *
+ * @param loader a pointer to a loader returned from asset_loader_start()
+ * @param path the path of the asset
+ * @return whether the path is in the manifest and has not been taken
+ */
+bool asset_loader_pending(asset_loader_t *loader, const char *path);
+
+/**
+ * Gets the number of assets that have been taken.
+ *
+ * @param loader a pointer to a loader returned from asset_loader_start()
+ * @return the number of assets returned by asset_loader_poll()
+ */
+size_t asset_loader_taken(asset_loader_t *loader);
+
+/**
+ * Gets the number of assets the loader loads.
+ *
+ * @param loader a pointer to a loader returned from asset_loader_start()
+ * @return the number of assets in the manifest
+ */
+size_t asset_loader_total(asset_loader_t *loader);
+
+#endif // #ifndef __ASSET_LOADER_H__
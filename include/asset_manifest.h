@@ -0,0 +1,108 @@
+#ifndef __ASSET_MANIFEST_H__
+#define __ASSET_MANIFEST_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * The kinds of files an asset manifest can list.
+ */
+typedef enum
+{
+  // An image, decoded into a texture
+  ASSET_IMAGE,
+  // A TrueType font, rasterized at one point size
+  ASSET_FONT,
+} asset_type_t;
+
+/**
+ * A list of the assets a program loads at startup.
+ *
+ * Manifests are text files with one asset per line, in the order the
+ * assets should be loaded:
+ *
+ *   # Comments and blank lines are ignored
+ *   image game/textures/welcome.png
+ *   font CourierPrime-Regular.ttf 100
+ *
+ * Paths cannot contain whitespace. Fonts are followed by the point size
+ * they are drawn at.
+ */
+typedef struct asset_manifest asset_manifest_t;
+
+/**
+ * The index asset_manifest_find() returns for paths not in the manifest.
+ */
+extern const size_t ASSET_MANIFEST_NOT_FOUND;
+
+/**
+ * Parses a manifest from a string.
+ * Lines that cannot be parsed are reported to stderr and skipped.
+ *
+ * @param text the contents of a manifest file
+ * @return a pointer to the newly allocated manifest
+ */
+asset_manifest_t *asset_manifest_parse(const char *text);
+
+/**
+ * Reads and parses a manifest file.
+ *
+ * @param path the path to the manifest file
+ * @return a pointer to the newly allocated manifest,
+ *   or NULL if the file could not be read
+ */
+asset_manifest_t *asset_manifest_load(const char *path);
+
+/**
+ * Releases a manifest and its paths.
+ *
+ * @param manifest a pointer to a manifest returned from asset_manifest_parse()
+ */
+void asset_manifest_free(asset_manifest_t *manifest);
+
+/**
+ * Gets the number of assets in a manifest.
+ *
+ * @param manifest a pointer to a manifest returned from asset_manifest_parse()
+ * @return the number of assets
+ */
+size_t asset_manifest_size(asset_manifest_t *manifest);
+
+/**
+ * Gets the kind of an asset.
+ *
+ * @param manifest a pointer to a manifest returned from asset_manifest_parse()
+ * @param index the index of the asset
+ * @return the asset's type
+ */
+asset_type_t asset_manifest_get_type(asset_manifest_t *manifest, size_t index);
+
+/**
+ * Gets the path of an asset. The path is owned by the manifest.
+ *
+ * @param manifest a pointer to a manifest returned from asset_manifest_parse()
+ * @param index the index of the asset
+ * @return the asset's path
+ */
+const char *asset_manifest_get_path(asset_manifest_t *manifest, size_t index);
+
+/**
+ * Gets the point size a font asset is drawn at.
+ *
+ * @param manifest a pointer to a manifest returned from asset_manifest_parse()
+ * @param index the index of the asset
+ * @return the font's point size, or 0 if the asset is not a font
+ */
+int asset_manifest_get_point_size(asset_manifest_t *manifest, size_t index);
+
+/**
+ * Finds an asset by its path.
+ *
+ * @param manifest a pointer to a manifest returned from asset_manifest_parse()
+ * @param path the path to look for
+ * @return the index of the first asset with the path,
+ *   or ASSET_MANIFEST_NOT_FOUND
+ */
+size_t asset_manifest_find(asset_manifest_t *manifest, const char *path);
+
+#endif // #ifndef __ASSET_MANIFEST_H__
@@ -1,10 +1,13 @@
 #ifndef __BODY_H__
 #define __BODY_H__
 
+#include "animation.h"
+#include "broadphase.h"
 #include "color.h"
 #include "list.h"
 #include "vector.h"
 #include "polygon.h"
+#include "shape.h"
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -21,7 +24,7 @@ extern const bool BODY_IS_MOVABLE;
 
 /**
  * Visual properties of a body
- *  shape -- the polygon representing the body's verticies
+ *  shape -- the interned polygon of the body's vertices, in local space
  *  color -- the rgb color of the body
 */
 typedef struct body_appearance body_appearance_t;
@@ -78,13 +81,35 @@ typedef enum
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
  *
- * @param shape a list of vectors describing the initial shape of the body
+ * The shape is interned (see shape.h), so bodies made with identical
+ * shapes share one copy of their vertices.
+ *
+ * @param shape a list of vectors describing the initial shape of the body,
+ *   which is freed
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
  * @param color the color of the body, used to draw it on the screen
  * @return a pointer to the newly allocated body
  */
 body_t *body_init(list_t *shape, double mass, rgb_color_t color);
 
+/**
+ * Allocates memory for a body with a shape that is already interned,
+ * so many identical bodies can be made without building their vertices.
+ * The body is initially at rest and not rotated.
+ *
+ * @param shape the body's shape in local space; the body takes its own
+ *   reference, so the caller still owns theirs
+ * @param centroid where the shape's origin is placed in the scene
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body, or NULL
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_shape(shape_t *shape, vector_t centroid, double mass,
+                             rgb_color_t color, void *info,
+                             free_func_t info_freer);
+
 /**
  * Allocates memory for a body with the given parameters.
  * The body is initially at rest.
@@ -142,12 +167,50 @@ void body_free(body_t *body);
 /**
  * Gets the current shape of a body.
  * Returns a newly allocated vector list, which must be list_free()d.
+ * Callers that only read the vertices should use body_get_shape_view().
  *
  * @param body a pointer to a body returned from body_init()
  * @return the polygon describing the body's current position
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets a body's shape at its current position without copying it.
+ * Unlike body_get_shape(), the vertices belong to the body and must not be
+ * modified. The body places them in the scene the first time they are
+ * asked for after it moves, so every later view until then is free.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the vertices of the body's shape, valid until the body next
+ *   moves, turns, changes shape or is freed
+ */
+polygon_view_t body_get_shape_view(body_t *body);
+
+/**
+ * Gets the number of vertices in a body's shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of vertices
+ */
+size_t body_vertex_count(body_t *body);
+
+/**
+ * Gets one vertex of a body's shape without copying the whole shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param index the index of the vertex, less than body_vertex_count()
+ * @return the vertex at its current position
+ */
+vector_t body_get_vertex(body_t *body, size_t index);
+
+/**
+ * Gets the shape a body places in the scene with its centroid and rotation.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's shape in local space, owned by the body
+ */
+shape_t *body_get_local_shape(body_t *body);
+
 /**
  * Get the path to the image displayed as the body.
  * 
@@ -175,15 +238,44 @@ void body_set_static_texture_path(body_t *body, char *path);
  */
 void body_set_texture_path_func(body_t *body, texture_path_func_t path_func, void *aux, free_func_t freer);
 
+/**
+ * Set the animation displayed as the body.
+ * The renderer picks the frame from its own frame count, so animated bodies
+ * need no texture path function. An animation takes priority over a
+ * texture path. The animation is not freed with the body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param animation the animation to display, or NULL for none
+ */
+void body_set_animation(body_t *body, animation_t *animation);
+
+/**
+ * Get the animation displayed as the body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the animation passed to body_set_animation(), or NULL
+ */
+animation_t *body_get_animation(body_t *body);
+
+/**
+ * Gets the smallest axis-aligned box containing the body's shape.
+ * The body keeps the box up to date: moving the body moves the box, and only
+ * rotating or reshaping it looks at the vertices again, so this is cheap
+ * enough to check before any test that looks at the vertices.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the bounds of the shape at its current position
+ */
+aabb_t body_get_aabb(body_t *body);
+
 /**
  * Gets the rectangle which the body's shape is bounded by.
- * The bounds are determined by the minimum and maximum x and
- * y positions of the shape's verticies. 
+ * The bounds are body_get_aabb(), truncated to whole pixels.
  * 
  * @param body the body to extract the shape from 
- * @return pointer to an allocated SDL_Rect representing the bounds
+ * @return an SDL_Rect representing the bounds
  */
-SDL_Rect *body_get_bounding_rect(body_t *body);
+SDL_Rect body_get_bounding_rect(body_t *body);
 
 /**
  * Gets the current center of mass of a body.
@@ -302,6 +394,79 @@ void body_set_camera_mode(body_t *body, camera_mode_t camera_mode);
  */
 camera_mode_t body_get_camera_mode(body_t *body);
 
+/**
+ * Gets a number that identifies the body.
+ * No two bodies created by the program ever share an id.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's id
+ */
+size_t body_get_id(body_t *body);
+
+/**
+ * Marks a body as part of the static background.
+ * The renderer draws static background bodies once into a layer texture
+ * shared by all such bodies with the same camera mode, and redraws the
+ * layer only when bodies join or leave it. A static background body must
+ * not change its shape, color, or texture, and must only move along with
+ * the other bodies of its camera mode. Static layers are drawn behind
+ * all other bodies.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param static_background whether the body is part of the static background
+ */
+void body_set_static_background(body_t *body, bool static_background);
+
+/**
+ * Checks whether a body is part of the static background.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return true if body_set_static_background() marked the body as static
+ */
+bool body_is_static_background(body_t *body);
+
+/**
+ * Sets the layer a body is drawn in.
+ * Bodies are drawn in increasing order of layer, whatever order they were
+ * added to the scene in; bodies start in layer 0. Within a layer the
+ * renderer groups bodies by texture, keeping scene order within each
+ * group, so bodies that must overlap in a fixed order need different
+ * layers. Static background layers are drawn before every layer.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param layer the body's layer, between INT16_MIN and INT16_MAX
+ */
+void body_set_render_layer(body_t *body, int layer);
+
+/**
+ * Gets the layer a body is drawn in.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the layer passed to body_set_render_layer(), or 0
+ */
+int body_get_render_layer(body_t *body);
+
+/**
+ * Marks a body as a circle centered on its centroid, so the renderer draws
+ * it with only as many vertices as its size on screen needs.
+ * The body's shape is replaced by a coarse polygon of
+ * SPRITE_CIRCLE_PROXY_POINTS vertices inscribed in the circle, which is
+ * what the body collides as and what moves with it each tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param radius the radius of the circle, which must be positive
+ */
+void body_set_circle_lod(body_t *body, double radius);
+
+/**
+ * Gets the radius of a body marked as a circle.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the radius passed to body_set_circle_lod(), or 0 if the body
+ *   is not a circle
+ */
+double body_get_circle_radius(body_t *body);
+
 /**
  * Changes a body's orientation in the plane.
  * The body is rotated about its center of mass.
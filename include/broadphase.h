@@ -0,0 +1,195 @@
+#ifndef __BROADPHASE_H__
+#define __BROADPHASE_H__
+
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * An axis-aligned bounding box, from its smallest to its largest corner.
+ */
+typedef struct aabb
+{
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * Checks whether two boxes overlap. Boxes that only touch overlap.
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return whether the boxes share at least one point
+ */
+bool aabb_overlaps(aabb_t a, aabb_t b);
+
+/**
+ * Checks whether one box lies entirely inside another.
+ *
+ * @param outer the containing box
+ * @param inner the contained box
+ * @return whether every point of inner is in outer
+ */
+bool aabb_contains(aabb_t outer, aabb_t inner);
+
+/**
+ * Gets the smallest box containing two boxes.
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return the union of the boxes
+ */
+aabb_t aabb_union(aabb_t a, aabb_t b);
+
+/**
+ * Gets the perimeter of a box, which grows with the chance that a box
+ * overlaps others scattered around it.
+ *
+ * @param box the box
+ * @return twice the sum of the width and height
+ */
+double aabb_perimeter(aabb_t box);
+
+/**
+ * Two boxes in a broadphase that might overlap, by index.
+ * first is always less than second.
+ */
+typedef struct broadphase_pair
+{
+  size_t first;
+  size_t second;
+} broadphase_pair_t;
+
+/**
+ * Finds which of many boxes overlap without testing every pair of them.
+ * Boxes are added again each tick, and broadphase_find_pairs() finds the
+ * pairs with the broadphase's current mode.
+ */
+typedef struct broadphase broadphase_t;
+
+/**
+ * How a broadphase finds overlapping boxes.
+ */
+typedef enum broadphase_mode
+{
+  /**
+   * Boxes are hashed into the cells of a uniform grid they cover, and only
+   * boxes sharing a cell are tested against each other. The grid is rebuilt
+   * from scratch each time, which suits boxes that all move every tick.
+   */
+  BROADPHASE_GRID,
+  /**
+   * Boxes are kept sorted by their smallest x, and each box is only tested
+   * against the boxes that start before it ends. The order is kept between
+   * searches and repaired with an insertion sort, which is nearly free while
+   * the same boxes move a little each tick. Suits boxes laid out in rows,
+   * which a grid fills unevenly.
+   */
+  BROADPHASE_SWEEP_AND_PRUNE,
+  /**
+   * Bodies are kept in dynamic AABB trees (see aabb_tree.h) between ticks,
+   * one for bodies that cannot move and one for those that can, and only
+   * the moving bodies are looked up, so a few fast bodies in a large arena
+   * of still ones cost little. Only scenes can use this mode, since the
+   * trees need to know which box belongs to which body from one tick to the
+   * next; a broadphase_t set to it finds pairs like BROADPHASE_GRID.
+   */
+  BROADPHASE_AABB_TREE,
+} broadphase_mode_t;
+
+/**
+ * The grid cell size that broadphase_init() picks when given 0.
+ */
+extern const double BROADPHASE_DEFAULT_CELL_SIZE;
+
+/**
+ * Allocates an empty broadphase, in BROADPHASE_GRID mode.
+ * The cell size should be about the size of the boxes that move the most:
+ * much smaller and large boxes cover many cells, much larger and many far
+ * apart boxes share a cell.
+ *
+ * @param cell_size the width and height of each grid cell,
+ *   or 0 for BROADPHASE_DEFAULT_CELL_SIZE
+ * @return a pointer to the newly allocated broadphase
+ */
+broadphase_t *broadphase_init(double cell_size);
+
+/**
+ * Releases a broadphase and its boxes and pairs.
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ */
+void broadphase_free(broadphase_t *broadphase);
+
+/**
+ * Sets how a broadphase finds overlapping boxes from now on.
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ * @param mode the way to find pairs
+ */
+void broadphase_set_mode(broadphase_t *broadphase, broadphase_mode_t mode);
+
+/**
+ * Gets how a broadphase finds overlapping boxes.
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ * @return the mode passed to broadphase_set_mode(), or BROADPHASE_GRID
+ */
+broadphase_mode_t broadphase_get_mode(broadphase_t *broadphase);
+
+/**
+ * Removes every box and pair, keeping the memory for the next tick's boxes.
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ */
+void broadphase_clear(broadphase_t *broadphase);
+
+/**
+ * Adds a box. Boxes are numbered from 0 in the order they are added.
+ * In BROADPHASE_SWEEP_AND_PRUNE mode, boxes should be added in the same
+ * order each tick, so box i is about where box i was last time.
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ * @param box the box to add
+ * @return the index of the box
+ */
+size_t broadphase_add(broadphase_t *broadphase, aabb_t box);
+
+/**
+ * Gets the number of boxes added since the last broadphase_clear().
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ * @return the number of boxes
+ */
+size_t broadphase_size(broadphase_t *broadphase);
+
+/**
+ * Finds every pair of boxes that overlap, replacing the last pairs found.
+ * Each pair is found once, however many cells its boxes share.
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ * @return the number of pairs found
+ */
+size_t broadphase_find_pairs(broadphase_t *broadphase);
+
+/**
+ * Gets the pairs found by the last broadphase_find_pairs().
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ * @return the pairs, sorted by first and then second index,
+ *   valid until the broadphase is next changed
+ */
+broadphase_pair_t *broadphase_get_pairs(broadphase_t *broadphase);
+
+/**
+ * Checks whether the last broadphase_find_pairs() found a pair of boxes.
+ *
+ * @param broadphase a pointer returned from broadphase_init()
+ * @param first the index of one box
+ * @param second the index of the other box, in either order
+ * @return whether the boxes overlap
+ */
+bool broadphase_has_pair(broadphase_t *broadphase, size_t first,
+                         size_t second);
+
+#endif // #ifndef __BROADPHASE_H__
@@ -37,4 +37,16 @@ typedef struct {
  */
 collision_info_t find_collision(list_t *shape1, list_t *shape2);
 
+/**
+ * Computes the status of the collision between two convex polygons,
+ * like find_collision(), without copying their vertices.
+ *
+ * @param shape1 a view of the first shape, e.g. from body_get_shape_view()
+ * @param shape2 a view of the second shape
+ * @return whether the shapes are colliding, and if so, the collision axis,
+ *   pointing from shape1 towards shape2
+ */
+collision_info_t find_collision_views(polygon_view_t shape1,
+                                      polygon_view_t shape2);
+
 #endif // #ifndef __COLLISION_H__
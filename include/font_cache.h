@@ -0,0 +1,98 @@
+#ifndef __FONT_CACHE_H__
+#define __FONT_CACHE_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/**
+ * The printable ASCII glyphs of one font at one point size,
+ * rasterized once into a single texture.
+ * Strings are drawn by copying glyph rectangles out of that texture,
+ * so drawing text needs no rasterization or texture uploads.
+ */
+typedef struct glyph_atlas glyph_atlas_t;
+
+/**
+ * Fonts opened once per (file, point size), each with its glyph atlas.
+ */
+typedef struct font_cache font_cache_t;
+
+/**
+ * Allocates an empty font cache whose atlases are uploaded to a renderer.
+ * TTF_Init() must have been called, and the renderer must outlive the cache.
+ *
+ * @param renderer the renderer that atlas textures are created for
+ * @return a pointer to the newly allocated cache
+ */
+font_cache_t *font_cache_init(SDL_Renderer *renderer);
+
+/**
+ * Closes every cached font, destroys every atlas, and releases the cache.
+ * Must be called before TTF_Quit().
+ *
+ * @param cache a pointer to a cache returned from font_cache_init()
+ */
+void font_cache_free(font_cache_t *cache);
+
+/**
+ * Gets the glyph atlas for a font file at a point size,
+ * opening the font and building the atlas on first use.
+ * Fonts that fail to open are remembered and reported only once.
+ *
+ * @param cache a pointer to a cache returned from font_cache_init()
+ * @param file the path to the .ttf file
+ * @param point_size the point size to rasterize the glyphs at
+ * @return the atlas, or NULL if the font could not be loaded
+ */
+glyph_atlas_t *font_cache_get(font_cache_t *cache, const char *file,
+                              int point_size);
+
+/**
+ * Opens a font from a file's contents, which were read earlier (e.g. on
+ * another thread), and builds its glyph atlas, so that font_cache_get()
+ * for the same file and point size will not touch the disk.
+ * If the font is already cached, it is kept and the data is released.
+ *
+ * @param cache a pointer to a cache returned from font_cache_init()
+ * @param file the path the font was read from
+ * @param point_size the point size to rasterize the glyphs at
+ * @param data the contents of the .ttf file, or NULL if it could not be read
+ * @param size the number of bytes of data
+ * @param owned whether the cache takes ownership of data, which must then
+ *   have been allocated with malloc(). Otherwise, data must outlive the cache.
+ * @return the atlas, or NULL if the font could not be loaded
+ */
+glyph_atlas_t *font_cache_add(font_cache_t *cache, const char *file,
+                              int point_size, void *data, size_t size,
+                              bool owned);
+
+/**
+ * Gets the number of glyph atlases the cache has uploaded into textures.
+ *
+ * @param cache a pointer to a cache returned from font_cache_init()
+ * @return the number of atlases built since the cache was created
+ */
+size_t font_cache_uploads(font_cache_t *cache);
+
+/**
+ * Measures a string as it would be drawn at the atlas's native size.
+ *
+ * @param atlas an atlas returned from font_cache_get()
+ * @param string the text to measure
+ * @return the width and height of the string in pixels
+ */
+SDL_Point glyph_atlas_measure(glyph_atlas_t *atlas, const char *string);
+
+/**
+ * Draws a string stretched to fill a rectangle on the current render target.
+ * Characters without a glyph in the atlas are drawn as '?'.
+ *
+ * @param atlas an atlas returned from font_cache_get()
+ * @param renderer the renderer to draw with
+ * @param string the text to draw
+ * @param bounds the screen rectangle the whole string is scaled to fit
+ */
+void glyph_atlas_draw(glyph_atlas_t *atlas, SDL_Renderer *renderer,
+                      const char *string, SDL_Rect bounds);
+
+#endif // #ifndef __FONT_CACHE_H__
@@ -68,6 +68,8 @@ void create_drag(scene_t *scene, double gamma, body_t *body);
  * allowing different things to happen on a collision.
  * The handler is passed the bodies, the collision axis, and an auxiliary value.
  * It should only be called once while the bodies are still colliding.
+ * The shapes are only compared on ticks when the scene's broadphase finds
+ * the bodies' bounding boxes overlapping (see scene_add_collision_creator()).
  *
  * @param scene the scene containing the bodies
  * @param body1 the first body
@@ -0,0 +1,42 @@
+#ifndef __FRAME_CLOCK_H__
+#define __FRAME_CLOCK_H__
+
+/**
+ * Measures the wall time between frames with a monotonic clock.
+ * Unlike clock(), which counts the CPU time of the whole process,
+ * the times do not depend on load or on how many threads are running,
+ * and never go backwards when the system time is changed.
+ */
+typedef struct frame_clock frame_clock_t;
+
+/**
+ * Reads the monotonic clock.
+ * Only differences between readings are meaningful.
+ *
+ * @return the current time in seconds, with sub-microsecond resolution
+ */
+double frame_clock_now(void);
+
+/**
+ * Allocates a clock that has not ticked yet.
+ *
+ * @return a pointer to the newly allocated clock
+ */
+frame_clock_t *frame_clock_init(void);
+
+/**
+ * Releases a clock.
+ *
+ * @param clock a pointer to a clock returned from frame_clock_init()
+ */
+void frame_clock_free(frame_clock_t *clock);
+
+/**
+ * Gets the time since the clock last ticked, and ticks it.
+ *
+ * @param clock a pointer to a clock returned from frame_clock_init()
+ * @return the elapsed time in seconds, or 0 the first time the clock ticks
+ */
+double frame_clock_tick(frame_clock_t *clock);
+
+#endif // #ifndef __FRAME_CLOCK_H__
@@ -0,0 +1,162 @@
+#ifndef __PARTICLE_FIELD_H__
+#define __PARTICLE_FIELD_H__
+
+#include "body.h"
+#include "color.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * One particle: a point drawn as a small flat-colored diamond.
+ * Particles have no shape, mass, or collisions.
+ */
+typedef struct particle
+{
+  // Relative to the field's origin
+  vector_t position;
+  // How far the diamond reaches from the position in each direction
+  float size;
+  rgb_color_t color;
+} particle_t;
+
+/**
+ * Many particles that move together, e.g. a starfield, kept in one packed
+ * array. Moving a field (with its velocity or the camera) moves only its
+ * origin, so a field costs the same to update however many particles it
+ * holds, and the renderer draws each field with a single batch.
+ */
+typedef struct particle_field particle_field_t;
+
+/**
+ * Allocates an empty field, at rest with its origin at (0, 0), in render
+ * layer 0 and not moved by the camera (camera mode LOCKED).
+ *
+ * @return a pointer to the newly allocated field
+ */
+particle_field_t *particle_field_init(void);
+
+/**
+ * Releases a field and its particles.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ */
+void particle_field_free(particle_field_t *field);
+
+/**
+ * Adds a particle to a field.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @param position where the particle is now, in scene coordinates
+ * @param size how far the particle reaches from its position
+ * @param color the particle's color
+ */
+void particle_field_add(particle_field_t *field, vector_t position,
+                        double size, rgb_color_t color);
+
+/**
+ * Removes the particles that lie entirely outside a rectangle,
+ * keeping the rest in order.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @param min the bottom left corner of the rectangle, in scene coordinates
+ * @param max the top right corner of the rectangle, in scene coordinates
+ * @return the number of particles removed
+ */
+size_t particle_field_remove_outside(particle_field_t *field, vector_t min,
+                                     vector_t max);
+
+/**
+ * Gets the number of particles in a field.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @return the number of particles
+ */
+size_t particle_field_size(particle_field_t *field);
+
+/**
+ * Gets a field's particles, packed in the order they were added.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @return the particle_field_size() particles, valid until the field changes
+ */
+particle_t *particle_field_get_particles(particle_field_t *field);
+
+/**
+ * Gets the point the particles' positions are relative to.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @return the field's origin, in scene coordinates
+ */
+vector_t particle_field_get_origin(particle_field_t *field);
+
+/**
+ * Sets the velocity every particle in a field moves at.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @param velocity the field's new velocity
+ */
+void particle_field_set_velocity(particle_field_t *field, vector_t velocity);
+
+/**
+ * Sets how the camera moves a field, like body_set_camera_mode().
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @param camera_mode the type of desired tracking
+ */
+void particle_field_set_camera_mode(particle_field_t *field,
+                                    camera_mode_t camera_mode);
+
+/**
+ * Sets the layer a field is drawn in, like body_set_render_layer().
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @param layer the field's layer, between INT16_MIN and INT16_MAX
+ */
+void particle_field_set_render_layer(particle_field_t *field, int layer);
+
+/**
+ * Gets the layer a field is drawn in.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @return the layer passed to particle_field_set_render_layer(), or 0
+ */
+int particle_field_get_render_layer(particle_field_t *field);
+
+/**
+ * Gets a number that identifies the field.
+ * No two fields created by the program ever share an id.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @return the field's id
+ */
+size_t particle_field_get_id(particle_field_t *field);
+
+/**
+ * Gets a number that changes whenever particles are added or removed,
+ * so a renderer can tell that a field changed without comparing particles.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @return the field's version
+ */
+size_t particle_field_get_version(particle_field_t *field);
+
+/**
+ * Gets the body that stands in for a field when the scene moves it:
+ * its centroid is the field's origin, and it has the field's velocity and
+ * camera mode. The body is owned by the field and is not in any scene.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @return the field's anchor body
+ */
+body_t *particle_field_get_anchor(particle_field_t *field);
+
+/**
+ * Moves a field's origin by its velocity over a time interval.
+ *
+ * @param field a pointer to a field returned from particle_field_init()
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void particle_field_tick(particle_field_t *field, double dt);
+
+#endif // #ifndef __PARTICLE_FIELD_H__
@@ -11,6 +11,17 @@
 #include <stdbool.h>
 #include "list.h"
 #include "vector.h"
+#include <stddef.h>
+
+/**
+ * A read-only look at a polygon whose vertices are stored one after another
+ * by someone else, e.g. a body (see body_get_shape_view()).
+ * Views are passed by value and never own or free their vertices.
+ */
+typedef struct polygon_view {
+  const vector_t *vertices;
+  size_t count;
+} polygon_view_t;
 
 /**
  * Computes the area of a polygon.
@@ -54,4 +65,20 @@ void polygon_translate(list_t *polygon, vector_t translation);
  */
 void polygon_rotate(list_t *polygon, double angle, vector_t point);
 
+/**
+ * Computes the area of a polygon, like polygon_area().
+ *
+ * @param polygon a view of the vertices, in a counterclockwise direction
+ * @return the area of the polygon
+ */
+double polygon_view_area(polygon_view_t polygon);
+
+/**
+ * Computes the center of mass of a polygon, like polygon_centroid().
+ *
+ * @param polygon a view of the vertices, in a counterclockwise direction
+ * @return the centroid of the polygon
+ */
+vector_t polygon_view_centroid(polygon_view_t polygon);
+
 #endif // #ifndef __POLYGON_H__
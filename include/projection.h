@@ -0,0 +1,68 @@
+#ifndef __PROJECTION_H__
+#define __PROJECTION_H__
+
+#include "vector.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A mapping from scene coordinates to pixel coordinates.
+ * Positive y is up in the scene and down on the screen, so y is flipped.
+ */
+typedef struct view
+{
+  // The scene coordinate that is drawn at pixel_center
+  vector_t center;
+  vector_t pixel_center;
+  // Pixels per scene unit
+  double scale;
+} view_t;
+
+/**
+ * Maps a scene coordinate to the nearest pixel in a view.
+ * Halfway cases are rounded to even, like the vectorized kernels.
+ *
+ * @param view the view to project with
+ * @param point a scene coordinate
+ * @return the pixel coordinate, rounded to an integer
+ */
+vector_t view_project(view_t view, vector_t point);
+
+/**
+ * Maps an array of scene coordinates to pixels, writing the x and y
+ * coordinates to separate arrays (as SDL2_gfx's polygon functions take).
+ * Each pixel is the same as view_project() would give, clamped to the
+ * range of an int16_t.
+ *
+ * @param view the view to project with
+ * @param points the scene coordinates
+ * @param n the number of points
+ * @param xs where to write the n x coordinates
+ * @param ys where to write the n y coordinates
+ */
+void view_project_pixels(view_t view, const vector_t *points, size_t n,
+                         int16_t *xs, int16_t *ys);
+
+/**
+ * Maps an array of scene coordinates to unrounded pixel coordinates,
+ * writing each as a pair of floats into an array of structures
+ * (e.g. the positions of SDL_Vertex values).
+ *
+ * @param view the view to project with
+ * @param points the scene coordinates
+ * @param n the number of points
+ * @param out where to write the first point's x and y
+ * @param stride the number of bytes between consecutive points in out
+ */
+void view_project_floats(view_t view, const vector_t *points, size_t n,
+                         float *out, size_t stride);
+
+/**
+ * Gets the instruction set that the projection kernels were compiled for,
+ * chosen when this file is compiled (e.g. with -mavx2).
+ *
+ * @return "avx2", "sse2" or "scalar"
+ */
+const char *projection_kernel(void);
+
+#endif // #ifndef __PROJECTION_H__
@@ -0,0 +1,222 @@
+#ifndef __RENDER_SNAPSHOT_H__
+#define __RENDER_SNAPSHOT_H__
+
+#include "body.h"
+#include "scene.h"
+#include "text.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Everything the renderer needs to draw one body.
+ */
+typedef struct body_record
+{
+  size_t id;
+  vector_t centroid;
+  double rotation;
+  // The corners of the body's bounding box
+  vector_t min, max;
+  rgb_color_t color;
+  // The path of the image the body shows, or NULL if it shows none.
+  // For an animated body, the frame shown at the renderer frame the
+  // snapshot was captured for. A copy owned by the snapshot.
+  const char *texture_path;
+  camera_mode_t camera_mode;
+  bool static_background;
+  int layer;
+  // The body's radius if it is a circle (see body_set_circle_lod()), or 0.
+  // A circle's vertices are only its collision proxy; the renderer draws
+  // the circle itself, with as many vertices as its size on screen needs.
+  double circle_radius;
+  // Where the body's vertices are in the snapshot's vertex array
+  size_t first_vertex, vertex_count;
+} body_record_t;
+
+/**
+ * Everything the renderer needs to draw one particle field.
+ */
+typedef struct particle_field_record
+{
+  size_t id;
+  size_t version;
+  // The particles' positions are relative to this point
+  vector_t origin;
+  int layer;
+  // Where the field's particles are in the snapshot's particle array
+  size_t first_particle, particle_count;
+} particle_field_record_t;
+
+/**
+ * Everything the renderer needs to draw one text.
+ */
+typedef struct text_record
+{
+  // Identifies the text in renderer caches; never dereferenced
+  text_t *text;
+  size_t version;
+  // Borrowed from the text by text_record_make(), which does not own its
+  // words either; a snapshot's records point at its own copy
+  const char *words;
+  double numbers;
+  vector_t position;
+  vector_t dimensions;
+  enum text_type_t type;
+} text_record_t;
+
+/**
+ * A copy of what a scene looked like after one step, in a form that can be
+ * drawn while the scene itself goes on to the next step (e.g. on another
+ * thread). The records reference no bodies, texts or animations: their
+ * paths and words are copied into the snapshot, and each animation is
+ * reduced to the path of the frame it shows. So a snapshot stays valid,
+ * and can be read on another thread, while the scene changes or is freed.
+ *
+ * A snapshot's arrays are reused each time it is captured, so capturing a
+ * scene of a steady size allocates nothing.
+ */
+typedef struct render_snapshot render_snapshot_t;
+
+/**
+ * Records the current state of a text, for drawing it right away.
+ * The record borrows the text's words, so it is only valid until they
+ * change.
+ *
+ * @param text the text to record
+ * @return the text's record
+ */
+text_record_t text_record_make(text_t *text);
+
+/**
+ * Allocates an empty snapshot.
+ *
+ * @return a pointer to the newly allocated snapshot
+ */
+render_snapshot_t *render_snapshot_init(void);
+
+/**
+ * Releases a snapshot.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ */
+void render_snapshot_free(render_snapshot_t *snapshot);
+
+/**
+ * Replaces the contents of a snapshot with the current state of a scene.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @param scene the scene to record
+ * @param frame the number of the renderer frame the snapshot will be drawn
+ *   in, which picks the frame each animated body shows
+ */
+void render_snapshot_capture(render_snapshot_t *snapshot, scene_t *scene,
+                             size_t frame);
+
+/**
+ * Gets a signature of everything a snapshot draws, computed when it was
+ * captured. Snapshots that would draw the same frame have the same
+ * signature, and any change to a record (almost certainly) changes it,
+ * so a renderer can skip frames identical to the one on screen.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @return a hash of the snapshot's records
+ */
+uint64_t render_snapshot_signature(render_snapshot_t *snapshot);
+
+/**
+ * Gets how many times the snapshot's scene had been ticked when it was
+ * captured (see scene_get_tick_calls()). Not part of the signature: a
+ * running scene can look the same from one frame to the next, but a
+ * renderer should not wait for input while it runs.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @return the scene's tick count at capture
+ */
+size_t render_snapshot_tick_calls(render_snapshot_t *snapshot);
+
+/**
+ * Gets the number of times a snapshot has allocated memory for its arrays.
+ * Capturing a scene no larger than one captured before allocates nothing.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @return the number of allocations since the snapshot was created
+ */
+size_t render_snapshot_allocations(render_snapshot_t *snapshot);
+
+/**
+ * Gets the number of bodies in a snapshot.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @return the number of bodies the scene had when it was captured
+ */
+size_t render_snapshot_bodies(render_snapshot_t *snapshot);
+
+/**
+ * Gets the record of a body in a snapshot, in scene order.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @param index the index of the body
+ * @return the body's record, valid until the snapshot is next captured
+ */
+body_record_t *render_snapshot_get_body(render_snapshot_t *snapshot,
+                                        size_t index);
+
+/**
+ * Gets the vertices of a body in a snapshot.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @param record a record returned from render_snapshot_get_body()
+ * @return the record's vertex_count vertices, in scene coordinates
+ */
+vector_t *render_snapshot_get_vertices(render_snapshot_t *snapshot,
+                                       body_record_t *record);
+
+/**
+ * Gets the number of particle fields in a snapshot.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @return the number of fields the scene had when it was captured
+ */
+size_t render_snapshot_particle_fields(render_snapshot_t *snapshot);
+
+/**
+ * Gets the record of a particle field in a snapshot, in scene order.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @param index the index of the field
+ * @return the field's record, valid until the snapshot is next captured
+ */
+particle_field_record_t *
+render_snapshot_get_particle_field(render_snapshot_t *snapshot, size_t index);
+
+/**
+ * Gets the particles of a particle field in a snapshot.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @param record a record returned from render_snapshot_get_particle_field()
+ * @return the record's particle_count particles, positioned relative to its
+ *   origin
+ */
+particle_t *render_snapshot_get_particles(render_snapshot_t *snapshot,
+                                          particle_field_record_t *record);
+
+/**
+ * Gets the number of texts in a snapshot.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @return the number of texts the scene had when it was captured
+ */
+size_t render_snapshot_texts(render_snapshot_t *snapshot);
+
+/**
+ * Gets the record of a text in a snapshot, in scene order.
+ *
+ * @param snapshot a pointer to a snapshot returned from render_snapshot_init()
+ * @param index the index of the text
+ * @return the text's record, valid until the snapshot is next captured
+ */
+text_record_t *render_snapshot_get_text(render_snapshot_t *snapshot,
+                                        size_t index);
+
+#endif // #ifndef __RENDER_SNAPSHOT_H__
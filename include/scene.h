@@ -2,7 +2,9 @@
 #define __SCENE_H__
 
 #include "body.h"
+#include "broadphase.h"
 #include "list.h"
+#include "particle_field.h"
 #include "text.h"
 
 /**
@@ -12,6 +14,12 @@
  */
 typedef struct scene scene_t;
 
+/**
+ * The step and catch-up limit that scene_tick_fixed() starts with.
+ */
+extern const double SCENE_DEFAULT_FIXED_STEP;
+extern const size_t SCENE_DEFAULT_MAX_FIXED_STEPS;
+
 /**
  * Calculates the offset vector based off of a focal body and aux info.
  */
@@ -31,6 +39,15 @@ typedef vector_t (*camera_mover_func_t)(vector_t offset, body_t *body);
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * A force creator for a collision between two bodies,
+ * which can only act while the bodies' shapes touch.
+ * Besides the auxiliary value, it is told whether the scene's broadphase
+ * found the bodies' bounding boxes overlapping this tick.
+ * If not, the shapes cannot touch, so it can skip testing them.
+ */
+typedef void (*collision_creator_t)(void *aux, bool may_collide);
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -119,6 +136,83 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Adds a collision force creator for two bodies to a scene,
+ * to be invoked every time scene_tick() is called, in order with the other
+ * force creators. Each tick, the scene's broadphase finds which bodies in
+ * collision force creators have overlapping bounding boxes, without testing
+ * every pair, and tells each collision force creator whether its pair did.
+ * Like scene_add_bodies_force_creator(), the force creator is removed when
+ * either body is removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body that can collide
+ * @param body2 the second body that can collide
+ * @param collider a collision force creator function
+ * @param aux an auxiliary value to pass to collider when it is called
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_creator(scene_t *scene, body_t *body1, body_t *body2,
+                                 collision_creator_t collider, void *aux,
+                                 free_func_t freer);
+
+/**
+ * Sets how the scene's broadphase finds the collision force creators whose
+ * bodies may collide. Scenes start in BROADPHASE_GRID mode.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param mode the broadphase mode, see broadphase_mode_t
+ */
+void scene_set_broadphase_mode(scene_t *scene, broadphase_mode_t mode);
+
+/**
+ * Gets how the scene's broadphase finds the collision force creators whose
+ * bodies may collide.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the mode passed to scene_set_broadphase_mode(), or BROADPHASE_GRID
+ */
+broadphase_mode_t scene_get_broadphase_mode(scene_t *scene);
+
+/**
+ * Called for each body found by scene_query_aabb().
+ *
+ * @param body a body whose bounding box overlaps the query's box
+ * @param aux the auxiliary value passed to scene_query_aabb()
+ * @return true to keep searching, or false to stop the query
+ */
+typedef bool (*scene_query_func_t)(body_t *body, void *aux);
+
+/**
+ * Finds the bodies in a scene whose bounding boxes overlap a box.
+ * Bodies are kept in dynamic AABB trees for queries (the same trees as
+ * BROADPHASE_AABB_TREE), so only the bodies near the box are looked at.
+ * Bodies that are removed but not yet freed are skipped.
+ * func may query the scene again, but must not move, add or remove bodies
+ * until the query returns.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param box the box to search
+ * @param func called with each body found, in no particular order
+ * @param aux an auxiliary value to pass to func
+ */
+void scene_query_aabb(scene_t *scene, aabb_t box, scene_query_func_t func,
+                      void *aux);
+
+/**
+ * Finds the first body a ray hits in a scene, like scene_query_aabb().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param origin where the ray starts
+ * @param direction the direction of the ray, which need not be a unit vector
+ * @param max_distance how far the ray reaches
+ * @param distance if not NULL, set to the distance along the ray to the
+ *   first edge of the body's shape it crosses
+ * @return the closest body hit, or NULL if the ray hits none
+ */
+body_t *scene_raycast(scene_t *scene, vector_t origin, vector_t direction,
+                      double max_distance, double *distance);
+
 /**
  * Adds a force camera management system to the scene. The camera offset
  * function calculates some vector to base the camera mover funciton on. The
@@ -167,6 +261,77 @@ void scene_set_focal_body(scene_t *scene, body_t *focal_body);
  */
 void scene_tick(scene_t *scene, double dt);
 
+/**
+ * Sets the step used by scene_tick_fixed().
+ * Scenes start with a step of SCENE_DEFAULT_FIXED_STEP and at most
+ * SCENE_DEFAULT_MAX_FIXED_STEPS steps per call.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param step the time each scene_tick() advances the scene by, in seconds
+ * @param max_steps the most ticks one call to scene_tick_fixed() may run
+ */
+void scene_set_fixed_step(scene_t *scene, double step, size_t max_steps);
+
+/**
+ * Advances a scene by the elapsed time in ticks of a fixed step, so the
+ * physics do not depend on the frame rate.
+ * Time that does not fill a whole step is carried over to the next call.
+ * If more than max_steps steps are due (e.g. after a stall), only max_steps
+ * are run and the rest of the time is dropped, so a slow frame cannot make
+ * the following frames slower.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the time elapsed since the last call, in seconds
+ * @return the time the scene was advanced by, in seconds
+ */
+double scene_tick_fixed(scene_t *scene, double dt);
+
+/**
+ * Gets how far the time carried over by scene_tick_fixed() is into the
+ * next step. A renderer can blend the last two ticks by this amount.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the carried over time divided by the step, in [0, 1)
+ */
+double scene_get_interpolation_alpha(scene_t *scene);
+
+/**
+ * Counts the calls to scene_tick() and scene_tick_fixed(), including calls
+ * to scene_tick_fixed() too soon after the last one to run a step. A count
+ * that changed between frames means the scene is running, even if nothing
+ * in it looks different yet.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of calls since the scene was created
+ */
+size_t scene_get_tick_calls(scene_t *scene);
+
+/**
+ * Adds a particle field to a scene, which frees it with the scene.
+ * Each tick moves the field by its velocity and, like a body, by the camera.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param field a pointer to a field returned from particle_field_init()
+ */
+void scene_add_particle_field(scene_t *scene, particle_field_t *field);
+
+/**
+ * Gets the number of particle fields in a scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of fields added with scene_add_particle_field()
+ */
+size_t scene_particle_fields(scene_t *scene);
+
+/**
+ * Gets the particle field at a given index in a scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the field, in the order fields were added
+ * @return a pointer to the field at the given index
+ */
+particle_field_t *scene_get_particle_field(scene_t *scene, size_t index);
+
 void scene_add_text(scene_t *scene, text_t *text);
 
 size_t scene_text(scene_t *scene);
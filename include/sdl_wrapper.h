@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include "color.h"
 #include "list.h"
+#include "render_snapshot.h"
 #include "scene.h"
 #include "vector.h"
 #include "text.h"
@@ -36,6 +37,96 @@ typedef enum
     KEY_RELEASED
 } key_event_type_t;
 
+/**
+ * Where frames are drawn.
+ */
+typedef enum
+{
+    // A window on the display, with SDL's default renderer
+    BACKEND_WINDOW,
+    // An offscreen SDL_Surface, drawn by SDL's software renderer.
+    // Needs no display; see sdl_get_surface().
+    BACKEND_SOFTWARE,
+    // Nothing is drawn and no images or fonts are loaded; frames only
+    // count the work they would do in render_stats_t. Needs no display.
+    BACKEND_NULL,
+} render_backend_t;
+
+/**
+ * The ways sdl_render_scene() can submit bodies to the renderer.
+ */
+typedef enum
+{
+    // Each body is drawn with its own draw call (the default)
+    RENDER_IMMEDIATE,
+    // Bodies are triangulated into one vertex buffer per frame, and each run
+    // of bodies sharing a texture (or having none) is drawn with one call
+    RENDER_BATCHED,
+} render_mode_t;
+
+/**
+ * The phases of drawing a frame whose time is measured.
+ */
+typedef enum
+{
+    // Capturing the scene into a snapshot in sdl_render_scene().
+    // sdl_run_simulation() captures on its own thread, so it is not counted.
+    RENDER_PHASE_CAPTURE,
+    // Uploading the assets that finished loading
+    RENDER_PHASE_UPLOAD,
+    // Bringing static layers up to date and drawing them
+    RENDER_PHASE_STATIC_LAYERS,
+    // Culling bodies and sorting them into drawing order
+    RENDER_PHASE_QUEUE,
+    // Drawing bodies and particle fields
+    RENDER_PHASE_BODIES,
+    RENDER_PHASE_TEXT,
+    // Drawing the boundary and the statistics overlay, and presenting,
+    // including any wait for vsync
+    RENDER_PHASE_PRESENT,
+    RENDER_PHASE_COUNT,
+} render_phase_t;
+
+/**
+ * Counts of the work done to draw a frame.
+ */
+typedef struct render_stats
+{
+    // Calls that submit geometry, images or text to the renderer
+    size_t draw_calls;
+    // Bodies drawn by sdl_render_scene()
+    size_t bodies_drawn;
+    // Bodies skipped by sdl_render_scene() because they were off screen
+    size_t culled_bodies;
+    // Polygons drawn, and their vertices, including circles tessellated for
+    // their size on screen
+    size_t polygons_drawn;
+    size_t vertices_drawn;
+    // Particles drawn from the scene's particle fields
+    size_t particles_drawn;
+    // Times the renderer switched between bodies' textures (or flat colors)
+    // while drawing bodies
+    size_t texture_switches;
+    // Static background layers that had to be drawn again into their textures
+    size_t static_layer_redraws;
+    // Textures created: images uploaded, atlases packed, and textures for
+    // static layers and text
+    size_t textures_created;
+    // Texts drawn into their textures again because they changed
+    size_t text_rasterizations;
+    // Heap allocations made to draw the frame, when the renderer's reusable
+    // buffers had to grow. Zero once a scene's size is steady.
+    size_t allocations;
+    // Whether the frame was skipped because it was identical to the one on
+    // screen, so nothing was drawn or presented
+    bool idle;
+    // Milliseconds of wall time spent in each phase, by the monotonic frame
+    // clock, so time the thread was blocked or preempted counts too.
+    // Renderers may do the GPU's share of the work later, e.g. when the
+    // frame is presented. Waiting for input between frames is in no phase.
+    double phase_ms[RENDER_PHASE_COUNT];
+} render_stats_t;
+
 /**
  * A keypress handler.
  * When a key is pressed or released, the handler is passed its char value.
@@ -49,15 +140,68 @@ typedef enum
  */
 typedef void (*key_handler_t)(char key, key_event_type_t type, double held_time, void *event_args);
 
+/**
+ * One step of a simulation run by sdl_run_simulation().
+ *
+ * @param aux the argument passed to sdl_run_simulation()
+ * @return the scene to draw after the step, or NULL to stop the simulation
+ */
+typedef scene_t *(*simulation_step_t)(void *aux);
+
+/**
+ * Told how loading the assets passed to sdl_load_assets() is going.
+ *
+ * @param loaded the number of assets uploaded so far
+ * @param total the number of assets in the manifest
+ * @param aux the argument passed to sdl_load_assets()
+ */
+typedef void (*asset_progress_t)(size_t loaded, size_t total, void *aux);
+
 /**
  * Initializes the SDL window and renderer.
  * Must be called once before any of the other SDL functions.
  *
+ * The backend can be chosen with the SDL_WRAPPER_BACKEND environment
+ * variable ("window", "software", or "null"), and defaults to a window.
+ * If SDL_WRAPPER_MAX_FRAMES is set to a positive number, sdl_is_done()
+ * returns true once that many frames have been shown, so headless runs end.
+ * If SDL_WRAPPER_STATS_CSV is set to a path, every frame's statistics (see
+ * sdl_get_frame_stats()) are written there as CSV, a few hundred frames at a
+ * time; sdl_quit() writes the rest.
+ *
+ * Pressing F3 shows or hides an overlay of the last frame's statistics.
+ *
  * @param min the x and y coordinates of the bottom left of the scene
  * @param max the x and y coordinates of the top right of the scene
  */
 void sdl_init(vector_t min, vector_t max);
 
+/**
+ * Initializes SDL to draw with the given backend, ignoring
+ * SDL_WRAPPER_BACKEND. Otherwise the same as sdl_init().
+ *
+ * @param min the x and y coordinates of the bottom left of the scene
+ * @param max the x and y coordinates of the top right of the scene
+ * @param backend where frames are drawn
+ */
+void sdl_init_with_backend(vector_t min, vector_t max,
+                           render_backend_t backend);
+
+/**
+ * Gets the surface that the software backend draws into.
+ * Its contents are the last frame shown.
+ *
+ * @return the surface, or NULL if the backend is not BACKEND_SOFTWARE
+ */
+SDL_Surface *sdl_get_surface(void);
+
+/**
+ * Releases everything created by sdl_init(), including cached textures
+ * and fonts, and shuts SDL down. No other SDL functions may be called
+ * afterwards. Must be called before TTF_Quit().
+ */
+void sdl_quit(void);
+
 /**
  * Processes all SDL events and returns whether the window has been closed.
  * This function must be called in order to handle keypresses.
@@ -67,6 +211,16 @@ void sdl_init(vector_t min, vector_t max);
  */
 bool sdl_is_done();
 
+/**
+ * Like sdl_is_done(), but first waits for an event to arrive, so a program
+ * whose screen is static can sleep rather than poll.
+ * Returns as soon as an event is handled, so input is not delayed.
+ *
+ * @param timeout the longest time to wait for an event, in seconds
+ * @return true if the window was closed, false otherwise
+ */
+bool sdl_is_done_wait(double timeout);
+
 /**
  * Clears the screen. Should be called before drawing polygons in each frame.
  */
@@ -80,6 +234,14 @@ void sdl_clear(void);
  */
 void sdl_draw_polygon(list_t *points, rgb_color_t color);
 
+/**
+ * Draws a polygon like sdl_draw_polygon(), without copying its vertices.
+ *
+ * @param polygon a view of the vertices, e.g. from body_get_shape_view()
+ * @param color the color used to fill in the polygon
+ */
+void sdl_draw_polygon_view(polygon_view_t polygon, rgb_color_t color);
+
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
@@ -90,11 +252,117 @@ void sdl_show(void);
  * Draws all bodies in a scene.
  * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
  * so those functions should not be called directly.
+ * Bodies are drawn in order of their layers (see body_set_render_layer()),
+ * and the bodies in each layer are grouped by texture, so the renderer
+ * switches textures as few times as possible.
  *
  * @param scene the scene to draw
  */
 void sdl_render_scene(scene_t *scene);
 
+/**
+ * Draws a snapshot of a scene, like sdl_render_scene().
+ * The snapshot's scene can be changed, or stepped on another thread,
+ * while the snapshot is drawn.
+ * If the snapshot would draw exactly what is on screen, nothing is drawn
+ * or presented and the frame's statistics are marked idle.
+ *
+ * @param snapshot the snapshot to draw
+ */
+void sdl_render_snapshot(render_snapshot_t *snapshot);
+
+/**
+ * Runs a simulation until it stops or the window is closed, stepping it on
+ * a worker thread while the main thread draws the previous step.
+ * Each step is captured into one of two snapshots: while one is drawn, the
+ * next step is captured into the other, so a slow frame and a slow step
+ * overlap rather than add up. All SDL calls stay on the calling thread.
+ *
+ * Key handlers are called between steps, when the worker is idle,
+ * so they may change the simulation's state.
+ * While the drawn frames are idle (see render_stats_t) and the scene is
+ * not being ticked (see scene_get_tick_calls()), the loop waits for input
+ * with sdl_is_done_wait() instead of stepping continuously.
+ * The step function must not call any sdl_* functions.
+ *
+ * @param step the function that advances the simulation by one step
+ * @param aux the argument to pass to step
+ */
+void sdl_run_simulation(simulation_step_t step, void *aux);
+
+/**
+ * Chooses how sdl_render_scene() submits bodies to the renderer.
+ * RENDER_BATCHED needs SDL 2.0.18 or later for SDL_RenderGeometry().
+ *
+ * @param mode the render mode to use for the following frames
+ */
+void sdl_set_render_mode(render_mode_t mode);
+
+/**
+ * Gets the statistics for the most recently shown frame.
+ * A frame starts with sdl_clear() and ends with sdl_show(), except that
+ * sdl_render_scene() and sdl_render_snapshot() count their work before
+ * sdl_clear() in the frame too.
+ *
+ * @return the work done to draw the last frame
+ */
+render_stats_t sdl_get_frame_stats(void);
+
+/**
+ * Starts loading the images and fonts listed in a manifest file
+ * (see asset_manifest.h) on background threads. Each frame begins by
+ * uploading the assets decoded since the last one, so frames can be drawn
+ * while the rest load. Bodies whose images are still loading are not drawn,
+ * and no asset in the manifest is ever loaded from disk while drawing.
+ * Assets packed into the bundle (see asset_bundle.h) are used from it
+ * without decoding; the rest are loaded from their files.
+ * Must be called at most once, after sdl_init() and before
+ * sdl_load_texture_atlas(). The null backend loads nothing.
+ *
+ * @param manifest_path the path to the manifest file
+ * @param bundle_path the path to a bundle packed from the manifest, or NULL.
+ *   If there is no bundle there, every asset is loaded from its file.
+ * @param progress called after each frame that uploaded assets is shown,
+ *   or NULL. It is called on the thread that draws frames.
+ * @param aux the argument to pass to progress
+ */
+void sdl_load_assets(const char *manifest_path, const char *bundle_path,
+                     asset_progress_t progress, void *aux);
+
+/**
+ * Checks whether every asset passed to sdl_load_assets() has been uploaded.
+ *
+ * @return whether no assets are still loading
+ */
+bool sdl_assets_loaded(void);
+
+/**
+ * Packs images into one texture, so that bodies drawn with any of them
+ * (including animation frames) share a texture and need no texture switches.
+ * Images not in the atlas are still drawn, from their own textures.
+ * If the images are being loaded by sdl_load_assets(), the atlas is packed
+ * from them once they have all been decoded.
+ * Must be called at most once, after sdl_init().
+ *
+ * @param texture_paths the paths of the images to pack
+ * @param count the number of paths
+ */
+void sdl_load_texture_atlas(char **texture_paths, size_t count);
+
+/**
+ * Drops the cached texture for an image path, freeing its renderer memory.
+ * The image is decoded again the next time a body uses it.
+ *
+ * @param texture_path the path returned by body_get_texture_path()
+ */
+void sdl_evict_texture(const char *texture_path);
+
+/**
+ * Drops every cached texture.
+ * Useful when switching between screens that share no images.
+ */
+void sdl_clear_textures(void);
+
 /**
  * Registers a function to be called every time a key is pressed.
  * Overwrites any existing handler.
@@ -131,15 +399,18 @@ void sdl_on_key(key_handler_t handler);
 void sdl_event_args(void *args);
 
 /**
- * Gets the amount of time that has passed since the last time
- * this function was called, in seconds.
+ * Gets the amount of wall time that has passed since the last time
+ * this function was called, in seconds, measured with a monotonic clock.
  *
  * @return the number of seconds that have elapsed
  */
 double time_since_last_tick(void);
 
 /**
- * Creates words with numbers on the screen
+ * Creates words with numbers on the screen.
+ * The string is built from a cached glyph atlas of the HUD font into a
+ * texture that is kept until the text's version changes, so unchanged
+ * text is neither reformatted nor redrawn.
  * 
  * @param text text to appear on screen
  */
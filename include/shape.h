@@ -0,0 +1,94 @@
+#ifndef __SHAPE_H__
+#define __SHAPE_H__
+
+#include "list.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * An immutable polygon in its own local space, shared by every body with
+ * the same outline. Shapes are interned: asking for a shape with the same
+ * vertices as a live shape returns that shape with one more reference,
+ * so a thousand identical asteroids store their vertices once. Bodies
+ * place a shape in the scene with their own position and rotation.
+ */
+typedef struct shape shape_t;
+
+/**
+ * Gets the shape with the given local vertices, creating it if no live
+ * shape has exactly these vertices. The caller owns one reference.
+ *
+ * @param vertices the polygon's vertices in local space, which are copied
+ * @param count the number of vertices, at least 3
+ * @return the interned shape
+ */
+shape_t *shape_intern(vector_t *vertices, size_t count);
+
+/**
+ * Gets the shape of a polygon, with its vertices made relative to its
+ * centroid, like shape_intern().
+ *
+ * @param polygon a list of vectors in scene coordinates, which is freed
+ * @param centroid if not NULL, set to the polygon's centroid, where the
+ *   shape's origin lies in the scene
+ * @return the interned shape
+ */
+shape_t *shape_intern_polygon(list_t *polygon, vector_t *centroid);
+
+/**
+ * Gets the shape of a regular polygon inscribed in a circle centered at the
+ * origin, like sprite_make_circle_points(), without building a list.
+ *
+ * @param radius the distance from the origin of each vertex
+ * @param count the number of vertices, at least 3
+ * @return the interned shape
+ */
+shape_t *shape_intern_circle(double radius, size_t count);
+
+/**
+ * Takes another reference to a shape.
+ *
+ * @param shape a shape returned from one of the shape_intern functions
+ * @return the same shape
+ */
+shape_t *shape_retain(shape_t *shape);
+
+/**
+ * Gives up a reference to a shape, freeing it once no references are left.
+ *
+ * @param shape a shape returned from one of the shape_intern functions
+ */
+void shape_release(shape_t *shape);
+
+/**
+ * Gets the number of vertices of a shape.
+ *
+ * @param shape a shape returned from one of the shape_intern functions
+ * @return the number of vertices
+ */
+size_t shape_vertex_count(shape_t *shape);
+
+/**
+ * Gets the vertices of a shape, in local space. They must not be modified.
+ *
+ * @param shape a shape returned from one of the shape_intern functions
+ * @return the shape_vertex_count() vertices, valid while the shape is
+ */
+vector_t *shape_get_vertices(shape_t *shape);
+
+/**
+ * Gets the number of references to a shape.
+ *
+ * @param shape a shape returned from one of the shape_intern functions
+ * @return how many times the shape was interned or retained and not released
+ */
+size_t shape_refs(shape_t *shape);
+
+/**
+ * Gets the number of distinct shapes that are alive.
+ *
+ * @return the number of interned shapes that have references
+ */
+size_t shape_interned_count(void);
+
+#endif // #ifndef __SHAPE_H__
@@ -9,10 +9,19 @@
 #define __SPRITE_H__
 
 #include "list.h"
+#include "vector.h"
 #include <math.h>
 
 extern const size_t SPRITE_CIRCLE_POINTS_PER_RADIAN;
 extern const double SPRITE_PACMAN_MOUTH_ANGLE;
+/** The number of vertices in the polygon that stands in for a circle
+ *  in collisions (see body_set_circle_lod()) */
+extern const size_t SPRITE_CIRCLE_PROXY_POINTS;
+/** The fewest and most vertices a circle is drawn with */
+extern const size_t SPRITE_CIRCLE_MIN_POINTS;
+extern const size_t SPRITE_CIRCLE_MAX_POINTS;
+/** How far, in pixels, a drawn circle's edges may fall inside the circle */
+extern const double SPRITE_CIRCLE_MAX_ERROR;
 
 /** @brief Computes the vertices of a n-sided star.
  *
@@ -88,4 +97,38 @@ list_t *sprite_make_pacman(double radius);
 */
 list_t *sprite_make_circle(double radius);
 
+/** @brief Makes a regular polygon with the given number of vertices,
+ *  inscribed in a circle centered at the origin. The first vertex is on
+ *  the positive x-axis and the rest follow counterclockwise.
+ *
+ * @param radius the distance from the origin of each point
+ * @param num_points the number of vertices, at least 3
+ * @return list of vectors representing points on the circle
+*/
+list_t *sprite_make_circle_points(double radius, size_t num_points);
+
+/** @brief Picks how many vertices a circle needs to look round on screen:
+ *  enough that no edge falls more than SPRITE_CIRCLE_MAX_ERROR pixels
+ *  inside the circle, between SPRITE_CIRCLE_MIN_POINTS and
+ *  SPRITE_CIRCLE_MAX_POINTS.
+ *
+ * @param pixel_radius the radius of the circle on screen, in pixels
+ * @return the number of vertices to draw the circle with
+*/
+size_t sprite_circle_points_for_radius(double pixel_radius);
+
+/** @brief Writes the vertices of a regular polygon inscribed in a circle
+ *  into an array, without allocating. The vertices go counterclockwise,
+ *  starting at the given angle from the x-axis.
+ *
+ * @param vertices where to write the vertices
+ * @param num_points the number of vertices, at least 3
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param angle the angle of the first vertex
+ * @return none
+*/
+void sprite_fill_circle(vector_t *vertices, size_t num_points, vector_t center,
+                        double radius, double angle);
+
 #endif // #ifndef __SPRITE_H__
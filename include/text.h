@@ -2,7 +2,6 @@
 #define __TEXT_H__
 
 #include "body.h"
-#include "scene.h"
 #include <math.h>
 #include <stdio.h>
 
@@ -43,7 +42,10 @@ text_t *text_init(char *words, vector_t text_position, double text_size,
                           double numbers, vector_t text_dimensions);
 
 /**
- * Sets the words to be in the text
+ * Sets the words to be in the text.
+ * Always changes the text's version, even for the same pointer, since the
+ * caller may have written new words into it. Call this after changing the
+ * words in place, too.
  *
  * @param text text object
  * @param endzone string
@@ -67,7 +69,8 @@ void text_set_text_position(text_t *text, vector_t text_position);
 void text_set_text_size(text_t *text, double text_size);
 
 /**
- * Sets the numbers in the text
+ * Sets the numbers in the text.
+ * Changes the text's version if the numbers are different.
  *
  * @param text text object
  * @param numbers numbers to add into text
@@ -138,4 +141,15 @@ vector_t text_get_text_dimensions(text_t *text);
  */
 void *text_get_type(text_t *text);
 
+/**
+ * Gets the version of the text's contents.
+ * The version changes whenever text_set_words() or text_set_numbers()
+ * change what the text says, so renderers can cache the drawn text
+ * and only redraw it when the version differs.
+ *
+ * @param text text object
+ * @return the current version of the text
+ */
+size_t text_get_version(text_t *text);
+
 #endif // #ifndef __TEXT_H__
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef __TEXT_CACHE_H__
+#define __TEXT_CACHE_H__
+
+#include "font_cache.h"
+#include "render_snapshot.h"
+#include <SDL2/SDL.h>
+
+/**
+ * Rendered textures for text objects, keyed by the text and its version.
+ * A text's string is only formatted and drawn into its texture when
+ * text_get_version() changes, so unchanged text costs one copy per frame.
+ */
+typedef struct text_cache text_cache_t;
+
+/**
+ * Allocates an empty text cache that creates textures for a renderer.
+ * The renderer must outlive the cache.
+ *
+ * @param renderer the renderer that text textures are created for
+ * @return a pointer to the newly allocated cache
+ */
+text_cache_t *text_cache_init(SDL_Renderer *renderer);
+
+/**
+ * Destroys every cached texture and releases the cache.
+ *
+ * @param cache a pointer to a cache returned from text_cache_init()
+ */
+void text_cache_free(text_cache_t *cache);
+
+/**
+ * Formats the string a text displays: its words, followed by its number
+ * if the number is not negative.
+ *
+ * @param text the record of the text to format
+ * @param buffer where to write the string
+ * @param size the size of buffer
+ */
+void text_cache_format(text_record_t *text, char *buffer, size_t size);
+
+/**
+ * Draws a text stretched to fill a rectangle, rebuilding its cached texture
+ * from the glyph atlas only if the text has changed since it was last drawn.
+ *
+ * @param cache a pointer to a cache returned from text_cache_init()
+ * @param atlas the glyph atlas to build the text's texture from
+ * @param text the record of the text to draw
+ * @param bounds the screen rectangle to draw the text into
+ */
+void text_cache_draw(text_cache_t *cache, glyph_atlas_t *atlas,
+                     text_record_t *text, SDL_Rect bounds);
+
+/**
+ * Releases the textures of texts that have not been drawn since the
+ * previous sweep, so texts removed from a scene do not leak textures.
+ * Should be called once per frame, after all text is drawn.
+ *
+ * @param cache a pointer to a cache returned from text_cache_init()
+ */
+void text_cache_sweep(text_cache_t *cache);
+
+/**
+ * Gets the number of times a text's string was drawn into its texture
+ * because the text changed.
+ *
+ * @param cache a pointer to a cache returned from text_cache_init()
+ * @return the number of strings drawn since the cache was created
+ */
+size_t text_cache_rasterizations(text_cache_t *cache);
+
+/**
+ * Gets the number of textures the cache has created for texts.
+ *
+ * @param cache a pointer to a cache returned from text_cache_init()
+ * @return the number of textures created since the cache was created
+ */
+size_t text_cache_uploads(text_cache_t *cache);
+
+#endif // #ifndef __TEXT_CACHE_H__
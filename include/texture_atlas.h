@@ -0,0 +1,90 @@
+#ifndef __TEXTURE_ATLAS_H__
+#define __TEXTURE_ATLAS_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Several images packed into one renderer texture.
+ * Each image is drawn by copying its source rectangle out of the texture,
+ * so bodies drawn with different images in the atlas share one texture.
+ */
+typedef struct texture_atlas texture_atlas_t;
+
+/**
+ * The index texture_atlas_find() returns for images not in the atlas.
+ */
+extern const size_t TEXTURE_ATLAS_NOT_FOUND;
+
+/**
+ * Loads images and packs them into one texture on a renderer.
+ * Images that fail to load are reported to stderr and left out.
+ * The renderer must outlive the atlas.
+ *
+ * @param renderer the renderer that the atlas texture is created for
+ * @param paths the paths of the images to pack
+ * @param count the number of paths
+ * @return a pointer to the newly allocated atlas, or NULL if the atlas
+ *   texture could not be created
+ */
+texture_atlas_t *texture_atlas_init(SDL_Renderer *renderer, char **paths,
+                                    size_t count);
+
+/**
+ * Packs images that have already been loaded into one texture on a renderer,
+ * like texture_atlas_init(). The surfaces are not freed, but their blend
+ * modes are changed so their alpha is copied rather than blended.
+ *
+ * @param renderer the renderer that the atlas texture is created for
+ * @param paths the paths the images were loaded from
+ * @param surfaces the images' pixels; NULL entries are left out
+ * @param count the number of paths and surfaces
+ * @return a pointer to the newly allocated atlas, or NULL if the atlas
+ *   texture could not be created
+ */
+texture_atlas_t *texture_atlas_pack(SDL_Renderer *renderer, char **paths,
+                                    SDL_Surface **surfaces, size_t count);
+
+/**
+ * Destroys the atlas texture and releases the atlas.
+ *
+ * @param atlas a pointer to an atlas returned from texture_atlas_init()
+ */
+void texture_atlas_free(texture_atlas_t *atlas);
+
+/**
+ * Finds an image in the atlas by the path it was loaded from.
+ *
+ * @param atlas a pointer to an atlas returned from texture_atlas_init()
+ * @param path the path of the image
+ * @return the image's index, or TEXTURE_ATLAS_NOT_FOUND
+ */
+size_t texture_atlas_find(texture_atlas_t *atlas, const char *path);
+
+/**
+ * Gets the texture that every image in the atlas is drawn from.
+ *
+ * @param atlas a pointer to an atlas returned from texture_atlas_init()
+ * @return the atlas texture
+ */
+SDL_Texture *texture_atlas_get_texture(texture_atlas_t *atlas);
+
+/**
+ * Gets the size of the atlas texture.
+ *
+ * @param atlas a pointer to an atlas returned from texture_atlas_init()
+ * @return the width and height of the atlas texture in pixels
+ */
+SDL_Point texture_atlas_get_size(texture_atlas_t *atlas);
+
+/**
+ * Gets where an image lives in the atlas texture.
+ *
+ * @param atlas a pointer to an atlas returned from texture_atlas_init()
+ * @param index an index returned from texture_atlas_find()
+ * @return the image's rectangle in the atlas texture
+ */
+SDL_Rect texture_atlas_get_source(texture_atlas_t *atlas, size_t index);
+
+#endif // #ifndef __TEXTURE_ATLAS_H__
@@ -0,0 +1,92 @@
+#ifndef __TEXTURE_CACHE_H__
+#define __TEXTURE_CACHE_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A cache of renderer textures keyed by the path of the image they came from.
+ * Each image is decoded and uploaded to the renderer once, the first time it
+ * is requested, and is kept until it is evicted or the cache is freed.
+ */
+typedef struct texture_cache texture_cache_t;
+
+/**
+ * Allocates an empty texture cache that uploads textures to a renderer.
+ * The renderer must outlive the cache.
+ *
+ * @param renderer the renderer that textures are created for
+ * @return a pointer to the newly allocated cache
+ */
+texture_cache_t *texture_cache_init(SDL_Renderer *renderer);
+
+/**
+ * Destroys every cached texture and releases the cache itself.
+ *
+ * @param cache a pointer to a cache returned from texture_cache_init()
+ */
+void texture_cache_free(texture_cache_t *cache);
+
+/**
+ * Gets the texture for an image, loading and uploading it on first use.
+ * Paths that fail to load are remembered, so a missing file is only
+ * reported (and only hits the disk) once.
+ * The cache keeps its own copy of the path, so the string passed here may
+ * be freed or reused afterwards.
+ *
+ * @param cache a pointer to a cache returned from texture_cache_init()
+ * @param path the path to the image file
+ * @return the texture, or NULL if the image could not be loaded
+ */
+SDL_Texture *texture_cache_get(texture_cache_t *cache, const char *path);
+
+/**
+ * Uploads an image that has already been decoded (e.g. on another thread)
+ * and caches it, so texture_cache_get() will not load it from disk.
+ * If the path is already cached, its texture is kept and the surface is
+ * not uploaded. A NULL surface caches the image as having failed to load.
+ *
+ * @param cache a pointer to a cache returned from texture_cache_init()
+ * @param path the path the image was loaded from
+ * @param surface the image's pixels, or NULL; not freed by the cache
+ * @return the cached texture, or NULL if it could not be created
+ */
+SDL_Texture *texture_cache_add(texture_cache_t *cache, const char *path,
+                               SDL_Surface *surface);
+
+/**
+ * Destroys the cached texture for an image, if there is one.
+ * The image will be loaded again the next time it is requested.
+ *
+ * @param cache a pointer to a cache returned from texture_cache_init()
+ * @param path the path to the image file
+ * @return whether a texture was evicted
+ */
+bool texture_cache_evict(texture_cache_t *cache, const char *path);
+
+/**
+ * Destroys every cached texture, leaving the cache empty but usable.
+ *
+ * @param cache a pointer to a cache returned from texture_cache_init()
+ */
+void texture_cache_clear(texture_cache_t *cache);
+
+/**
+ * Gets the number of images currently held by the cache.
+ *
+ * @param cache a pointer to a cache returned from texture_cache_init()
+ * @return the number of cached entries
+ */
+size_t texture_cache_size(texture_cache_t *cache);
+
+/**
+ * Gets the number of images the cache has uploaded into textures,
+ * including images uploaded again after they were evicted.
+ *
+ * @param cache a pointer to a cache returned from texture_cache_init()
+ * @return the number of textures created since the cache was created
+ */
+size_t texture_cache_uploads(texture_cache_t *cache);
+
+#endif // #ifndef __TEXTURE_CACHE_H__
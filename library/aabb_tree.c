@@ -0,0 +1,497 @@
+#include "aabb_tree.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Nodes a traversal can hold before its stack moves to the heap, enough for
+// any tree about as balanced as rotations keep it
+#define AABB_TREE_STACK_SIZE 64
+
+const size_t AABB_TREE_NULL = -1;
+const size_t AABB_TREE_INITIAL_CAPACITY = 16;
+
+typedef struct tree_node
+{
+  // A leaf's fat box, or the union of an inner node's children
+  aabb_t box;
+  void *data;
+  // The next free node, while the node is free
+  size_t parent;
+  size_t child1;
+  size_t child2;
+  // 0 for leaves, -1 for free nodes
+  int height;
+} tree_node_t;
+
+typedef struct aabb_tree
+{
+  double margin;
+  tree_node_t *nodes;
+  size_t capacity;
+  size_t root;
+  size_t free_list;
+  size_t leaf_count;
+} aabb_tree_t;
+
+/**
+ * The nodes still to visit in one query or raycast. Each traversal has its
+ * own stack, so a callback can search the same tree again. The stack
+ * starts in the traversal's local array, and only moves to the heap if the
+ * tree is too deep for it.
+ */
+typedef struct tree_stack
+{
+  size_t *nodes;
+  size_t count;
+  size_t capacity;
+  size_t local[AABB_TREE_STACK_SIZE];
+} tree_stack_t;
+
+bool aabb_tree_is_leaf(tree_node_t *node)
+{
+  return node->child1 == AABB_TREE_NULL;
+}
+
+/** Links nodes from first up to the capacity into the free list */
+void aabb_tree_free_nodes(aabb_tree_t *tree, size_t first)
+{
+  for (size_t i = first; i < tree->capacity; i++)
+  {
+    tree->nodes[i].parent = i + 1 < tree->capacity ? i + 1 : AABB_TREE_NULL;
+    tree->nodes[i].height = -1;
+  }
+  tree->free_list = first;
+}
+
+aabb_tree_t *aabb_tree_init(double margin)
+{
+  assert(margin >= 0);
+  aabb_tree_t *tree = malloc(sizeof(aabb_tree_t));
+  assert(tree != NULL);
+  tree->margin = margin;
+  tree->capacity = AABB_TREE_INITIAL_CAPACITY;
+  tree->nodes = malloc(tree->capacity * sizeof(tree_node_t));
+  assert(tree->nodes != NULL);
+  aabb_tree_free_nodes(tree, 0);
+  tree->root = AABB_TREE_NULL;
+  tree->leaf_count = 0;
+  return tree;
+}
+
+void aabb_tree_free(aabb_tree_t *tree)
+{
+  free(tree->nodes);
+  free(tree);
+}
+
+/**
+ * Takes a node from the free list, growing the node array if it is empty.
+ * Pointers to nodes are invalid after this.
+ */
+size_t aabb_tree_allocate_node(aabb_tree_t *tree)
+{
+  if (tree->free_list == AABB_TREE_NULL)
+  {
+    size_t old_capacity = tree->capacity;
+    tree->capacity *= 2;
+    tree->nodes = realloc(tree->nodes, tree->capacity * sizeof(tree_node_t));
+    assert(tree->nodes != NULL);
+    aabb_tree_free_nodes(tree, old_capacity);
+  }
+  size_t index = tree->free_list;
+  tree_node_t *node = &tree->nodes[index];
+  tree->free_list = node->parent;
+  node->parent = AABB_TREE_NULL;
+  node->child1 = AABB_TREE_NULL;
+  node->child2 = AABB_TREE_NULL;
+  node->data = NULL;
+  node->height = 0;
+  return index;
+}
+
+void aabb_tree_release_node(aabb_tree_t *tree, size_t index)
+{
+  tree->nodes[index].parent = tree->free_list;
+  tree->nodes[index].height = -1;
+  tree->free_list = index;
+}
+
+/** Recomputes an inner node's box and height from its children */
+void aabb_tree_refit(aabb_tree_t *tree, size_t index)
+{
+  tree_node_t *node = &tree->nodes[index];
+  tree_node_t *child1 = &tree->nodes[node->child1];
+  tree_node_t *child2 = &tree->nodes[node->child2];
+  node->box = aabb_union(child1->box, child2->box);
+  node->height = 1 + (child1->height > child2->height ? child1->height
+                                                      : child2->height);
+}
+
+/** Points the parent of old_child (or the root) at new_child instead */
+void aabb_tree_replace_child(aabb_tree_t *tree, size_t parent,
+                             size_t old_child, size_t new_child)
+{
+  if (parent == AABB_TREE_NULL)
+  {
+    tree->root = new_child;
+  }
+  else if (tree->nodes[parent].child1 == old_child)
+  {
+    tree->nodes[parent].child1 = new_child;
+  }
+  else
+  {
+    tree->nodes[parent].child2 = new_child;
+  }
+}
+
+/**
+ * Rotates a grandchild up to node a if one of a's subtrees is more than one
+ * level taller than the other.
+ *
+ * @return the index of the node now in a's place
+ */
+size_t aabb_tree_balance(aabb_tree_t *tree, size_t a)
+{
+  tree_node_t *nodes = tree->nodes;
+  if (aabb_tree_is_leaf(&nodes[a]) || nodes[a].height < 2)
+  {
+    return a;
+  }
+  size_t b = nodes[a].child1;
+  size_t c = nodes[a].child2;
+  int balance = nodes[c].height - nodes[b].height;
+  if (balance >= -1 && balance <= 1)
+  {
+    return a;
+  }
+
+  // Rotate the taller child up, above a
+  bool c_taller = balance > 1;
+  size_t up = c_taller ? c : b;
+  size_t grandchild1 = nodes[up].child1;
+  size_t grandchild2 = nodes[up].child2;
+  nodes[up].child1 = a;
+  nodes[up].parent = nodes[a].parent;
+  nodes[a].parent = up;
+  aabb_tree_replace_child(tree, nodes[up].parent, a, up);
+
+  // a keeps the shorter grandchild, and the taller one stays under up
+  size_t taller = nodes[grandchild1].height > nodes[grandchild2].height
+                      ? grandchild1
+                      : grandchild2;
+  size_t shorter = taller == grandchild1 ? grandchild2 : grandchild1;
+  nodes[up].child2 = taller;
+  if (c_taller)
+  {
+    nodes[a].child2 = shorter;
+  }
+  else
+  {
+    nodes[a].child1 = shorter;
+  }
+  nodes[shorter].parent = a;
+  aabb_tree_refit(tree, a);
+  aabb_tree_refit(tree, up);
+  return up;
+}
+
+/** Refits and rebalances every node from index up to the root */
+void aabb_tree_fix_upwards(aabb_tree_t *tree, size_t index)
+{
+  while (index != AABB_TREE_NULL)
+  {
+    index = aabb_tree_balance(tree, index);
+    aabb_tree_refit(tree, index);
+    index = tree->nodes[index].parent;
+  }
+}
+
+/**
+ * Finds the node to pair a new leaf with, going down the tree while a
+ * child would grow the perimeters less than pairing with the node itself.
+ */
+size_t aabb_tree_find_sibling(aabb_tree_t *tree, aabb_t box)
+{
+  tree_node_t *nodes = tree->nodes;
+  size_t index = tree->root;
+  while (!aabb_tree_is_leaf(&nodes[index]))
+  {
+    tree_node_t *node = &nodes[index];
+    double perimeter = aabb_perimeter(node->box);
+    double combined = aabb_perimeter(aabb_union(node->box, box));
+    // Pairing here makes a new parent with the combined box
+    double cost = 2 * combined;
+    // Going down grows this node's box in any case
+    double inherited = 2 * (combined - perimeter);
+
+    double child_costs[2];
+    size_t children[2] = {node->child1, node->child2};
+    for (size_t i = 0; i < 2; i++)
+    {
+      tree_node_t *child = &nodes[children[i]];
+      double grown = aabb_perimeter(aabb_union(child->box, box));
+      child_costs[i] = aabb_tree_is_leaf(child)
+                           ? grown + inherited
+                           : grown - aabb_perimeter(child->box) + inherited;
+    }
+    if (cost < child_costs[0] && cost < child_costs[1])
+    {
+      break;
+    }
+    index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+  }
+  return index;
+}
+
+void aabb_tree_insert_leaf(aabb_tree_t *tree, size_t leaf)
+{
+  if (tree->root == AABB_TREE_NULL)
+  {
+    tree->root = leaf;
+    tree->nodes[leaf].parent = AABB_TREE_NULL;
+    return;
+  }
+  size_t sibling = aabb_tree_find_sibling(tree, tree->nodes[leaf].box);
+  size_t parent = aabb_tree_allocate_node(tree);
+  tree_node_t *nodes = tree->nodes;
+  size_t old_parent = nodes[sibling].parent;
+  nodes[parent].parent = old_parent;
+  nodes[parent].child1 = sibling;
+  nodes[parent].child2 = leaf;
+  aabb_tree_replace_child(tree, old_parent, sibling, parent);
+  nodes[sibling].parent = parent;
+  nodes[leaf].parent = parent;
+  aabb_tree_fix_upwards(tree, parent);
+}
+
+void aabb_tree_remove_leaf(aabb_tree_t *tree, size_t leaf)
+{
+  if (leaf == tree->root)
+  {
+    tree->root = AABB_TREE_NULL;
+    return;
+  }
+  // The leaf's sibling takes its parent's place
+  tree_node_t *nodes = tree->nodes;
+  size_t parent = nodes[leaf].parent;
+  size_t grandparent = nodes[parent].parent;
+  size_t sibling =
+      nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+  aabb_tree_replace_child(tree, grandparent, parent, sibling);
+  nodes[sibling].parent = grandparent;
+  aabb_tree_release_node(tree, parent);
+  aabb_tree_fix_upwards(tree, grandparent);
+}
+
+aabb_t aabb_tree_fatten(aabb_tree_t *tree, aabb_t box)
+{
+  vector_t margin = {tree->margin, tree->margin};
+  return (aabb_t){.min = vec_subtract(box.min, margin),
+                  .max = vec_add(box.max, margin)};
+}
+
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t box, void *data)
+{
+  size_t leaf = aabb_tree_allocate_node(tree);
+  tree->nodes[leaf].box = aabb_tree_fatten(tree, box);
+  tree->nodes[leaf].data = data;
+  aabb_tree_insert_leaf(tree, leaf);
+  tree->leaf_count++;
+  return leaf;
+}
+
+void aabb_tree_remove(aabb_tree_t *tree, size_t proxy)
+{
+  assert(proxy < tree->capacity && tree->nodes[proxy].height == 0);
+  aabb_tree_remove_leaf(tree, proxy);
+  aabb_tree_release_node(tree, proxy);
+  tree->leaf_count--;
+}
+
+bool aabb_tree_move(aabb_tree_t *tree, size_t proxy, aabb_t box)
+{
+  assert(proxy < tree->capacity && tree->nodes[proxy].height == 0);
+  if (aabb_contains(tree->nodes[proxy].box, box))
+  {
+    return false;
+  }
+  aabb_tree_remove_leaf(tree, proxy);
+  tree->nodes[proxy].box = aabb_tree_fatten(tree, box);
+  aabb_tree_insert_leaf(tree, proxy);
+  return true;
+}
+
+aabb_t aabb_tree_get_fat_box(aabb_tree_t *tree, size_t proxy)
+{
+  assert(proxy < tree->capacity && tree->nodes[proxy].height == 0);
+  return tree->nodes[proxy].box;
+}
+
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t proxy)
+{
+  assert(proxy < tree->capacity && tree->nodes[proxy].height == 0);
+  return tree->nodes[proxy].data;
+}
+
+size_t aabb_tree_size(aabb_tree_t *tree) { return tree->leaf_count; }
+
+size_t aabb_tree_height(aabb_tree_t *tree)
+{
+  return tree->root != AABB_TREE_NULL ? tree->nodes[tree->root].height : 0;
+}
+
+/** Starts a traversal's stack with the root, in its local array */
+void tree_stack_init(tree_stack_t *stack, size_t root)
+{
+  stack->nodes = stack->local;
+  stack->capacity = AABB_TREE_STACK_SIZE;
+  stack->nodes[0] = root;
+  stack->count = 1;
+}
+
+/** Pushes a node to visit onto a traversal's stack */
+void tree_stack_push(tree_stack_t *stack, size_t index)
+{
+  if (stack->count == stack->capacity)
+  {
+    stack->capacity *= 2;
+    if (stack->nodes == stack->local)
+    {
+      stack->nodes = malloc(stack->capacity * sizeof(size_t));
+      assert(stack->nodes != NULL);
+      memcpy(stack->nodes, stack->local, sizeof(stack->local));
+    }
+    else
+    {
+      stack->nodes = realloc(stack->nodes, stack->capacity * sizeof(size_t));
+      assert(stack->nodes != NULL);
+    }
+  }
+  stack->nodes[stack->count++] = index;
+}
+
+/** Releases a traversal's stack if it moved to the heap */
+void tree_stack_free(tree_stack_t *stack)
+{
+  if (stack->nodes != stack->local)
+  {
+    free(stack->nodes);
+  }
+}
+
+void aabb_tree_query(aabb_tree_t *tree, aabb_t box,
+                     aabb_tree_query_func_t func, void *aux)
+{
+  if (tree->root == AABB_TREE_NULL)
+  {
+    return;
+  }
+  tree_stack_t stack;
+  tree_stack_init(&stack, tree->root);
+  while (stack.count > 0)
+  {
+    size_t index = stack.nodes[--stack.count];
+    tree_node_t *node = &tree->nodes[index];
+    if (!aabb_overlaps(node->box, box))
+    {
+      continue;
+    }
+    if (aabb_tree_is_leaf(node))
+    {
+      if (!func(aux, index, node->data))
+      {
+        break;
+      }
+    }
+    else
+    {
+      tree_stack_push(&stack, node->child1);
+      tree_stack_push(&stack, node->child2);
+    }
+  }
+  tree_stack_free(&stack);
+}
+
+/**
+ * Finds how far along a ray it first enters a box.
+ *
+ * @return the distance, or a negative number if the ray misses the box
+ *   within max_distance
+ */
+double aabb_tree_ray_box(aabb_t box, vector_t origin, vector_t direction,
+                         double max_distance)
+{
+  double near = 0;
+  double far = max_distance;
+  double origins[2] = {origin.x, origin.y};
+  double directions[2] = {direction.x, direction.y};
+  double mins[2] = {box.min.x, box.min.y};
+  double maxes[2] = {box.max.x, box.max.y};
+  for (size_t axis = 0; axis < 2; axis++)
+  {
+    if (directions[axis] == 0)
+    {
+      if (origins[axis] < mins[axis] || origins[axis] > maxes[axis])
+      {
+        return -1;
+      }
+      continue;
+    }
+    double enter = (mins[axis] - origins[axis]) / directions[axis];
+    double exit = (maxes[axis] - origins[axis]) / directions[axis];
+    near = fmax(near, fmin(enter, exit));
+    far = fmin(far, fmax(enter, exit));
+    if (near > far)
+    {
+      return -1;
+    }
+  }
+  return near;
+}
+
+size_t aabb_tree_raycast(aabb_tree_t *tree, vector_t origin,
+                         vector_t direction, double max_distance,
+                         aabb_tree_ray_func_t func, void *aux,
+                         double *distance)
+{
+  size_t closest = AABB_TREE_NULL;
+  double closest_distance = max_distance;
+  if (tree->root == AABB_TREE_NULL)
+  {
+    return closest;
+  }
+  tree_stack_t stack;
+  tree_stack_init(&stack, tree->root);
+  while (stack.count > 0)
+  {
+    size_t index = stack.nodes[--stack.count];
+    tree_node_t *node = &tree->nodes[index];
+    if (aabb_tree_ray_box(node->box, origin, direction, closest_distance) <
+        0)
+    {
+      continue;
+    }
+    if (aabb_tree_is_leaf(node))
+    {
+      double hit = func(aux, index, node->data);
+      if (hit >= 0 && hit <= closest_distance)
+      {
+        closest = index;
+        closest_distance = hit;
+      }
+    }
+    else
+    {
+      tree_stack_push(&stack, node->child1);
+      tree_stack_push(&stack, node->child2);
+    }
+  }
+  tree_stack_free(&stack);
+  if (distance != NULL && closest != AABB_TREE_NULL)
+  {
+    *distance = closest_distance;
+  }
+  return closest;
+}
@@ -0,0 +1,75 @@
+#include "animation.h"
+#include "list.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const size_t ANIMATION_NO_HANDLE = -1;
+const size_t ANIMATION_DEFAULT_CAPACITY = 4;
+
+typedef struct animation_frame
+{
+  char *texture_path;
+  size_t handle;
+} animation_frame_t;
+
+typedef struct animation
+{
+  list_t *frames;
+  size_t ticks_per_frame;
+} animation_t;
+
+animation_t *animation_init(size_t ticks_per_frame)
+{
+  assert(ticks_per_frame > 0);
+  animation_t *animation = malloc(sizeof(animation_t));
+  assert(animation != NULL);
+  animation->frames = list_init(ANIMATION_DEFAULT_CAPACITY, free);
+  animation->ticks_per_frame = ticks_per_frame;
+  return animation;
+}
+
+void animation_free(animation_t *animation)
+{
+  list_free(animation->frames);
+  free(animation);
+}
+
+void animation_add_frame(animation_t *animation, char *texture_path)
+{
+  animation_frame_t *frame = malloc(sizeof(animation_frame_t));
+  assert(frame != NULL);
+  *frame = (animation_frame_t){.texture_path = texture_path,
+                               .handle = ANIMATION_NO_HANDLE};
+  list_add(animation->frames, frame);
+}
+
+size_t animation_frame_count(animation_t *animation)
+{
+  return list_size(animation->frames);
+}
+
+size_t animation_frame_at(animation_t *animation, size_t tick)
+{
+  size_t frame_count = list_size(animation->frames);
+  assert(frame_count > 0);
+  return tick / animation->ticks_per_frame % frame_count;
+}
+
+char *animation_get_frame(animation_t *animation, size_t index)
+{
+  animation_frame_t *frame = list_get(animation->frames, index);
+  return frame->texture_path;
+}
+
+size_t animation_get_frame_handle(animation_t *animation, size_t index)
+{
+  animation_frame_t *frame = list_get(animation->frames, index);
+  return frame->handle;
+}
+
+void animation_set_frame_handle(animation_t *animation, size_t index,
+                                size_t handle)
+{
+  animation_frame_t *frame = list_get(animation->frames, index);
+  frame->handle = handle;
+}
@@ -0,0 +1,295 @@
+#include "asset_bundle.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+// There is no mmap() on Windows, so bundles are read into memory there
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define BUNDLE_PATH_SIZE 96
+
+const size_t ASSET_BUNDLE_MAX_PATH = BUNDLE_PATH_SIZE - 1;
+const char BUNDLE_MAGIC[8] = {'A', 'S', 'S', 'E', 'T', 'B', 'N', 'D'};
+const uint32_t BUNDLE_VERSION = 1;
+// Each asset's data starts at a multiple of this many bytes
+const uint64_t BUNDLE_ALIGNMENT = 16;
+
+typedef struct bundle_header
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t count;
+} bundle_header_t;
+
+typedef struct bundle_entry
+{
+  char path[BUNDLE_PATH_SIZE];
+  uint32_t type;
+  uint32_t width, height;
+  uint32_t reserved;
+  // Where the asset's data is, from the start of the file
+  uint64_t offset, size;
+} bundle_entry_t;
+
+typedef struct asset_bundle
+{
+  const uint8_t *data;
+  size_t size;
+  const bundle_entry_t *entries;
+  size_t count;
+} asset_bundle_t;
+
+uint64_t bundle_align(uint64_t offset)
+{
+  return (offset + BUNDLE_ALIGNMENT - 1) / BUNDLE_ALIGNMENT * BUNDLE_ALIGNMENT;
+}
+
+/** Writes zeros until the file reaches an offset */
+bool bundle_pad(FILE *file, uint64_t *written, uint64_t offset)
+{
+  const char zeros[16] = {0};
+  while (*written < offset)
+  {
+    size_t count = offset - *written < sizeof(zeros) ? offset - *written
+                                                      : sizeof(zeros);
+    if (fwrite(zeros, 1, count, file) != count)
+    {
+      return false;
+    }
+    *written += count;
+  }
+  return true;
+}
+
+bool asset_bundle_write(const char *path, bundle_asset_t *assets,
+                        size_t count)
+{
+  bundle_entry_t *entries = calloc(count > 0 ? count : 1,
+                                   sizeof(bundle_entry_t));
+  assert(entries != NULL);
+  uint64_t offset =
+      bundle_align(sizeof(bundle_header_t) + count * sizeof(bundle_entry_t));
+  for (size_t i = 0; i < count; i++)
+  {
+    bundle_asset_t *asset = &assets[i];
+    if (strlen(asset->path) > ASSET_BUNDLE_MAX_PATH)
+    {
+      fprintf(stderr, "asset_bundle: path is too long: %s\n", asset->path);
+      free(entries);
+      return false;
+    }
+    if (asset->type == ASSET_IMAGE &&
+        asset->size != (size_t)asset->width * asset->height * 4)
+    {
+      fprintf(stderr, "asset_bundle: %s is not %dx%d RGBA pixels\n",
+              asset->path, asset->width, asset->height);
+      free(entries);
+      return false;
+    }
+    strcpy(entries[i].path, asset->path);
+    entries[i].type = asset->type;
+    entries[i].width = asset->width;
+    entries[i].height = asset->height;
+    entries[i].offset = offset;
+    entries[i].size = asset->size;
+    offset = bundle_align(offset + asset->size);
+  }
+
+  FILE *file = fopen(path, "wb");
+  if (file == NULL)
+  {
+    fprintf(stderr, "asset_bundle: could not create %s\n", path);
+    free(entries);
+    return false;
+  }
+  bundle_header_t header = {.version = BUNDLE_VERSION, .count = count};
+  memcpy(header.magic, BUNDLE_MAGIC, sizeof(header.magic));
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(entries, sizeof(bundle_entry_t), count, file) == count;
+  uint64_t written = sizeof(header) + count * sizeof(bundle_entry_t);
+  for (size_t i = 0; i < count && ok; i++)
+  {
+    ok = bundle_pad(file, &written, entries[i].offset) &&
+         fwrite(assets[i].data, 1, assets[i].size, file) == assets[i].size;
+    written += assets[i].size;
+  }
+  ok = fclose(file) == 0 && ok;
+  if (!ok)
+  {
+    fprintf(stderr, "asset_bundle: could not write %s\n", path);
+  }
+  free(entries);
+  return ok;
+}
+
+void *asset_read_file(const char *path, size_t *size)
+{
+  *size = 0;
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+  {
+    return NULL;
+  }
+  long length = -1;
+  if (fseek(file, 0, SEEK_END) == 0)
+  {
+    length = ftell(file);
+  }
+  void *data = NULL;
+  if (length > 0 && fseek(file, 0, SEEK_SET) == 0)
+  {
+    data = malloc(length);
+    assert(data != NULL);
+    if (fread(data, 1, length, file) != (size_t)length)
+    {
+      free(data);
+      data = NULL;
+    }
+  }
+  fclose(file);
+  if (data != NULL)
+  {
+    *size = length;
+  }
+  return data;
+}
+
+/**
+ * Maps a whole file into memory, read-only.
+ * Returns NULL if the file does not exist or is empty.
+ */
+const uint8_t *bundle_map(const char *path, size_t *size)
+{
+#ifdef _WIN32
+  return asset_read_file(path, size);
+#else
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    return NULL;
+  }
+  struct stat info;
+  void *data = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size > 0)
+  {
+    data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  // The mapping stays valid after the file is closed
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    return NULL;
+  }
+  *size = info.st_size;
+  return data;
+#endif
+}
+
+void bundle_unmap(const uint8_t *data, size_t size)
+{
+#ifdef _WIN32
+  free((void *)data);
+#else
+  munmap((void *)data, size);
+#endif
+}
+
+/** Checks that a bundle's index describes data inside the file */
+bool bundle_validate(asset_bundle_t *bundle)
+{
+  if (bundle->size < sizeof(bundle_header_t))
+  {
+    return false;
+  }
+  const bundle_header_t *header = (const bundle_header_t *)bundle->data;
+  if (memcmp(header->magic, BUNDLE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != BUNDLE_VERSION ||
+      header->count > (bundle->size - sizeof(bundle_header_t)) /
+                          sizeof(bundle_entry_t))
+  {
+    return false;
+  }
+  bundle->entries =
+      (const bundle_entry_t *)(bundle->data + sizeof(bundle_header_t));
+  bundle->count = header->count;
+
+  for (size_t i = 0; i < bundle->count; i++)
+  {
+    const bundle_entry_t *entry = &bundle->entries[i];
+    if (memchr(entry->path, '\0', sizeof(entry->path)) == NULL ||
+        (entry->type != ASSET_IMAGE && entry->type != ASSET_FONT) ||
+        entry->offset > bundle->size ||
+        entry->size > bundle->size - entry->offset)
+    {
+      return false;
+    }
+    if (entry->type == ASSET_IMAGE &&
+        entry->size != (uint64_t)entry->width * entry->height * 4)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+asset_bundle_t *asset_bundle_open(const char *path)
+{
+  size_t size;
+  const uint8_t *data = bundle_map(path, &size);
+  if (data == NULL)
+  {
+    return NULL;
+  }
+  asset_bundle_t *bundle = malloc(sizeof(asset_bundle_t));
+  assert(bundle != NULL);
+  *bundle = (asset_bundle_t){.data = data, .size = size};
+  if (!bundle_validate(bundle))
+  {
+    fprintf(stderr, "asset_bundle: %s is not a valid bundle\n", path);
+    asset_bundle_close(bundle);
+    return NULL;
+  }
+  return bundle;
+}
+
+void asset_bundle_close(asset_bundle_t *bundle)
+{
+  bundle_unmap(bundle->data, bundle->size);
+  free(bundle);
+}
+
+size_t asset_bundle_size(asset_bundle_t *bundle) { return bundle->count; }
+
+bundle_asset_t asset_bundle_get(asset_bundle_t *bundle, size_t index)
+{
+  assert(index < bundle->count);
+  const bundle_entry_t *entry = &bundle->entries[index];
+  return (bundle_asset_t){.type = entry->type,
+                          .path = entry->path,
+                          .width = entry->width,
+                          .height = entry->height,
+                          .data = bundle->data + entry->offset,
+                          .size = entry->size};
+}
+
+bool asset_bundle_find(asset_bundle_t *bundle, const char *path,
+                       bundle_asset_t *asset)
+{
+  for (size_t i = 0; i < bundle->count; i++)
+  {
+    if (strcmp(bundle->entries[i].path, path) == 0)
+    {
+      *asset = asset_bundle_get(bundle, i);
+      return true;
+    }
+  }
+  return false;
+}
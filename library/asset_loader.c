@@ -0,0 +1,251 @@
+#include "asset_loader.h"
+#include <SDL2/SDL_image.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Decoding is mostly bound by inflating PNGs, so a few threads are enough
+#define ASSET_LOADER_MAX_THREADS 4
+
+typedef enum
+{
+  ASSET_DECODING,
+  ASSET_READY,
+  ASSET_TAKEN,
+} asset_state_t;
+
+typedef struct asset_slot
+{
+  asset_state_t state;
+  loaded_asset_t asset;
+} asset_slot_t;
+
+typedef struct asset_loader
+{
+  asset_manifest_t *manifest;
+  asset_bundle_t *bundle;
+  // Guards every field below
+  SDL_mutex *lock;
+  asset_slot_t *slots;
+  size_t total;
+  // The next asset for a thread to decode
+  size_t next;
+  // No asset before this one is ready to be taken
+  size_t first_untaken;
+  size_t taken;
+  // Set to make the threads stop before decoding another asset
+  bool cancelled;
+  SDL_Thread *threads[ASSET_LOADER_MAX_THREADS];
+  size_t thread_count;
+} asset_loader_t;
+
+/**
+ * Wraps an asset that is packed in a bundle. Images become surfaces over
+ * the bundle's pixels, so nothing is decoded or copied.
+ */
+void asset_unpack(loaded_asset_t *asset, bundle_asset_t *packed)
+{
+  if (asset->type == ASSET_FONT)
+  {
+    asset->data = (void *)packed->data;
+    asset->size = packed->size;
+    asset->borrowed = true;
+    return;
+  }
+  asset->surface = SDL_CreateRGBSurfaceWithFormatFrom(
+      (void *)packed->data, packed->width, packed->height, 32,
+      packed->width * 4, SDL_PIXELFORMAT_RGBA32);
+  if (asset->surface == NULL)
+  {
+    fprintf(stderr, "asset_loader: could not unpack %s: %s\n", asset->path,
+            SDL_GetError());
+  }
+}
+
+/** Decodes one asset, reporting it to stderr if it cannot be loaded */
+void asset_decode(asset_loader_t *loader, loaded_asset_t *asset)
+{
+  bundle_asset_t packed;
+  if (loader->bundle != NULL &&
+      asset_bundle_find(loader->bundle, asset->path, &packed) &&
+      packed.type == asset->type)
+  {
+    asset_unpack(asset, &packed);
+    return;
+  }
+
+  if (asset->type == ASSET_FONT)
+  {
+    asset->data = asset_read_file(asset->path, &asset->size);
+    if (asset->data == NULL)
+    {
+      fprintf(stderr, "asset_loader: could not read %s\n", asset->path);
+    }
+    return;
+  }
+
+  SDL_Surface *image = IMG_Load(asset->path);
+  if (image == NULL)
+  {
+    fprintf(stderr, "asset_loader: could not load %s: %s\n", asset->path,
+            SDL_GetError());
+    return;
+  }
+  // Converting here leaves the renderer's thread a plain copy to upload
+  asset->surface = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+  if (asset->surface == NULL)
+  {
+    asset->surface = image;
+  }
+  else
+  {
+    SDL_FreeSurface(image);
+  }
+}
+
+int asset_loader_run(void *data)
+{
+  asset_loader_t *loader = data;
+  SDL_LockMutex(loader->lock);
+  while (!loader->cancelled && loader->next < loader->total)
+  {
+    asset_slot_t *slot = &loader->slots[loader->next++];
+    loaded_asset_t asset = slot->asset;
+    SDL_UnlockMutex(loader->lock);
+    asset_decode(loader, &asset);
+    SDL_LockMutex(loader->lock);
+    slot->asset = asset;
+    slot->state = ASSET_READY;
+  }
+  SDL_UnlockMutex(loader->lock);
+  return 0;
+}
+
+asset_loader_t *asset_loader_start(asset_manifest_t *manifest,
+                                   asset_bundle_t *bundle)
+{
+  asset_loader_t *loader = malloc(sizeof(asset_loader_t));
+  assert(loader != NULL);
+  loader->manifest = manifest;
+  loader->bundle = bundle;
+  loader->lock = SDL_CreateMutex();
+  assert(loader->lock != NULL);
+  loader->total = asset_manifest_size(manifest);
+  loader->slots = malloc(sizeof(asset_slot_t) * loader->total);
+  assert(loader->total == 0 || loader->slots != NULL);
+  for (size_t i = 0; i < loader->total; i++)
+  {
+    loader->slots[i] = (asset_slot_t){
+        .state = ASSET_DECODING,
+        .asset = {.type = asset_manifest_get_type(manifest, i),
+                  .path = asset_manifest_get_path(manifest, i),
+                  .point_size = asset_manifest_get_point_size(manifest, i)}};
+  }
+  loader->next = 0;
+  loader->first_untaken = 0;
+  loader->taken = 0;
+  loader->cancelled = false;
+
+  size_t thread_count = SDL_GetCPUCount();
+  if (thread_count > ASSET_LOADER_MAX_THREADS)
+  {
+    thread_count = ASSET_LOADER_MAX_THREADS;
+  }
+  if (thread_count > loader->total)
+  {
+    thread_count = loader->total;
+  }
+  loader->thread_count = 0;
+  for (size_t i = 0; i < thread_count; i++)
+  {
+    SDL_Thread *thread =
+        SDL_CreateThread(asset_loader_run, "asset_loader", loader);
+    if (thread != NULL)
+    {
+      loader->threads[loader->thread_count++] = thread;
+    }
+  }
+  if (loader->thread_count == 0)
+  {
+    // Without threads, everything is decoded now
+    asset_loader_run(loader);
+  }
+  return loader;
+}
+
+void asset_loader_free(asset_loader_t *loader)
+{
+  SDL_LockMutex(loader->lock);
+  loader->cancelled = true;
+  SDL_UnlockMutex(loader->lock);
+  for (size_t i = 0; i < loader->thread_count; i++)
+  {
+    SDL_WaitThread(loader->threads[i], NULL);
+  }
+
+  for (size_t i = 0; i < loader->total; i++)
+  {
+    asset_slot_t *slot = &loader->slots[i];
+    if (slot->state == ASSET_READY)
+    {
+      if (slot->asset.surface != NULL)
+      {
+        SDL_FreeSurface(slot->asset.surface);
+      }
+      if (!slot->asset.borrowed)
+      {
+        free(slot->asset.data);
+      }
+    }
+  }
+  SDL_DestroyMutex(loader->lock);
+  free(loader->slots);
+  free(loader);
+}
+
+bool asset_loader_poll(asset_loader_t *loader, loaded_asset_t *asset)
+{
+  bool found = false;
+  SDL_LockMutex(loader->lock);
+  for (size_t i = loader->first_untaken; i < loader->total && !found; i++)
+  {
+    asset_slot_t *slot = &loader->slots[i];
+    if (slot->state == ASSET_READY)
+    {
+      *asset = slot->asset;
+      slot->state = ASSET_TAKEN;
+      loader->taken++;
+      found = true;
+    }
+  }
+  while (loader->first_untaken < loader->total &&
+         loader->slots[loader->first_untaken].state == ASSET_TAKEN)
+  {
+    loader->first_untaken++;
+  }
+  SDL_UnlockMutex(loader->lock);
+  return found;
+}
+
+bool asset_loader_pending(asset_loader_t *loader, const char *path)
+{
+  size_t index = asset_manifest_find(loader->manifest, path);
+  if (index == ASSET_MANIFEST_NOT_FOUND)
+  {
+    return false;
+  }
+  SDL_LockMutex(loader->lock);
+  bool pending = loader->slots[index].state != ASSET_TAKEN;
+  SDL_UnlockMutex(loader->lock);
+  return pending;
+}
+
+size_t asset_loader_taken(asset_loader_t *loader)
+{
+  SDL_LockMutex(loader->lock);
+  size_t taken = loader->taken;
+  SDL_UnlockMutex(loader->lock);
+  return taken;
+}
+
+size_t asset_loader_total(asset_loader_t *loader) { return loader->total; }
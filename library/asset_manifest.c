@@ -0,0 +1,206 @@
+#include "asset_manifest.h"
+#include "list.h"
+#include <assert.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Longer lines are reported and skipped. The sscanf() widths below are
+// one less than this, leaving room for the terminating '\0'.
+#define ASSET_MANIFEST_MAX_LINE 512
+
+const size_t ASSET_MANIFEST_NOT_FOUND = -1;
+const size_t ASSET_MANIFEST_DEFAULT_CAPACITY = 16;
+
+typedef struct asset
+{
+  asset_type_t type;
+  char *path;
+  int point_size;
+} asset_t;
+
+typedef struct asset_manifest
+{
+  list_t *assets;
+} asset_manifest_t;
+
+void asset_free(asset_t *asset)
+{
+  free(asset->path);
+  free(asset);
+}
+
+void asset_manifest_add(asset_manifest_t *manifest, asset_type_t type,
+                        const char *path, int point_size)
+{
+  asset_t *asset = malloc(sizeof(asset_t));
+  assert(asset != NULL);
+  asset->type = type;
+  asset->path = malloc(strlen(path) + 1);
+  assert(asset->path != NULL);
+  strcpy(asset->path, path);
+  asset->point_size = point_size;
+  list_add(manifest->assets, asset);
+}
+
+/**
+ * Adds the asset on one line of a manifest, if it has one.
+ * Returns false if the line is neither an asset, a comment, nor blank.
+ */
+bool asset_manifest_parse_line(asset_manifest_t *manifest, const char *line)
+{
+  while (isspace((unsigned char)*line))
+  {
+    line++;
+  }
+  if (*line == '\0' || *line == '#')
+  {
+    return true;
+  }
+
+  char type[16], path[ASSET_MANIFEST_MAX_LINE];
+  int length = 0;
+  if (sscanf(line, "%15s %511s%n", type, path, &length) != 2)
+  {
+    return false;
+  }
+  const char *rest = line + length;
+  asset_type_t asset_type;
+  int point_size = 0;
+  if (strcmp(type, "image") == 0)
+  {
+    asset_type = ASSET_IMAGE;
+  }
+  else if (strcmp(type, "font") == 0 &&
+           sscanf(rest, "%d%n", &point_size, &length) == 1 && point_size > 0)
+  {
+    asset_type = ASSET_FONT;
+    rest += length;
+  }
+  else
+  {
+    return false;
+  }
+  // Nothing may follow the asset
+  while (isspace((unsigned char)*rest))
+  {
+    rest++;
+  }
+  if (*rest != '\0')
+  {
+    return false;
+  }
+  asset_manifest_add(manifest, asset_type, path, point_size);
+  return true;
+}
+
+asset_manifest_t *asset_manifest_parse(const char *text)
+{
+  asset_manifest_t *manifest = malloc(sizeof(asset_manifest_t));
+  assert(manifest != NULL);
+  manifest->assets =
+      list_init(ASSET_MANIFEST_DEFAULT_CAPACITY, (free_func_t)asset_free);
+
+  size_t line_number = 1;
+  for (const char *start = text; *start != '\0'; line_number++)
+  {
+    size_t length = strcspn(start, "\r\n");
+    char line[ASSET_MANIFEST_MAX_LINE];
+    if (length >= sizeof(line))
+    {
+      fprintf(stderr, "asset_manifest: line %zu is too long\n", line_number);
+    }
+    else
+    {
+      memcpy(line, start, length);
+      line[length] = '\0';
+      if (!asset_manifest_parse_line(manifest, line))
+      {
+        fprintf(stderr, "asset_manifest: cannot parse line %zu: %s\n",
+                line_number, line);
+      }
+    }
+
+    start += length;
+    // Accept "\n", "\r\n", and a missing newline at the end
+    if (*start == '\r')
+    {
+      start++;
+    }
+    if (*start == '\n')
+    {
+      start++;
+    }
+  }
+  return manifest;
+}
+
+asset_manifest_t *asset_manifest_load(const char *path)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+  {
+    return NULL;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  if (size < 0)
+  {
+    fclose(file);
+    return NULL;
+  }
+  char *text = malloc(size + 1);
+  assert(text != NULL);
+  size_t read = fread(text, 1, size, file);
+  fclose(file);
+  text[read] = '\0';
+
+  asset_manifest_t *manifest = asset_manifest_parse(text);
+  free(text);
+  return manifest;
+}
+
+void asset_manifest_free(asset_manifest_t *manifest)
+{
+  list_free(manifest->assets);
+  free(manifest);
+}
+
+size_t asset_manifest_size(asset_manifest_t *manifest)
+{
+  return list_size(manifest->assets);
+}
+
+asset_type_t asset_manifest_get_type(asset_manifest_t *manifest, size_t index)
+{
+  asset_t *asset = list_get(manifest->assets, index);
+  return asset->type;
+}
+
+const char *asset_manifest_get_path(asset_manifest_t *manifest, size_t index)
+{
+  asset_t *asset = list_get(manifest->assets, index);
+  return asset->path;
+}
+
+int asset_manifest_get_point_size(asset_manifest_t *manifest, size_t index)
+{
+  asset_t *asset = list_get(manifest->assets, index);
+  return asset->point_size;
+}
+
+size_t asset_manifest_find(asset_manifest_t *manifest, const char *path)
+{
+  size_t count = list_size(manifest->assets);
+  for (size_t i = 0; i < count; i++)
+  {
+    asset_t *asset = list_get(manifest->assets, i);
+    if (strcmp(asset->path, path) == 0)
+    {
+      return i;
+    }
+  }
+  return ASSET_MANIFEST_NOT_FOUND;
+}
@@ -1,4 +1,5 @@
 #include "body.h"
+#include "sprite.h"
 
 const double BODY_DEFAULT_ANGULAR_VELOCITY = 0.0;
 const double BODY_DEFAULT_ANGULAR_POSITION = 0.0;
@@ -7,10 +8,24 @@ const double BODY_DEFAULT_VELOCITY_X = 0.0;
 const double BODY_DEFAULT_VELOCITY_Y = 0.0;
 const bool BODY_IS_MOVABLE = true;
 
+/**
+ * The id given to the next body created.
+ * Ids are unique across all bodies, so a renderer cache keyed by a set of
+ * bodies cannot mistake new bodies for freed ones at the same addresses.
+ */
+size_t next_body_id = 1;
+
 typedef struct body_appearance
 {
-    list_t *shape;
+    // Shared with other bodies of the same shape; placed in the scene by the
+    // body's position and rotation
+    shape_t *shape;
     rgb_color_t color;
+    // The shape's vertices placed in the scene, filled in when a view is
+    // asked for and kept until the body moves, turns or changes shape
+    vector_t *placed;
+    size_t placed_capacity;
+    bool placed_current;
 } body_appearance_t;
 
 typedef struct body_physical_properties
@@ -26,6 +41,10 @@ typedef struct body_kinematic_variables
     vector_t position;
     double angular_velocity;
     double angular_position;
+    // Kept with the angle, so placing vertices needs no trigonometry
+    double cos_angle, sin_angle;
+    // The shape's bounding box in the scene, kept with the position and angle
+    aabb_t bounds;
     vector_t net_force;
     vector_t impulse;
 } body_kinematic_variables_t;
@@ -39,6 +58,12 @@ typedef struct body_aux_properties
     texture_path_func_t texture_path_func;
     void *texture_path_aux;
     free_func_t texture_path_freer;
+    animation_t *animation;
+    size_t id;
+    bool static_background;
+    int render_layer;
+    // 0 unless body_set_circle_lod() was called
+    double circle_radius;
 } body_aux_properties_t;
 
 typedef struct body
@@ -49,7 +74,7 @@ typedef struct body
     body_aux_properties_t aux;
 } body_t;
 
-body_appearance_t body_appearance_init(list_t *shape, rgb_color_t color)
+body_appearance_t body_appearance_init(shape_t *shape, rgb_color_t color)
 {
     body_appearance_t appearance = {.shape = shape, .color = color};
     return appearance;
@@ -86,6 +111,8 @@ body_kinematic_variables_init(vector_t velocity, vector_t position,
         .position = position,
         .angular_velocity = angular_velocity,
         .angular_position = angular_position,
+        .cos_angle = cos(angular_position),
+        .sin_angle = sin(angular_position),
         .net_force = net_force,
         .impulse = impulse};
 
@@ -94,7 +121,58 @@ body_kinematic_variables_init(vector_t velocity, vector_t position,
 
 body_t *body_init(list_t *shape, double mass, rgb_color_t color)
 {
-    vector_t position = polygon_centroid(shape);
+    vector_t centroid;
+    shape_t *interned = shape_intern_polygon(shape, &centroid);
+    body_t *body =
+        body_init_with_shape(interned, centroid, mass, color, NULL, NULL);
+    shape_release(interned);
+    return body;
+}
+
+/** Places a vertex of the body's shape in the scene */
+vector_t body_place_vertex(body_t *body, vector_t local)
+{
+    body_kinematic_variables_t *kinematic = &body->kinematic_variables;
+    double c = kinematic->cos_angle, s = kinematic->sin_angle;
+    return (vector_t){.x = kinematic->position.x + c * local.x - s * local.y,
+                      .y = kinematic->position.y + s * local.x + c * local.y};
+}
+
+/** Recomputes the body's cached bounding box from its placed vertices */
+void body_update_aabb(body_t *body)
+{
+    size_t count = shape_vertex_count(body->appearance.shape);
+    vector_t *local = shape_get_vertices(body->appearance.shape);
+    aabb_t box = {.min = {INFINITY, INFINITY}, .max = {-INFINITY, -INFINITY}};
+    for (size_t idx = 0; idx < count; idx++)
+    {
+        vector_t vertex = body_place_vertex(body, local[idx]);
+        if (vertex.x < box.min.x)
+        {
+            box.min.x = vertex.x;
+        }
+        if (vertex.x > box.max.x)
+        {
+            box.max.x = vertex.x;
+        }
+        if (vertex.y < box.min.y)
+        {
+            box.min.y = vertex.y;
+        }
+        if (vertex.y > box.max.y)
+        {
+            box.max.y = vertex.y;
+        }
+    }
+    body->kinematic_variables.bounds = box;
+    body->appearance.placed_current = false;
+}
+
+body_t *body_init_with_shape(shape_t *shape, vector_t centroid, double mass,
+                             rgb_color_t color, void *info,
+                             free_func_t info_freer)
+{
+    vector_t position = centroid;
     body_t *body = malloc(sizeof(body_t));
     body_kinematic_variables_t kinematic = body_kinematic_variables_init(
         (vector_t){.x = BODY_DEFAULT_VELOCITY_X, .y = BODY_DEFAULT_VELOCITY_Y},
@@ -104,13 +182,16 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color)
     body_physical_properties_t physical = body_physical_properties_init(
         mass, BODY_DEFAULT_BOUNCINESS, BODY_IS_MOVABLE);
     rgb_color_t color_pointer = rgb_init(color.r, color.g, color.b);
-    body_appearance_t appearance = body_appearance_init(shape, color_pointer);
+    body_appearance_t appearance =
+        body_appearance_init(shape_retain(shape), color_pointer);
     body_aux_properties_t aux =
-        body_aux_properties_init(NULL, NULL, false, LOCKED, NULL);
+        body_aux_properties_init(info, info_freer, false, LOCKED, NULL);
     *body = (body_t){.kinematic_variables = kinematic,
                      .physical_properties = physical,
                      .appearance = appearance,
                      .aux = aux};
+    body->aux.id = next_body_id++;
+    body_update_aabb(body);
     return body;
 };
 
@@ -127,7 +208,8 @@ void *body_get_info(body_t *body) { return body->aux.info; }
 
 void body_free(body_t *body)
 {
-    list_free(body->appearance.shape);
+    shape_release(body->appearance.shape);
+    free(body->appearance.placed);
     if (body->aux.info_freer != NULL)
     {
         body->aux.info_freer(body->aux.info);
@@ -160,19 +242,88 @@ camera_mode_t body_get_camera_mode(body_t *body)
     return body->aux.camera_mode;
 }
 
+size_t body_get_id(body_t *body) { return body->aux.id; }
+
+void body_set_static_background(body_t *body, bool static_background)
+{
+    body->aux.static_background = static_background;
+}
+
+bool body_is_static_background(body_t *body)
+{
+    return body->aux.static_background;
+}
+
+void body_set_render_layer(body_t *body, int layer)
+{
+    assert(INT16_MIN <= layer && layer <= INT16_MAX);
+    body->aux.render_layer = layer;
+}
+
+int body_get_render_layer(body_t *body) { return body->aux.render_layer; }
+
+void body_set_circle_lod(body_t *body, double radius)
+{
+    assert(radius > 0);
+    shape_t *proxy = shape_intern_circle(radius, SPRITE_CIRCLE_PROXY_POINTS);
+    shape_release(body->appearance.shape);
+    body->appearance.shape = proxy;
+    body->aux.circle_radius = radius;
+    body_update_aabb(body);
+}
+
+double body_get_circle_radius(body_t *body) { return body->aux.circle_radius; }
+
 list_t *body_get_shape(body_t *body)
 {
-    list_t *shape = body->appearance.shape;
-    list_t *new_shape = list_init(list_size(shape), (free_func_t)vec_free);
-    vector_t *current_vector;
-    for (size_t idx = 0; idx < list_size(shape); idx++)
+    size_t count = shape_vertex_count(body->appearance.shape);
+    vector_t *local = shape_get_vertices(body->appearance.shape);
+    list_t *new_shape = list_init(count, (free_func_t)vec_free);
+    for (size_t idx = 0; idx < count; idx++)
     {
-        current_vector = (vector_t *)list_get(shape, idx);
-        list_add(new_shape, vec_malloc(current_vector->x, current_vector->y));
+        vector_t vertex = body_place_vertex(body, local[idx]);
+        list_add(new_shape, vec_malloc(vertex.x, vertex.y));
     }
     return new_shape;
 }
 
+polygon_view_t body_get_shape_view(body_t *body)
+{
+    body_appearance_t *appearance = &body->appearance;
+    size_t count = shape_vertex_count(appearance->shape);
+    if (!appearance->placed_current)
+    {
+        if (appearance->placed_capacity < count)
+        {
+            appearance->placed =
+                realloc(appearance->placed, count * sizeof(vector_t));
+            assert(appearance->placed != NULL);
+            appearance->placed_capacity = count;
+        }
+        vector_t *local = shape_get_vertices(appearance->shape);
+        for (size_t idx = 0; idx < count; idx++)
+        {
+            appearance->placed[idx] = body_place_vertex(body, local[idx]);
+        }
+        appearance->placed_current = true;
+    }
+    return (polygon_view_t){.vertices = appearance->placed, .count = count};
+}
+
+shape_t *body_get_local_shape(body_t *body) { return body->appearance.shape; }
+
+size_t body_vertex_count(body_t *body)
+{
+    return shape_vertex_count(body->appearance.shape);
+}
+
+vector_t body_get_vertex(body_t *body, size_t index)
+{
+    assert(index < shape_vertex_count(body->appearance.shape));
+    return body_place_vertex(body,
+                             shape_get_vertices(body->appearance.shape)[index]);
+}
+
 char *body_get_texture_path(body_t *body)
 {
     if (body->aux.texture_path_func)
@@ -198,38 +349,25 @@ void body_set_static_texture_path(body_t *body, char *path)
                                path, NULL);
 }
 
-SDL_Rect *body_get_bounding_rect(body_t *body)
+void body_set_animation(body_t *body, animation_t *animation)
 {
-    list_t *shape = body->appearance.shape;
-    double min_x = INFINITY;
-    double max_x = -INFINITY;
-    double min_y = INFINITY;
-    double max_y = -INFINITY;
-    for (size_t idx = 0; idx < list_size(shape); idx++)
-    {
-        vector_t *vertex = list_get(shape, idx);
-        if (vertex->x < min_x)
-        {
-            min_x = vertex->x;
-        }
-        if (vertex->x > max_x)
-        {
-            max_x = vertex->x;
-        }
-        if (vertex->y < min_y)
-        {
-            min_y = vertex->y;
-        }
-        if (vertex->y > max_y)
-        {
-            max_y = vertex->y;
-        }
-    }
+    body->aux.animation = animation;
+}
+
+animation_t *body_get_animation(body_t *body) { return body->aux.animation; }
+
+aabb_t body_get_aabb(body_t *body)
+{
+    return body->kinematic_variables.bounds;
+}
 
-    SDL_Rect *rect = malloc(sizeof(SDL_Rect));
-    *rect = (SDL_Rect){
-        .x = min_x, .y = min_y, .w = max_x - min_x, .h = max_y - min_y};
-    return rect;
+SDL_Rect body_get_bounding_rect(body_t *body)
+{
+    aabb_t box = body_get_aabb(body);
+    return (SDL_Rect){.x = box.min.x,
+                      .y = box.min.y,
+                      .w = box.max.x - box.min.x,
+                      .h = box.max.y - box.min.y};
 }
 
 bool body_has_impulse(body_t *body)
@@ -259,10 +397,13 @@ double body_get_mass(body_t *body) { return body->physical_properties.mass; }
 
 void body_set_centroid(body_t *body, vector_t x)
 {
-    vector_t x0 = body->kinematic_variables.position;
-    vector_t dx = vec_subtract(x, x0);
-    polygon_translate(body->appearance.shape, dx);
-    body->kinematic_variables.position = x;
+    body_kinematic_variables_t *kinematic = &body->kinematic_variables;
+    // Moving the body moves its bounding box by as much
+    vector_t delta = vec_subtract(x, kinematic->position);
+    kinematic->bounds.min = vec_add(kinematic->bounds.min, delta);
+    kinematic->bounds.max = vec_add(kinematic->bounds.max, delta);
+    kinematic->position = x;
+    body->appearance.placed_current = false;
 }
 
 void body_set_color(body_t *body, rgb_color_t color)
@@ -282,11 +423,14 @@ void body_set_angular_velocity(body_t *body, double av)
 
 void body_set_rotation(body_t *body, double angle)
 {
-    double a0 = body->kinematic_variables.angular_position;
-    double da = angle - a0;
-    vector_t position = body->kinematic_variables.position;
-    polygon_rotate(body->appearance.shape, da, position);
-    body->kinematic_variables.angular_position = angle;
+    body_kinematic_variables_t *kinematic = &body->kinematic_variables;
+    if (angle != kinematic->angular_position)
+    {
+        kinematic->angular_position = angle;
+        kinematic->cos_angle = cos(angle);
+        kinematic->sin_angle = sin(angle);
+        body_update_aabb(body);
+    }
 }
 
 void body_add_force(body_t *body, vector_t force)
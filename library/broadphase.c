@@ -0,0 +1,432 @@
+#include "broadphase.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const double BROADPHASE_DEFAULT_CELL_SIZE = 128;
+const size_t BROADPHASE_INITIAL_CAPACITY = 64;
+// Boxes covering more cells than this are tested against every box instead
+const size_t BROADPHASE_MAX_BOX_CELLS = 256;
+// Marks the end of a bucket's chain of cell entries
+const size_t BROADPHASE_NO_ENTRY = -1;
+
+/** One grid cell covered by one box, chained into the cell's hash bucket */
+typedef struct cell_entry
+{
+  int64_t x;
+  int64_t y;
+  size_t box;
+  size_t next;
+} cell_entry_t;
+
+/** A box's place in the sweep-and-prune order */
+typedef struct sweep_entry
+{
+  double min_x;
+  size_t box;
+} sweep_entry_t;
+
+typedef struct broadphase
+{
+  broadphase_mode_t mode;
+  double cell_size;
+  aabb_t *boxes;
+  size_t box_count;
+  size_t box_capacity;
+  // Boxes too large or far out to hash into the grid
+  size_t *large;
+  size_t large_count;
+  size_t large_capacity;
+  cell_entry_t *entries;
+  size_t entry_count;
+  size_t entry_capacity;
+  // Head entry of each chain; the count is a power of 2
+  size_t *buckets;
+  size_t bucket_count;
+  size_t bucket_capacity;
+  broadphase_pair_t *pairs;
+  size_t pair_count;
+  size_t pair_capacity;
+  // Every box sorted by min_x as of the last sweep, kept between clears
+  sweep_entry_t *sweep;
+  size_t sweep_count;
+  size_t sweep_capacity;
+} broadphase_t;
+
+bool aabb_overlaps(aabb_t a, aabb_t b)
+{
+  return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y &&
+         b.min.y <= a.max.y;
+}
+
+bool aabb_contains(aabb_t outer, aabb_t inner)
+{
+  return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+         inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+aabb_t aabb_union(aabb_t a, aabb_t b)
+{
+  return (aabb_t){.min = {fmin(a.min.x, b.min.x), fmin(a.min.y, b.min.y)},
+                  .max = {fmax(a.max.x, b.max.x), fmax(a.max.y, b.max.y)}};
+}
+
+double aabb_perimeter(aabb_t box)
+{
+  return 2 * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
+
+/** Makes room for one more element in a growable array */
+void *broadphase_reserve(void *array, size_t count, size_t *capacity,
+                         size_t element_size)
+{
+  if (count < *capacity)
+  {
+    return array;
+  }
+  *capacity = *capacity > 0 ? 2 * *capacity : BROADPHASE_INITIAL_CAPACITY;
+  array = realloc(array, *capacity * element_size);
+  assert(array != NULL);
+  return array;
+}
+
+broadphase_t *broadphase_init(double cell_size)
+{
+  assert(cell_size >= 0);
+  broadphase_t *broadphase = calloc(1, sizeof(broadphase_t));
+  assert(broadphase != NULL);
+  broadphase->mode = BROADPHASE_GRID;
+  broadphase->cell_size =
+      cell_size > 0 ? cell_size : BROADPHASE_DEFAULT_CELL_SIZE;
+  return broadphase;
+}
+
+void broadphase_set_mode(broadphase_t *broadphase, broadphase_mode_t mode)
+{
+  broadphase->mode = mode;
+}
+
+broadphase_mode_t broadphase_get_mode(broadphase_t *broadphase)
+{
+  return broadphase->mode;
+}
+
+void broadphase_free(broadphase_t *broadphase)
+{
+  free(broadphase->boxes);
+  free(broadphase->large);
+  free(broadphase->entries);
+  free(broadphase->buckets);
+  free(broadphase->pairs);
+  free(broadphase->sweep);
+  free(broadphase);
+}
+
+void broadphase_clear(broadphase_t *broadphase)
+{
+  broadphase->box_count = 0;
+  broadphase->large_count = 0;
+  broadphase->entry_count = 0;
+  broadphase->pair_count = 0;
+}
+
+size_t broadphase_add(broadphase_t *broadphase, aabb_t box)
+{
+  broadphase->boxes =
+      broadphase_reserve(broadphase->boxes, broadphase->box_count,
+                         &broadphase->box_capacity, sizeof(aabb_t));
+  broadphase->boxes[broadphase->box_count] = box;
+  return broadphase->box_count++;
+}
+
+size_t broadphase_size(broadphase_t *broadphase)
+{
+  return broadphase->box_count;
+}
+
+/** Gets the index of the grid cell column or row containing a coordinate */
+int64_t broadphase_cell(broadphase_t *broadphase, double coordinate)
+{
+  return (int64_t)floor(coordinate / broadphase->cell_size);
+}
+
+size_t broadphase_bucket(broadphase_t *broadphase, int64_t x, int64_t y)
+{
+  uint64_t hash = (uint64_t)x * 0x9E3779B97F4A7C15u ^
+                  (uint64_t)y * 0xC2B2AE3D27D4EB4Fu;
+  return (hash ^ hash >> 32) & (broadphase->bucket_count - 1);
+}
+
+void broadphase_add_pair(broadphase_t *broadphase, size_t a, size_t b)
+{
+  broadphase->pairs =
+      broadphase_reserve(broadphase->pairs, broadphase->pair_count,
+                         &broadphase->pair_capacity,
+                         sizeof(broadphase_pair_t));
+  broadphase->pairs[broadphase->pair_count++] = a < b
+      ? (broadphase_pair_t){.first = a, .second = b}
+      : (broadphase_pair_t){.first = b, .second = a};
+}
+
+/**
+ * Hashes every box into the cells it covers, setting aside boxes that
+ * cover too many cells (or have no finite bounds) as large.
+ */
+void broadphase_fill_grid(broadphase_t *broadphase)
+{
+  // Cells within this distance of the origin fit in an int64_t
+  double limit = 1e15 * broadphase->cell_size;
+  for (size_t i = 0; i < broadphase->box_count; i++)
+  {
+    aabb_t box = broadphase->boxes[i];
+    bool finite = fabs(box.min.x) < limit && fabs(box.min.y) < limit &&
+                  fabs(box.max.x) < limit && fabs(box.max.y) < limit;
+    int64_t min_x = finite ? broadphase_cell(broadphase, box.min.x) : 0;
+    int64_t min_y = finite ? broadphase_cell(broadphase, box.min.y) : 0;
+    int64_t max_x = finite ? broadphase_cell(broadphase, box.max.x) : 0;
+    int64_t max_y = finite ? broadphase_cell(broadphase, box.max.y) : 0;
+    if (!finite || (double)(max_x - min_x + 1) * (max_y - min_y + 1) >
+                       BROADPHASE_MAX_BOX_CELLS)
+    {
+      broadphase->large =
+          broadphase_reserve(broadphase->large, broadphase->large_count,
+                             &broadphase->large_capacity, sizeof(size_t));
+      broadphase->large[broadphase->large_count++] = i;
+      continue;
+    }
+    for (int64_t x = min_x; x <= max_x; x++)
+    {
+      for (int64_t y = min_y; y <= max_y; y++)
+      {
+        broadphase->entries = broadphase_reserve(
+            broadphase->entries, broadphase->entry_count,
+            &broadphase->entry_capacity, sizeof(cell_entry_t));
+        broadphase->entries[broadphase->entry_count++] =
+            (cell_entry_t){.x = x, .y = y, .box = i};
+      }
+    }
+  }
+
+  size_t bucket_count = 1;
+  while (bucket_count < 2 * broadphase->entry_count)
+  {
+    bucket_count *= 2;
+  }
+  if (bucket_count > broadphase->bucket_capacity)
+  {
+    free(broadphase->buckets);
+    broadphase->buckets = malloc(bucket_count * sizeof(size_t));
+    assert(broadphase->buckets != NULL);
+    broadphase->bucket_capacity = bucket_count;
+  }
+  broadphase->bucket_count = bucket_count;
+  for (size_t i = 0; i < bucket_count; i++)
+  {
+    broadphase->buckets[i] = BROADPHASE_NO_ENTRY;
+  }
+  for (size_t i = 0; i < broadphase->entry_count; i++)
+  {
+    cell_entry_t *entry = &broadphase->entries[i];
+    size_t bucket = broadphase_bucket(broadphase, entry->x, entry->y);
+    entry->next = broadphase->buckets[bucket];
+    broadphase->buckets[bucket] = i;
+  }
+}
+
+/**
+ * Checks whether a cell is where two overlapping boxes' pair is reported:
+ * the cell holding the smallest corner of their intersection. Both boxes
+ * cover that cell, and no other cell they share holds that corner.
+ */
+bool broadphase_owns_pair(broadphase_t *broadphase, cell_entry_t *cell,
+                          aabb_t a, aabb_t b)
+{
+  double x = fmax(a.min.x, b.min.x);
+  double y = fmax(a.min.y, b.min.y);
+  return broadphase_cell(broadphase, x) == cell->x &&
+         broadphase_cell(broadphase, y) == cell->y;
+}
+
+int broadphase_index_cmp(const void *a, const void *b)
+{
+  size_t index_a = *(const size_t *)a;
+  size_t index_b = *(const size_t *)b;
+  return index_a < index_b ? -1 : index_a > index_b;
+}
+
+int broadphase_pair_cmp(const void *a, const void *b)
+{
+  const broadphase_pair_t *pair_a = a;
+  const broadphase_pair_t *pair_b = b;
+  if (pair_a->first != pair_b->first)
+  {
+    return pair_a->first < pair_b->first ? -1 : 1;
+  }
+  if (pair_a->second != pair_b->second)
+  {
+    return pair_a->second < pair_b->second ? -1 : 1;
+  }
+  return 0;
+}
+
+void broadphase_find_grid_pairs(broadphase_t *broadphase)
+{
+  broadphase->large_count = 0;
+  broadphase->entry_count = 0;
+  broadphase_fill_grid(broadphase);
+  aabb_t *boxes = broadphase->boxes;
+
+  // Boxes in the same cell always share a bucket
+  for (size_t i = 0; i < broadphase->entry_count; i++)
+  {
+    cell_entry_t *entry = &broadphase->entries[i];
+    for (size_t j = entry->next; j != BROADPHASE_NO_ENTRY;
+         j = broadphase->entries[j].next)
+    {
+      cell_entry_t *other = &broadphase->entries[j];
+      if (other->x != entry->x || other->y != entry->y)
+      {
+        continue;
+      }
+      aabb_t a = boxes[entry->box];
+      aabb_t b = boxes[other->box];
+      if (aabb_overlaps(a, b) && broadphase_owns_pair(broadphase, entry, a, b))
+      {
+        broadphase_add_pair(broadphase, entry->box, other->box);
+      }
+    }
+  }
+
+  // Large boxes are missing from the grid, so they check every other box
+  for (size_t i = 0; i < broadphase->large_count; i++)
+  {
+    size_t large = broadphase->large[i];
+    for (size_t other = 0; other < broadphase->box_count; other++)
+    {
+      // Pairs of large boxes are checked from the earlier one only
+      bool other_is_large =
+          other < large && i > 0 &&
+          bsearch(&other, broadphase->large, i, sizeof(size_t),
+                  broadphase_index_cmp) != NULL;
+      if (!other_is_large && other != large &&
+          aabb_overlaps(boxes[large], boxes[other]))
+      {
+        broadphase_add_pair(broadphase, large, other);
+      }
+    }
+  }
+
+}
+
+int broadphase_sweep_cmp(const void *a, const void *b)
+{
+  const sweep_entry_t *entry_a = a;
+  const sweep_entry_t *entry_b = b;
+  return entry_a->min_x < entry_b->min_x ? -1 : entry_a->min_x > entry_b->min_x;
+}
+
+/**
+ * Brings the sweep order up to date with the boxes' current positions.
+ * While the same boxes are added as last time, the order is mostly right
+ * already and an insertion sort fixes it in about one pass; otherwise the
+ * order is sorted from scratch.
+ */
+void broadphase_sort_sweep(broadphase_t *broadphase)
+{
+  aabb_t *boxes = broadphase->boxes;
+  if (broadphase->sweep_count != broadphase->box_count)
+  {
+    while (broadphase->sweep_capacity < broadphase->box_count)
+    {
+      broadphase->sweep = broadphase_reserve(
+          broadphase->sweep, broadphase->sweep_capacity,
+          &broadphase->sweep_capacity, sizeof(sweep_entry_t));
+    }
+    for (size_t i = 0; i < broadphase->box_count; i++)
+    {
+      broadphase->sweep[i] = (sweep_entry_t){.min_x = boxes[i].min.x, .box = i};
+    }
+    broadphase->sweep_count = broadphase->box_count;
+    if (broadphase->sweep_count > 0)
+    {
+      qsort(broadphase->sweep, broadphase->sweep_count,
+            sizeof(sweep_entry_t), broadphase_sweep_cmp);
+    }
+    return;
+  }
+
+  sweep_entry_t *sweep = broadphase->sweep;
+  for (size_t i = 0; i < broadphase->sweep_count; i++)
+  {
+    sweep_entry_t entry = {.min_x = boxes[sweep[i].box].min.x,
+                           .box = sweep[i].box};
+    size_t j = i;
+    while (j > 0 && sweep[j - 1].min_x > entry.min_x)
+    {
+      sweep[j] = sweep[j - 1];
+      j--;
+    }
+    sweep[j] = entry;
+  }
+}
+
+void broadphase_find_sweep_pairs(broadphase_t *broadphase)
+{
+  broadphase_sort_sweep(broadphase);
+  aabb_t *boxes = broadphase->boxes;
+  sweep_entry_t *sweep = broadphase->sweep;
+  for (size_t i = 0; i < broadphase->sweep_count; i++)
+  {
+    aabb_t box = boxes[sweep[i].box];
+    // Every later box starts at or after this one, so the first that
+    // starts after this one ends ends the search
+    for (size_t j = i + 1;
+         j < broadphase->sweep_count && sweep[j].min_x <= box.max.x; j++)
+    {
+      if (aabb_overlaps(box, boxes[sweep[j].box]))
+      {
+        broadphase_add_pair(broadphase, sweep[i].box, sweep[j].box);
+      }
+    }
+  }
+}
+
+size_t broadphase_find_pairs(broadphase_t *broadphase)
+{
+  broadphase->pair_count = 0;
+  if (broadphase->mode == BROADPHASE_SWEEP_AND_PRUNE)
+  {
+    broadphase_find_sweep_pairs(broadphase);
+  }
+  else
+  {
+    broadphase_find_grid_pairs(broadphase);
+  }
+  // The pairs array is NULL until the first pair is found
+  if (broadphase->pair_count > 0)
+  {
+    qsort(broadphase->pairs, broadphase->pair_count,
+          sizeof(broadphase_pair_t), broadphase_pair_cmp);
+  }
+  return broadphase->pair_count;
+}
+
+broadphase_pair_t *broadphase_get_pairs(broadphase_t *broadphase)
+{
+  return broadphase->pairs;
+}
+
+bool broadphase_has_pair(broadphase_t *broadphase, size_t first,
+                         size_t second)
+{
+  if (broadphase->pair_count == 0)
+  {
+    return false;
+  }
+  broadphase_pair_t key = first < second
+      ? (broadphase_pair_t){.first = first, .second = second}
+      : (broadphase_pair_t){.first = second, .second = first};
+  return bsearch(&key, broadphase->pairs, broadphase->pair_count,
+                 sizeof(broadphase_pair_t), broadphase_pair_cmp) != NULL;
+}
@@ -1,4 +1,10 @@
 #include "collision.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// find_collision() copies polygons with up to this many vertices onto the
+// stack rather than the heap
+#define COLLISION_LOCAL_VERTICES 64
 
 const double AXIS_ROTATION_FROM_SIDE = M_PI / 2;
 
@@ -58,14 +64,13 @@ double signed_projection_magnitude(vector_t axis, vector_t vertex) {
   return proj_mag;
 }
 
-range_t axis_projection_range(list_t *polygon, vector_t axis) {
+range_t axis_projection_range(polygon_view_t polygon, vector_t axis) {
   double min;
   double max;
 
-  size_t n = list_size(polygon);
+  size_t n = polygon.count;
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = (vector_t *)list_get(polygon, i);
-    double proj_mag = signed_projection_magnitude(axis, *vertex);
+    double proj_mag = signed_projection_magnitude(axis, polygon.vertices[i]);
     if (i == 0) {
       min = proj_mag;
       max = proj_mag;
@@ -81,11 +86,10 @@ range_t axis_projection_range(list_t *polygon, vector_t axis) {
   };
 }
 
-collis_deriv_info_t side_overlap(list_t *shape_a, list_t *shape_b, size_t idx1,
-                                 size_t idx2) {
-  vector_t *a = (vector_t *)list_get(shape_a, idx1);
-  vector_t *b = (vector_t *)list_get(shape_a, idx2);
-  vector_t side = vec_subtract(*a, *b);
+collis_deriv_info_t side_overlap(polygon_view_t shape_a, polygon_view_t shape_b,
+                                 size_t idx1, size_t idx2) {
+  vector_t side =
+      vec_subtract(shape_a.vertices[idx1], shape_a.vertices[idx2]);
   vector_t axis = vec_rotate(side, AXIS_ROTATION_FROM_SIDE);
   range_t range_a = axis_projection_range(shape_a, axis);
   range_t range_b = axis_projection_range(shape_b, axis);
@@ -102,8 +106,9 @@ collis_deriv_info_t best_collision_axis(collis_deriv_info_t a,
   return a.overlap < b.overlap ? a : b;
 }
 
-collis_deriv_info_t axes_match_shape_a(list_t *shape_a, list_t *shape_b) {
-  size_t n = list_size(shape_a);
+collis_deriv_info_t axes_match_shape_a(polygon_view_t shape_a,
+                                       polygon_view_t shape_b) {
+  size_t n = shape_a.count;
   collis_deriv_info_t best;
 
   for (size_t idx1 = 0; idx1 < n; idx1++) {
@@ -117,7 +122,44 @@ collis_deriv_info_t axes_match_shape_a(list_t *shape_a, list_t *shape_b) {
   return best;
 }
 
+/**
+ * Copies a list of vertices into an array, so it can be viewed.
+ * The array is local, which holds COLLISION_LOCAL_VERTICES, unless the
+ * polygon has more vertices than that and needs one from the heap.
+ */
+polygon_view_t polygon_view_copy_list(list_t *polygon, vector_t *local) {
+  size_t n = list_size(polygon);
+  vector_t *vertices = local;
+  if (n > COLLISION_LOCAL_VERTICES) {
+    vertices = malloc(n * sizeof(vector_t));
+    assert(vertices != NULL);
+  }
+  for (size_t i = 0; i < n; i++) {
+    vertices[i] = *(vector_t *)list_get(polygon, i);
+  }
+  return (polygon_view_t){.vertices = vertices, .count = n};
+}
+
+/** Releases a copy made by polygon_view_copy_list() */
+void polygon_view_free_copy(polygon_view_t view, vector_t *local) {
+  if (view.vertices != local) {
+    free((vector_t *)view.vertices);
+  }
+}
+
 collision_info_t find_collision(list_t *shape1, list_t *shape2) {
+  vector_t local1[COLLISION_LOCAL_VERTICES];
+  vector_t local2[COLLISION_LOCAL_VERTICES];
+  polygon_view_t view1 = polygon_view_copy_list(shape1, local1);
+  polygon_view_t view2 = polygon_view_copy_list(shape2, local2);
+  collision_info_t collision = find_collision_views(view1, view2);
+  polygon_view_free_copy(view1, local1);
+  polygon_view_free_copy(view2, local2);
+  return collision;
+}
+
+collision_info_t find_collision_views(polygon_view_t shape1,
+                                      polygon_view_t shape2) {
   collis_deriv_info_t respect1 = axes_match_shape_a(shape1, shape2);
   collis_deriv_info_t respect2 = axes_match_shape_a(shape2, shape1);
   if (!(respect1.info.collided && respect2.info.collided)) {
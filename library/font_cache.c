@@ -0,0 +1,299 @@
+#include "font_cache.h"
+#include "list.h"
+#include <SDL2/SDL_ttf.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t FONT_CACHE_DEFAULT_CAPACITY = 4;
+const char GLYPH_ATLAS_FIRST_CHAR = ' ';
+const char GLYPH_ATLAS_LAST_CHAR = '~';
+const char GLYPH_ATLAS_FALLBACK_CHAR = '?';
+const int GLYPH_ATLAS_WIDTH = 1024;
+const int GLYPH_ATLAS_PADDING = 1;
+const SDL_Color GLYPH_ATLAS_COLOR = {255, 255, 255, 255};
+
+#define GLYPH_ATLAS_GLYPHS ('~' - ' ' + 1)
+
+typedef struct glyph
+{
+  // Where the glyph lives in the atlas texture
+  SDL_Rect source;
+  // How far the pen moves after drawing the glyph
+  int advance;
+} glyph_t;
+
+typedef struct glyph_atlas
+{
+  SDL_Texture *texture;
+  glyph_t glyphs[GLYPH_ATLAS_GLYPHS];
+  int line_height;
+} glyph_atlas_t;
+
+typedef struct font_entry
+{
+  char *file;
+  int point_size;
+  TTF_Font *font;
+  // The font file's contents, if the font was opened from memory and the
+  // entry owns them. SDL_ttf reads glyphs from them lazily, so they live
+  // as long as the font.
+  void *data;
+  glyph_atlas_t *atlas;
+} font_entry_t;
+
+typedef struct font_cache
+{
+  SDL_Renderer *renderer;
+  list_t *entries;
+  // Atlas textures created since the cache was created
+  size_t uploads;
+} font_cache_t;
+
+void glyph_atlas_free(glyph_atlas_t *atlas)
+{
+  if (atlas->texture != NULL)
+  {
+    SDL_DestroyTexture(atlas->texture);
+  }
+  free(atlas);
+}
+
+void font_entry_free(font_entry_t *entry)
+{
+  if (entry->atlas != NULL)
+  {
+    glyph_atlas_free(entry->atlas);
+  }
+  if (entry->font != NULL)
+  {
+    TTF_CloseFont(entry->font);
+  }
+  free(entry->data);
+  free(entry->file);
+  free(entry);
+}
+
+/**
+ * Rasterizes every printable ASCII glyph and packs them into rows
+ * of one texture. Returns NULL if the texture could not be created.
+ */
+glyph_atlas_t *glyph_atlas_build(SDL_Renderer *renderer, TTF_Font *font)
+{
+  glyph_atlas_t *atlas = malloc(sizeof(glyph_atlas_t));
+  assert(atlas != NULL);
+  atlas->texture = NULL;
+  atlas->line_height = TTF_FontHeight(font);
+
+  SDL_Surface *rendered[GLYPH_ATLAS_GLYPHS];
+  int pen_x = 0, pen_y = 0;
+  for (int i = 0; i < GLYPH_ATLAS_GLYPHS; i++)
+  {
+    Uint16 c = GLYPH_ATLAS_FIRST_CHAR + i;
+    glyph_t *glyph = &atlas->glyphs[i];
+    rendered[i] = TTF_RenderGlyph_Blended(font, c, GLYPH_ATLAS_COLOR);
+    if (TTF_GlyphMetrics(font, c, NULL, NULL, NULL, NULL, &glyph->advance) != 0)
+    {
+      glyph->advance = 0;
+    }
+    int w = rendered[i] != NULL ? rendered[i]->w : 0;
+    int h = rendered[i] != NULL ? rendered[i]->h : 0;
+    if (pen_x + w > GLYPH_ATLAS_WIDTH)
+    {
+      pen_x = 0;
+      pen_y += atlas->line_height + GLYPH_ATLAS_PADDING;
+    }
+    glyph->source = (SDL_Rect){.x = pen_x, .y = pen_y, .w = w, .h = h};
+    pen_x += w + GLYPH_ATLAS_PADDING;
+  }
+
+  int atlas_height = pen_y + atlas->line_height;
+  SDL_Surface *sheet = SDL_CreateRGBSurfaceWithFormat(
+      0, GLYPH_ATLAS_WIDTH, atlas_height, 32, SDL_PIXELFORMAT_RGBA32);
+  for (int i = 0; i < GLYPH_ATLAS_GLYPHS; i++)
+  {
+    if (rendered[i] == NULL)
+    {
+      continue;
+    }
+    if (sheet != NULL)
+    {
+      // Copy the glyph's pixels (including alpha) rather than blending them
+      SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+      SDL_Rect dest = atlas->glyphs[i].source;
+      SDL_BlitSurface(rendered[i], NULL, sheet, &dest);
+    }
+    SDL_FreeSurface(rendered[i]);
+  }
+  if (sheet == NULL)
+  {
+    glyph_atlas_free(atlas);
+    return NULL;
+  }
+
+  atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+  SDL_FreeSurface(sheet);
+  if (atlas->texture == NULL)
+  {
+    glyph_atlas_free(atlas);
+    return NULL;
+  }
+  SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+  return atlas;
+}
+
+font_cache_t *font_cache_init(SDL_Renderer *renderer)
+{
+  font_cache_t *cache = malloc(sizeof(font_cache_t));
+  assert(cache != NULL);
+  cache->renderer = renderer;
+  cache->entries =
+      list_init(FONT_CACHE_DEFAULT_CAPACITY, (free_func_t)font_entry_free);
+  cache->uploads = 0;
+  return cache;
+}
+
+void font_cache_free(font_cache_t *cache)
+{
+  list_free(cache->entries);
+  free(cache);
+}
+
+/** Finds the entry for a font file at a point size, or returns NULL */
+font_entry_t *font_cache_find(font_cache_t *cache, const char *file,
+                              int point_size)
+{
+  size_t count = list_size(cache->entries);
+  for (size_t i = 0; i < count; i++)
+  {
+    font_entry_t *entry = list_get(cache->entries, i);
+    if (entry->point_size == point_size && strcmp(entry->file, file) == 0)
+    {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Caches an opened font (or NULL if it failed to open) and builds its atlas.
+ * The entry takes ownership of the font and of the data it was opened from.
+ */
+glyph_atlas_t *font_cache_insert(font_cache_t *cache, const char *file,
+                                 int point_size, TTF_Font *font, void *data)
+{
+  font_entry_t *entry = malloc(sizeof(font_entry_t));
+  assert(entry != NULL);
+  entry->file = malloc(strlen(file) + 1);
+  assert(entry->file != NULL);
+  strcpy(entry->file, file);
+  entry->point_size = point_size;
+  entry->font = font;
+  entry->data = data;
+  entry->atlas =
+      font != NULL ? glyph_atlas_build(cache->renderer, font) : NULL;
+  if (entry->atlas == NULL)
+  {
+    fprintf(stderr, "font_cache: could not load %s at %dpt: %s\n", file,
+            point_size, SDL_GetError());
+  }
+  else
+  {
+    cache->uploads++;
+  }
+  // Failed loads are cached too, so they are not retried every frame
+  list_add(cache->entries, entry);
+  return entry->atlas;
+}
+
+glyph_atlas_t *font_cache_get(font_cache_t *cache, const char *file,
+                              int point_size)
+{
+  font_entry_t *entry = font_cache_find(cache, file, point_size);
+  if (entry != NULL)
+  {
+    return entry->atlas;
+  }
+  return font_cache_insert(cache, file, point_size,
+                           TTF_OpenFont(file, point_size), NULL);
+}
+
+glyph_atlas_t *font_cache_add(font_cache_t *cache, const char *file,
+                              int point_size, void *data, size_t size,
+                              bool owned)
+{
+  font_entry_t *entry = font_cache_find(cache, file, point_size);
+  if (entry != NULL)
+  {
+    if (owned)
+    {
+      free(data);
+    }
+    return entry->atlas;
+  }
+  TTF_Font *font = NULL;
+  if (data != NULL)
+  {
+    SDL_RWops *source = SDL_RWFromConstMem(data, (int)size);
+    font = source != NULL ? TTF_OpenFontRW(source, 1, point_size) : NULL;
+  }
+  if (font == NULL || !owned)
+  {
+    if (owned)
+    {
+      free(data);
+    }
+    data = NULL;
+  }
+  return font_cache_insert(cache, file, point_size, font, data);
+}
+
+size_t font_cache_uploads(font_cache_t *cache) { return cache->uploads; }
+
+/** Gets the atlas glyph used to draw a character */
+glyph_t *glyph_atlas_lookup(glyph_atlas_t *atlas, char c)
+{
+  if (c < GLYPH_ATLAS_FIRST_CHAR || c > GLYPH_ATLAS_LAST_CHAR)
+  {
+    c = GLYPH_ATLAS_FALLBACK_CHAR;
+  }
+  return &atlas->glyphs[c - GLYPH_ATLAS_FIRST_CHAR];
+}
+
+SDL_Point glyph_atlas_measure(glyph_atlas_t *atlas, const char *string)
+{
+  int width = 0;
+  for (const char *c = string; *c != '\0'; c++)
+  {
+    width += glyph_atlas_lookup(atlas, *c)->advance;
+  }
+  return (SDL_Point){.x = width, .y = atlas->line_height};
+}
+
+void glyph_atlas_draw(glyph_atlas_t *atlas, SDL_Renderer *renderer,
+                      const char *string, SDL_Rect bounds)
+{
+  SDL_Point size = glyph_atlas_measure(atlas, string);
+  if (size.x == 0 || size.y == 0)
+  {
+    return;
+  }
+  double x_scale = (double)bounds.w / size.x;
+  double y_scale = (double)bounds.h / size.y;
+
+  int pen = 0;
+  for (const char *c = string; *c != '\0'; c++)
+  {
+    glyph_t *glyph = glyph_atlas_lookup(atlas, *c);
+    SDL_Rect dest = {.x = bounds.x + (int)(pen * x_scale),
+                     .y = bounds.y,
+                     .w = (int)(glyph->source.w * x_scale + 0.5),
+                     .h = (int)(glyph->source.h * y_scale + 0.5)};
+    if (dest.w > 0 && dest.h > 0)
+    {
+      SDL_RenderCopy(renderer, atlas->texture, &glyph->source, &dest);
+    }
+    pen += glyph->advance;
+  }
+}
@@ -165,18 +165,23 @@ void create_destructive_collision(scene_t *scene, body_t *body1,
                    NULL, NULL);
 }
 
-void collision_event_forcer(collision_event_params_t *params) {
-  list_t *shape1 = body_get_shape(params->body1);
-  list_t *shape2 = body_get_shape(params->body2);
-  collision_info_t collision = find_collision(shape1, shape2);
+void collision_event_forcer(collision_event_params_t *params,
+                            bool may_collide) {
+  if (!may_collide || !aabb_overlaps(body_get_aabb(params->body1),
+                                     body_get_aabb(params->body2))) {
+    // The bounding boxes are apart, so the shapes are too
+    params->was_colliding = false;
+    return;
+  }
+  collision_info_t collision =
+      find_collision_views(body_get_shape_view(params->body1),
+                           body_get_shape_view(params->body2));
 
   if (collision.collided && !params->was_colliding) {
     params->handler(params->body1, params->body2, collision.axis, params->aux);
     params->was_colliding = true;
   }
   params->was_colliding = collision.collided;
-  list_free(shape1);
-  list_free(shape2);
 }
 
 void create_collision(scene_t *scene, body_t *body1, body_t *body2,
@@ -184,10 +189,9 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
                       free_func_t freer) {
   collision_event_params_t *params =
       collision_event_params_init(body1, body2, handler, aux, freer, false);
-  list_t *bodies = get_bodies_list(body1, body2);
-  scene_add_bodies_force_creator(scene, (force_creator_t)collision_event_forcer,
-                                 params, bodies,
-                                 (free_func_t)collision_event_params_free);
+  scene_add_collision_creator(scene, body1, body2,
+                              (collision_creator_t)collision_event_forcer,
+                              params, (free_func_t)collision_event_params_free);
 }
 
 double reduced_mass(body_t *body1, body_t *body2) {
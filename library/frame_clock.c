@@ -0,0 +1,50 @@
+#include "frame_clock.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+typedef struct frame_clock
+{
+  double last_tick;
+  bool ticked;
+} frame_clock_t;
+
+double frame_clock_now(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER counter, frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return (double)counter.QuadPart / frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+frame_clock_t *frame_clock_init(void)
+{
+  frame_clock_t *clock = malloc(sizeof(frame_clock_t));
+  assert(clock != NULL);
+  clock->last_tick = 0;
+  clock->ticked = false;
+  return clock;
+}
+
+void frame_clock_free(frame_clock_t *clock) { free(clock); }
+
+double frame_clock_tick(frame_clock_t *clock)
+{
+  double now = frame_clock_now();
+  double elapsed = clock->ticked ? now - clock->last_tick : 0.0;
+  clock->last_tick = now;
+  clock->ticked = true;
+  return elapsed;
+}
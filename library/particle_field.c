@@ -0,0 +1,142 @@
+#include "particle_field.h"
+#include "sprite.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+const size_t PARTICLE_FIELD_INITIAL_CAPACITY = 64;
+// Half the width of the square shape of a field's anchor body
+const double PARTICLE_FIELD_ANCHOR_SIZE = 0.5;
+
+/**
+ * The id given to the next field created; see body.c's next_body_id.
+ */
+size_t next_particle_field_id = 1;
+
+typedef struct particle_field
+{
+  particle_t *particles;
+  size_t count, capacity;
+  body_t *anchor;
+  int render_layer;
+  size_t id;
+  size_t version;
+} particle_field_t;
+
+particle_field_t *particle_field_init(void)
+{
+  particle_field_t *field = malloc(sizeof(particle_field_t));
+  assert(field != NULL);
+  list_t *shape =
+      sprite_make_rect(-PARTICLE_FIELD_ANCHOR_SIZE, PARTICLE_FIELD_ANCHOR_SIZE,
+                       -PARTICLE_FIELD_ANCHOR_SIZE, PARTICLE_FIELD_ANCHOR_SIZE);
+  *field = (particle_field_t){
+      .anchor = body_init(shape, INFINITY, (rgb_color_t){0, 0, 0}),
+      .id = next_particle_field_id++};
+  return field;
+}
+
+void particle_field_free(particle_field_t *field)
+{
+  body_free(field->anchor);
+  free(field->particles);
+  free(field);
+}
+
+void particle_field_add(particle_field_t *field, vector_t position,
+                        double size, rgb_color_t color)
+{
+  if (field->count == field->capacity)
+  {
+    field->capacity = field->capacity > 0 ? 2 * field->capacity
+                                          : PARTICLE_FIELD_INITIAL_CAPACITY;
+    field->particles =
+        realloc(field->particles, field->capacity * sizeof(particle_t));
+    assert(field->particles != NULL);
+  }
+  vector_t origin = body_get_centroid(field->anchor);
+  field->particles[field->count++] =
+      (particle_t){.position = vec_subtract(position, origin),
+                   .size = size,
+                   .color = color};
+  field->version++;
+}
+
+size_t particle_field_remove_outside(particle_field_t *field, vector_t min,
+                                     vector_t max)
+{
+  // Compare positions relative to the origin, so particles are not moved
+  vector_t origin = body_get_centroid(field->anchor);
+  min = vec_subtract(min, origin);
+  max = vec_subtract(max, origin);
+  size_t kept = 0;
+  for (size_t i = 0; i < field->count; i++)
+  {
+    particle_t *particle = &field->particles[i];
+    if (particle->position.x + particle->size >= min.x &&
+        particle->position.x - particle->size <= max.x &&
+        particle->position.y + particle->size >= min.y &&
+        particle->position.y - particle->size <= max.y)
+    {
+      field->particles[kept++] = *particle;
+    }
+  }
+  size_t removed = field->count - kept;
+  field->count = kept;
+  if (removed > 0)
+  {
+    field->version++;
+  }
+  return removed;
+}
+
+size_t particle_field_size(particle_field_t *field) { return field->count; }
+
+particle_t *particle_field_get_particles(particle_field_t *field)
+{
+  return field->particles;
+}
+
+vector_t particle_field_get_origin(particle_field_t *field)
+{
+  return body_get_centroid(field->anchor);
+}
+
+void particle_field_set_velocity(particle_field_t *field, vector_t velocity)
+{
+  body_set_velocity(field->anchor, velocity);
+}
+
+void particle_field_set_camera_mode(particle_field_t *field,
+                                    camera_mode_t camera_mode)
+{
+  body_set_camera_mode(field->anchor, camera_mode);
+}
+
+void particle_field_set_render_layer(particle_field_t *field, int layer)
+{
+  assert(INT16_MIN <= layer && layer <= INT16_MAX);
+  field->render_layer = layer;
+}
+
+int particle_field_get_render_layer(particle_field_t *field)
+{
+  return field->render_layer;
+}
+
+size_t particle_field_get_id(particle_field_t *field) { return field->id; }
+
+size_t particle_field_get_version(particle_field_t *field)
+{
+  return field->version;
+}
+
+body_t *particle_field_get_anchor(particle_field_t *field)
+{
+  return field->anchor;
+}
+
+void particle_field_tick(particle_field_t *field, double dt)
+{
+  body_tick(field->anchor, dt);
+}
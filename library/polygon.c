@@ -66,3 +66,28 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point) {
   }
   polygon_translate(polygon, point);
 }
+
+double polygon_view_area(polygon_view_t polygon) {
+  double sum = 0.0;
+  size_t n = polygon.count;
+  for (size_t i = 0; i < n; i++) {
+    sum += vec_cross(polygon.vertices[i], polygon.vertices[(i + 1) % n]);
+  }
+  return POLYGON_AREA_SCALE_FACTOR * fabs(sum);
+}
+
+vector_t polygon_view_centroid(polygon_view_t polygon) {
+  double c_x = 0.0;
+  double c_y = 0.0;
+  size_t n = polygon.count;
+  for (size_t i = 0; i < n; i++) {
+    vector_t v_i = polygon.vertices[i];
+    vector_t v_i1 = polygon.vertices[(i + 1) % n];
+    double det = vec_cross(v_i, v_i1);
+    c_x += (v_i.x + v_i1.x) * det;
+    c_y += (v_i.y + v_i1.y) * det;
+  }
+  double a_factor = CENTROID_AREA_SCALE_FACTOR / polygon_view_area(polygon);
+  vector_t result = (vector_t){.x = c_x, .y = c_y};
+  return vec_multiply(a_factor, result);
+}
@@ -0,0 +1,187 @@
+#include "projection.h"
+#include <math.h>
+
+// The kernels are chosen at compile time. x86-64 always has SSE2,
+// and AVX2 is used when the compiler targets it (e.g. -mavx2 or -march=native)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PROJECTION_AVX2
+#define PROJECTION_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PROJECTION_SSE2
+#endif
+
+const double PIXEL_MIN = INT16_MIN;
+const double PIXEL_MAX = INT16_MAX;
+
+/**
+ * Maps a scene coordinate to an unrounded pixel coordinate.
+ * The vectorized kernels do the same operations in the same order,
+ * so they give exactly the same results.
+ */
+vector_t view_map(view_t view, vector_t point)
+{
+  return (vector_t){
+      .x = view.pixel_center.x + (point.x - view.center.x) * view.scale,
+      // Flip y axis since positive y is down on the screen
+      .y = view.pixel_center.y - (point.y - view.center.y) * view.scale};
+}
+
+vector_t view_project(view_t view, vector_t point)
+{
+  vector_t pixel = view_map(view, point);
+  return (vector_t){.x = nearbyint(pixel.x), .y = nearbyint(pixel.y)};
+}
+
+/** Rounds a pixel coordinate to an int16_t, saturating */
+int16_t pixel_to_int16(double pixel)
+{
+  return nearbyint(fmin(fmax(pixel, PIXEL_MIN), PIXEL_MAX));
+}
+
+#ifdef PROJECTION_SSE2
+/**
+ * Splits the pixels of four points, packed as x0 y0 x1 y1 x2 y2 x3 y3,
+ * into four x coordinates and four y coordinates.
+ */
+void store_pixels(__m128i pixels, int16_t *xs, int16_t *ys)
+{
+  // x0 x1 y0 y1 x2 x3 y2 y3
+  pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 1, 2, 0));
+  pixels = _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(3, 1, 2, 0));
+  // x0 x1 x2 x3 y0 y1 y2 y3
+  pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 1, 2, 0));
+  _mm_storel_epi64((__m128i *)xs, pixels);
+  _mm_storel_epi64((__m128i *)ys, _mm_unpackhi_epi64(pixels, pixels));
+}
+#endif
+
+#if defined(PROJECTION_AVX2)
+/** The operations of view_map(), on two points at once */
+__m256d view_map_avx(__m256d points, __m256d center, __m256d scale,
+                     __m256d pixel_center, __m256d sign)
+{
+  __m256d offset = _mm256_mul_pd(_mm256_sub_pd(points, center), scale);
+  return _mm256_add_pd(pixel_center, _mm256_mul_pd(offset, sign));
+}
+#elif defined(PROJECTION_SSE2)
+/** The operations of view_map(), on one point */
+__m128d view_map_sse(__m128d point, __m128d center, __m128d scale,
+                     __m128d pixel_center, __m128d sign)
+{
+  __m128d offset = _mm_mul_pd(_mm_sub_pd(point, center), scale);
+  return _mm_add_pd(pixel_center, _mm_mul_pd(offset, sign));
+}
+#endif
+
+void view_project_pixels(view_t view, const vector_t *points, size_t n,
+                         int16_t *xs, int16_t *ys)
+{
+  size_t i = 0;
+#if defined(PROJECTION_AVX2)
+  __m256d center = _mm256_setr_pd(view.center.x, view.center.y, view.center.x,
+                                  view.center.y);
+  __m256d scale = _mm256_set1_pd(view.scale);
+  __m256d pixel_center =
+      _mm256_setr_pd(view.pixel_center.x, view.pixel_center.y,
+                     view.pixel_center.x, view.pixel_center.y);
+  __m256d sign = _mm256_setr_pd(1, -1, 1, -1);
+  __m256d low = _mm256_set1_pd(PIXEL_MIN), high = _mm256_set1_pd(PIXEL_MAX);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256d first = view_map_avx(_mm256_loadu_pd(&points[i].x), center, scale,
+                                 pixel_center, sign);
+    __m256d second = view_map_avx(_mm256_loadu_pd(&points[i + 2].x), center,
+                                  scale, pixel_center, sign);
+    first = _mm256_min_pd(_mm256_max_pd(first, low), high);
+    second = _mm256_min_pd(_mm256_max_pd(second, low), high);
+    // Converting rounds to nearest, ties to even, like nearbyint()
+    __m128i pixels = _mm_packs_epi32(_mm256_cvtpd_epi32(first),
+                                     _mm256_cvtpd_epi32(second));
+    store_pixels(pixels, &xs[i], &ys[i]);
+  }
+#elif defined(PROJECTION_SSE2)
+  __m128d center = _mm_setr_pd(view.center.x, view.center.y);
+  __m128d scale = _mm_set1_pd(view.scale);
+  __m128d pixel_center = _mm_setr_pd(view.pixel_center.x, view.pixel_center.y);
+  __m128d sign = _mm_setr_pd(1, -1);
+  __m128d low = _mm_set1_pd(PIXEL_MIN), high = _mm_set1_pd(PIXEL_MAX);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i rounded[4];
+    for (size_t j = 0; j < 4; j++)
+    {
+      __m128d pixel = view_map_sse(_mm_loadu_pd(&points[i + j].x), center,
+                                   scale, pixel_center, sign);
+      pixel = _mm_min_pd(_mm_max_pd(pixel, low), high);
+      // Converting rounds to nearest, ties to even, like nearbyint()
+      rounded[j] = _mm_cvtpd_epi32(pixel);
+    }
+    __m128i pixels =
+        _mm_packs_epi32(_mm_unpacklo_epi64(rounded[0], rounded[1]),
+                        _mm_unpacklo_epi64(rounded[2], rounded[3]));
+    store_pixels(pixels, &xs[i], &ys[i]);
+  }
+#endif
+  for (; i < n; i++)
+  {
+    vector_t pixel = view_map(view, points[i]);
+    xs[i] = pixel_to_int16(pixel.x);
+    ys[i] = pixel_to_int16(pixel.y);
+  }
+}
+
+void view_project_floats(view_t view, const vector_t *points, size_t n,
+                         float *out, size_t stride)
+{
+  char *bytes = (char *)out;
+  size_t i = 0;
+#if defined(PROJECTION_AVX2)
+  __m256d center = _mm256_setr_pd(view.center.x, view.center.y, view.center.x,
+                                  view.center.y);
+  __m256d scale = _mm256_set1_pd(view.scale);
+  __m256d pixel_center =
+      _mm256_setr_pd(view.pixel_center.x, view.pixel_center.y,
+                     view.pixel_center.x, view.pixel_center.y);
+  __m256d sign = _mm256_setr_pd(1, -1, 1, -1);
+  for (; i + 2 <= n; i += 2)
+  {
+    __m128 pixels = _mm256_cvtpd_ps(view_map_avx(
+        _mm256_loadu_pd(&points[i].x), center, scale, pixel_center, sign));
+    _mm_storel_pi((__m64 *)(bytes + i * stride), pixels);
+    _mm_storeh_pi((__m64 *)(bytes + (i + 1) * stride), pixels);
+  }
+#elif defined(PROJECTION_SSE2)
+  __m128d center = _mm_setr_pd(view.center.x, view.center.y);
+  __m128d scale = _mm_set1_pd(view.scale);
+  __m128d pixel_center = _mm_setr_pd(view.pixel_center.x, view.pixel_center.y);
+  __m128d sign = _mm_setr_pd(1, -1);
+  for (; i < n; i++)
+  {
+    __m128 pixel = _mm_cvtpd_ps(view_map_sse(_mm_loadu_pd(&points[i].x),
+                                             center, scale, pixel_center,
+                                             sign));
+    _mm_storel_pi((__m64 *)(bytes + i * stride), pixel);
+  }
+#endif
+  for (; i < n; i++)
+  {
+    vector_t pixel = view_map(view, points[i]);
+    float *position = (float *)(bytes + i * stride);
+    position[0] = pixel.x;
+    position[1] = pixel.y;
+  }
+}
+
+const char *projection_kernel(void)
+{
+#if defined(PROJECTION_AVX2)
+  return "avx2";
+#elif defined(PROJECTION_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
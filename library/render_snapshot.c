@@ -0,0 +1,441 @@
+#include "render_snapshot.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t RENDER_SNAPSHOT_INITIAL_BODIES = 64;
+const size_t RENDER_SNAPSHOT_INITIAL_VERTICES = 1024;
+const size_t RENDER_SNAPSHOT_INITIAL_TEXTS = 8;
+const size_t RENDER_SNAPSHOT_INITIAL_FIELDS = 4;
+const size_t RENDER_SNAPSHOT_INITIAL_PARTICLES = 1024;
+const size_t RENDER_SNAPSHOT_INITIAL_STRING_BYTES = 1024;
+const uint64_t SIGNATURE_BASIS = 14695981039346656037ULL;
+const uint64_t SIGNATURE_PRIME = 1099511628211ULL;
+
+typedef struct render_snapshot
+{
+  body_record_t *bodies;
+  size_t body_count, body_capacity;
+  vector_t *vertices;
+  size_t vertex_count, vertex_capacity;
+  particle_field_record_t *fields;
+  size_t field_count, field_capacity;
+  particle_t *particles;
+  size_t particle_count, particle_capacity;
+  text_record_t *texts;
+  size_t text_count, text_capacity;
+  // Copies of the records' texture paths and words, one after another
+  char *strings;
+  size_t string_length, string_capacity;
+  // The last string copied, which the next body often shares
+  const char *last_source;
+  const char *last_copy;
+  size_t allocations;
+  uint64_t signature;
+  size_t tick_calls;
+} render_snapshot_t;
+
+/**
+ * Grows an array so it can hold at least the needed number of elements.
+ * The capacity doubles, so repeated captures stop allocating.
+ */
+void *snapshot_reserve(render_snapshot_t *snapshot, void *array,
+                       size_t *capacity, size_t needed, size_t initial,
+                       size_t element_size)
+{
+  if (needed <= *capacity)
+  {
+    return array;
+  }
+  size_t new_capacity = *capacity > 0 ? *capacity : initial;
+  while (new_capacity < needed)
+  {
+    new_capacity *= 2;
+  }
+  array = realloc(array, new_capacity * element_size);
+  assert(array != NULL);
+  *capacity = new_capacity;
+  snapshot->allocations++;
+  return array;
+}
+
+render_snapshot_t *render_snapshot_init(void)
+{
+  render_snapshot_t *snapshot = malloc(sizeof(render_snapshot_t));
+  assert(snapshot != NULL);
+  *snapshot = (render_snapshot_t){0};
+  return snapshot;
+}
+
+void render_snapshot_free(render_snapshot_t *snapshot)
+{
+  free(snapshot->bodies);
+  free(snapshot->vertices);
+  free(snapshot->fields);
+  free(snapshot->particles);
+  free(snapshot->texts);
+  free(snapshot->strings);
+  free(snapshot);
+}
+
+text_record_t text_record_make(text_t *text)
+{
+  return (text_record_t){.text = text,
+                         .version = text_get_version(text),
+                         .words = text_get_words(text),
+                         .numbers = text_get_numbers(text),
+                         .position = text_get_text_position(text),
+                         .dimensions = text_get_text_dimensions(text),
+                         .type = *(enum text_type_t *)text_get_type(text)};
+}
+
+/**
+ * Gets the path of the image a body shows at a renderer frame,
+ * or NULL if it shows none.
+ */
+char *snapshot_body_image(body_t *body, size_t frame)
+{
+  animation_t *animation = body_get_animation(body);
+  if (animation == NULL)
+  {
+    return body_get_texture_path(body);
+  }
+  if (animation_frame_count(animation) == 0)
+  {
+    return NULL;
+  }
+  return animation_get_frame(animation,
+                             animation_frame_at(animation, frame));
+}
+
+/**
+ * Counts the bytes that copying a string into a snapshot takes,
+ * following the same rules as snapshot_copy_string().
+ */
+size_t snapshot_string_size(render_snapshot_t *snapshot, const char *string)
+{
+  if (string == NULL || string == snapshot->last_source)
+  {
+    return 0;
+  }
+  snapshot->last_source = string;
+  return strlen(string) + 1;
+}
+
+/**
+ * Copies a string into the snapshot's string pool, which must have room.
+ * Consecutive bodies usually share a texture path, so a string that was
+ * just copied is shared rather than copied again.
+ */
+const char *snapshot_copy_string(render_snapshot_t *snapshot,
+                                 const char *string)
+{
+  if (string == NULL)
+  {
+    return NULL;
+  }
+  if (string != snapshot->last_source)
+  {
+    size_t size = strlen(string) + 1;
+    assert(snapshot->string_length + size <= snapshot->string_capacity);
+    char *copy = &snapshot->strings[snapshot->string_length];
+    memcpy(copy, string, size);
+    snapshot->string_length += size;
+    snapshot->last_source = string;
+    snapshot->last_copy = copy;
+  }
+  return snapshot->last_copy;
+}
+
+/** Mixes a value into a signature (64-bit FNV-1a, one byte at a time) */
+uint64_t signature_add(uint64_t signature, uint64_t value)
+{
+  for (size_t i = 0; i < sizeof(value); i++)
+  {
+    signature ^= (value >> (8 * i)) & 0xff;
+    signature *= SIGNATURE_PRIME;
+  }
+  return signature;
+}
+
+uint64_t signature_add_double(uint64_t signature, double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return signature_add(signature, bits);
+}
+
+uint64_t signature_add_string(uint64_t signature, const char *value)
+{
+  if (value == NULL)
+  {
+    return signature_add(signature, 0);
+  }
+  for (const char *c = value; *c != '\0'; c++)
+  {
+    signature ^= (uint8_t)*c;
+    signature *= SIGNATURE_PRIME;
+  }
+  // Sets every string apart from NULL and from its own prefixes
+  return signature_add(signature, 1);
+}
+
+uint64_t signature_add_vector(uint64_t signature, vector_t value)
+{
+  signature = signature_add_double(signature, value.x);
+  return signature_add_double(signature, value.y);
+}
+
+/**
+ * Computes a signature of everything that is drawn from a snapshot.
+ * The fields are mixed in one at a time, since records have padding.
+ * Particles are covered by their field's version rather than hashed,
+ * since fields can hold far more particles than bodies have vertices.
+ */
+uint64_t snapshot_compute_signature(render_snapshot_t *snapshot)
+{
+  uint64_t signature = SIGNATURE_BASIS;
+  for (size_t i = 0; i < snapshot->body_count; i++)
+  {
+    body_record_t *record = &snapshot->bodies[i];
+    signature = signature_add(signature, record->id);
+    signature = signature_add_vector(signature, record->centroid);
+    signature = signature_add_double(signature, record->rotation);
+    signature = signature_add_double(signature, record->color.r);
+    signature = signature_add_double(signature, record->color.g);
+    signature = signature_add_double(signature, record->color.b);
+    signature = signature_add_string(signature, record->texture_path);
+    signature = signature_add(signature, record->camera_mode);
+    signature = signature_add(signature, record->static_background);
+    signature = signature_add(signature, (uint64_t)record->layer);
+    signature = signature_add_double(signature, record->circle_radius);
+    signature = signature_add(signature, record->vertex_count);
+  }
+  for (size_t i = 0; i < snapshot->vertex_count; i++)
+  {
+    signature = signature_add_vector(signature, snapshot->vertices[i]);
+  }
+  for (size_t i = 0; i < snapshot->field_count; i++)
+  {
+    particle_field_record_t *field = &snapshot->fields[i];
+    signature = signature_add(signature, field->id);
+    signature = signature_add(signature, field->version);
+    signature = signature_add_vector(signature, field->origin);
+    signature = signature_add(signature, (uint64_t)field->layer);
+  }
+  for (size_t i = 0; i < snapshot->text_count; i++)
+  {
+    text_record_t *text = &snapshot->texts[i];
+    signature = signature_add(signature, (uintptr_t)text->text);
+    signature = signature_add(signature, text->version);
+    signature = signature_add_vector(signature, text->position);
+    signature = signature_add_vector(signature, text->dimensions);
+    signature = signature_add(signature, text->type);
+  }
+  return signature;
+}
+
+/**
+ * Appends a record of a body and its vertices to the snapshot.
+ * The string pool must have room for the body's texture path.
+ */
+void snapshot_add_body(render_snapshot_t *snapshot, body_t *body,
+                       size_t frame)
+{
+  polygon_view_t shape = body_get_shape_view(body);
+  size_t vertex_count = shape.count;
+  aabb_t bounds = body_get_aabb(body);
+  snapshot->vertices = snapshot_reserve(
+      snapshot, snapshot->vertices, &snapshot->vertex_capacity,
+      snapshot->vertex_count + vertex_count, RENDER_SNAPSHOT_INITIAL_VERTICES,
+      sizeof(vector_t));
+  body_record_t record = {
+      .id = body_get_id(body),
+      .centroid = body_get_centroid(body),
+      .rotation = body_get_rotation(body),
+      .min = bounds.min,
+      .max = bounds.max,
+      .color = body_get_color(body),
+      .texture_path =
+          snapshot_copy_string(snapshot, snapshot_body_image(body, frame)),
+      .camera_mode = body_get_camera_mode(body),
+      .static_background = body_is_static_background(body),
+      .layer = body_get_render_layer(body),
+      .circle_radius = body_get_circle_radius(body),
+      .first_vertex = snapshot->vertex_count,
+      .vertex_count = vertex_count};
+
+  memcpy(&snapshot->vertices[snapshot->vertex_count], shape.vertices,
+         vertex_count * sizeof(vector_t));
+  if (record.circle_radius > 0)
+  {
+    // The proxy lies inside the circle, which is what is drawn
+    vector_t radius = {.x = record.circle_radius, .y = record.circle_radius};
+    record.min = vec_subtract(record.centroid, radius);
+    record.max = vec_add(record.centroid, radius);
+  }
+  snapshot->vertex_count += vertex_count;
+  snapshot->bodies[snapshot->body_count++] = record;
+}
+
+/** Appends a record of a particle field and a copy of its particles */
+void snapshot_add_particle_field(render_snapshot_t *snapshot,
+                                 particle_field_t *field)
+{
+  size_t particle_count = particle_field_size(field);
+  snapshot->particles = snapshot_reserve(
+      snapshot, snapshot->particles, &snapshot->particle_capacity,
+      snapshot->particle_count + particle_count,
+      RENDER_SNAPSHOT_INITIAL_PARTICLES, sizeof(particle_t));
+  if (particle_count > 0)
+  {
+    memcpy(&snapshot->particles[snapshot->particle_count],
+           particle_field_get_particles(field),
+           particle_count * sizeof(particle_t));
+  }
+  snapshot->fields[snapshot->field_count++] = (particle_field_record_t){
+      .id = particle_field_get_id(field),
+      .version = particle_field_get_version(field),
+      .origin = particle_field_get_origin(field),
+      .layer = particle_field_get_render_layer(field),
+      .first_particle = snapshot->particle_count,
+      .particle_count = particle_count};
+  snapshot->particle_count += particle_count;
+}
+
+/**
+ * Makes room in the string pool for every texture path and word a scene's
+ * records will copy, so the pool does not move while records point into it.
+ */
+void snapshot_reserve_strings(render_snapshot_t *snapshot, scene_t *scene,
+                              size_t frame)
+{
+  size_t needed = 0;
+  snapshot->last_source = NULL;
+  size_t body_count = scene_bodies(scene);
+  for (size_t i = 0; i < body_count; i++)
+  {
+    needed += snapshot_string_size(
+        snapshot, snapshot_body_image(scene_get_body(scene, i), frame));
+  }
+  size_t text_count = scene_text(scene);
+  for (size_t i = 0; i < text_count; i++)
+  {
+    needed +=
+        snapshot_string_size(snapshot, text_get_words(scene_get_text(scene, i)));
+  }
+  snapshot->strings = snapshot_reserve(
+      snapshot, snapshot->strings, &snapshot->string_capacity, needed,
+      RENDER_SNAPSHOT_INITIAL_STRING_BYTES, sizeof(char));
+  snapshot->string_length = 0;
+  snapshot->last_source = NULL;
+  snapshot->last_copy = NULL;
+}
+
+void render_snapshot_capture(render_snapshot_t *snapshot, scene_t *scene,
+                             size_t frame)
+{
+  snapshot_reserve_strings(snapshot, scene, frame);
+  size_t body_count = scene_bodies(scene);
+  snapshot->bodies = snapshot_reserve(snapshot, snapshot->bodies,
+                                      &snapshot->body_capacity, body_count,
+                                      RENDER_SNAPSHOT_INITIAL_BODIES,
+                                      sizeof(body_record_t));
+  snapshot->body_count = 0;
+  snapshot->vertex_count = 0;
+  for (size_t i = 0; i < body_count; i++)
+  {
+    snapshot_add_body(snapshot, scene_get_body(scene, i), frame);
+  }
+
+  size_t field_count = scene_particle_fields(scene);
+  snapshot->fields = snapshot_reserve(snapshot, snapshot->fields,
+                                      &snapshot->field_capacity, field_count,
+                                      RENDER_SNAPSHOT_INITIAL_FIELDS,
+                                      sizeof(particle_field_record_t));
+  snapshot->field_count = 0;
+  snapshot->particle_count = 0;
+  for (size_t i = 0; i < field_count; i++)
+  {
+    snapshot_add_particle_field(snapshot, scene_get_particle_field(scene, i));
+  }
+
+  size_t text_count = scene_text(scene);
+  snapshot->texts = snapshot_reserve(snapshot, snapshot->texts,
+                                     &snapshot->text_capacity, text_count,
+                                     RENDER_SNAPSHOT_INITIAL_TEXTS,
+                                     sizeof(text_record_t));
+  for (size_t i = 0; i < text_count; i++)
+  {
+    text_record_t record = text_record_make(scene_get_text(scene, i));
+    record.words = snapshot_copy_string(snapshot, record.words);
+    snapshot->texts[i] = record;
+  }
+  snapshot->text_count = text_count;
+  snapshot->signature = snapshot_compute_signature(snapshot);
+  snapshot->tick_calls = scene_get_tick_calls(scene);
+}
+
+uint64_t render_snapshot_signature(render_snapshot_t *snapshot)
+{
+  return snapshot->signature;
+}
+
+size_t render_snapshot_tick_calls(render_snapshot_t *snapshot)
+{
+  return snapshot->tick_calls;
+}
+
+size_t render_snapshot_allocations(render_snapshot_t *snapshot)
+{
+  return snapshot->allocations;
+}
+
+size_t render_snapshot_bodies(render_snapshot_t *snapshot)
+{
+  return snapshot->body_count;
+}
+
+body_record_t *render_snapshot_get_body(render_snapshot_t *snapshot,
+                                        size_t index)
+{
+  assert(index < snapshot->body_count);
+  return &snapshot->bodies[index];
+}
+
+vector_t *render_snapshot_get_vertices(render_snapshot_t *snapshot,
+                                       body_record_t *record)
+{
+  return &snapshot->vertices[record->first_vertex];
+}
+
+size_t render_snapshot_particle_fields(render_snapshot_t *snapshot)
+{
+  return snapshot->field_count;
+}
+
+particle_field_record_t *
+render_snapshot_get_particle_field(render_snapshot_t *snapshot, size_t index)
+{
+  assert(index < snapshot->field_count);
+  return &snapshot->fields[index];
+}
+
+particle_t *render_snapshot_get_particles(render_snapshot_t *snapshot,
+                                          particle_field_record_t *record)
+{
+  return &snapshot->particles[record->first_particle];
+}
+
+size_t render_snapshot_texts(render_snapshot_t *snapshot)
+{
+  return snapshot->text_count;
+}
+
+text_record_t *render_snapshot_get_text(render_snapshot_t *snapshot,
+                                        size_t index)
+{
+  assert(index < snapshot->text_count);
+  return &snapshot->texts[index];
+}
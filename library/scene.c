@@ -6,19 +6,31 @@
  *  @todo Generalize collisions, allow for more than one collision flag.
  */
 #include "scene.h"
+#include "aabb_tree.h"
 #include "text.h"
 #include <assert.h>
+#include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 const size_t BODIES_DEFAULT_CAPACITY = 32;
 const size_t TEXT_DEFAULT_CAPACITY = 32;
 const size_t FORCES_DEFAULT_CAPACITY = 64;
+const size_t PARTICLE_FIELDS_DEFAULT_CAPACITY = 4;
 const size_t INVALID_FOCAL_IDX = -1;
+const double SCENE_DEFAULT_FIXED_STEP = 1.0 / 120;
+const size_t SCENE_DEFAULT_MAX_FIXED_STEPS = 8;
+const size_t COLLISION_BODIES_INITIAL_CAPACITY = 32;
+// How far bodies can move before they must be moved in the AABB trees
+const double SCENE_AABB_TREE_MARGIN = 16;
 
 typedef struct force
 {
   force_creator_t forcer;
+  // Set instead of forcer for collision force creators
+  collision_creator_t collider;
   void *aux;
   free_func_t aux_freer;
   list_t *bodies;
@@ -29,6 +41,7 @@ force_t *force_init(force_creator_t forcer, void *aux, free_func_t aux_freer,
 {
   force_t *force = malloc(sizeof(force_t));
   force->forcer = forcer;
+  force->collider = NULL;
   force->aux = aux;
   force->aux_freer = aux_freer;
   force->bodies = bodies;
@@ -48,6 +61,18 @@ void force_free(force_t *force)
   free(force);
 }
 
+/** Where a body is in the scene's AABB trees */
+typedef struct body_proxy
+{
+  body_t *body;
+  size_t proxy;
+  bool is_static;
+  // Where the body was when its fat box was last checked
+  vector_t centroid;
+  double rotation;
+  shape_t *shape;
+} body_proxy_t;
+
 typedef struct scene
 {
   list_t *bodies;
@@ -58,6 +83,33 @@ typedef struct scene
   void *camera_aux;
   free_func_t camera_aux_free;
   list_t *text;
+  list_t *particle_fields;
+  // State of scene_tick_fixed()
+  double fixed_step;
+  size_t max_fixed_steps;
+  double accumulator;
+  // See scene_get_tick_calls()
+  size_t tick_calls;
+  // The bodies in collision force creators, sorted by address, and their
+  // bounding boxes, in the same order, as of the start of the tick.
+  // The order only changes when bodies come and go, which lets
+  // sweep and prune reuse its order from the last tick.
+  body_t **collision_bodies;
+  size_t collision_body_count;
+  size_t collision_body_capacity;
+  broadphase_t *broadphase;
+  // Once the AABB trees are first used, every body is in one of them and
+  // has a proxy here, sorted by address
+  bool trees_live;
+  aabb_tree_t *static_tree;
+  aabb_tree_t *dynamic_tree;
+  body_proxy_t *body_proxies;
+  size_t body_proxy_count;
+  size_t body_proxy_capacity;
+  // The collision bodies' pairs found in the trees, like the broadphase's
+  broadphase_pair_t *tree_pairs;
+  size_t tree_pair_count;
+  size_t tree_pair_capacity;
 } scene_t;
 
 scene_t *scene_init()
@@ -70,8 +122,27 @@ scene_t *scene_init()
   scene->bodies = bodies;
   scene->forces = forces;
   scene->text = text;
+  scene->particle_fields = list_init(PARTICLE_FIELDS_DEFAULT_CAPACITY,
+                                     (free_func_t)particle_field_free);
   scene->camera_aux = NULL;
   scene->focal_body = NULL;
+  scene->fixed_step = SCENE_DEFAULT_FIXED_STEP;
+  scene->max_fixed_steps = SCENE_DEFAULT_MAX_FIXED_STEPS;
+  scene->accumulator = 0;
+  scene->tick_calls = 0;
+  scene->collision_bodies = NULL;
+  scene->collision_body_count = 0;
+  scene->collision_body_capacity = 0;
+  scene->broadphase = broadphase_init(0);
+  scene->trees_live = false;
+  scene->static_tree = aabb_tree_init(SCENE_AABB_TREE_MARGIN);
+  scene->dynamic_tree = aabb_tree_init(SCENE_AABB_TREE_MARGIN);
+  scene->body_proxies = NULL;
+  scene->body_proxy_count = 0;
+  scene->body_proxy_capacity = 0;
+  scene->tree_pairs = NULL;
+  scene->tree_pair_count = 0;
+  scene->tree_pair_capacity = 0;
   return scene;
 }
 
@@ -80,6 +151,13 @@ void scene_free(scene_t *scene)
   list_free(scene->bodies);
   list_free(scene->forces);
   list_free(scene->text);
+  list_free(scene->particle_fields);
+  free(scene->collision_bodies);
+  broadphase_free(scene->broadphase);
+  aabb_tree_free(scene->static_tree);
+  aabb_tree_free(scene->dynamic_tree);
+  free(scene->body_proxies);
+  free(scene->tree_pairs);
   if (scene->camera_aux_free && scene->camera_aux)
   {
     scene->camera_aux_free(scene->camera_aux);
@@ -87,6 +165,128 @@ void scene_free(scene_t *scene)
   free(scene);
 }
 
+int body_address_cmp(const void *a, const void *b)
+{
+  uintptr_t address_a = (uintptr_t)*(body_t *const *)a;
+  uintptr_t address_b = (uintptr_t)*(body_t *const *)b;
+  return address_a < address_b ? -1 : address_a > address_b;
+}
+
+/**
+ * Finds a body's place in the AABB trees.
+ *
+ * @return the body's proxy, or NULL if it is not in the trees
+ */
+body_proxy_t *find_body_proxy(scene_t *scene, body_t *body)
+{
+  if (scene->body_proxy_count == 0)
+  {
+    return NULL;
+  }
+  // Each proxy starts with its body, so proxies compare like bodies
+  return bsearch(&body, scene->body_proxies, scene->body_proxy_count,
+                 sizeof(body_proxy_t), body_address_cmp);
+}
+
+/** Puts a body into the tree for whether it can move */
+void place_body_proxy(scene_t *scene, body_proxy_t *record)
+{
+  body_t *body = record->body;
+  record->is_static = !body_is_movable(body);
+  record->centroid = body_get_centroid(body);
+  record->rotation = body_get_rotation(body);
+  record->shape = body_get_local_shape(body);
+  aabb_tree_t *tree =
+      record->is_static ? scene->static_tree : scene->dynamic_tree;
+  record->proxy = aabb_tree_insert(tree, body_get_aabb(body), body);
+}
+
+void add_body_proxy(scene_t *scene, body_t *body)
+{
+  if (scene->body_proxy_count == scene->body_proxy_capacity)
+  {
+    scene->body_proxy_capacity = scene->body_proxy_capacity > 0
+                                     ? 2 * scene->body_proxy_capacity
+                                     : BODIES_DEFAULT_CAPACITY;
+    scene->body_proxies =
+        realloc(scene->body_proxies,
+                scene->body_proxy_capacity * sizeof(body_proxy_t));
+    assert(scene->body_proxies != NULL);
+  }
+  size_t index = scene->body_proxy_count;
+  while (index > 0 && (uintptr_t)scene->body_proxies[index - 1].body >
+                          (uintptr_t)body)
+  {
+    scene->body_proxies[index] = scene->body_proxies[index - 1];
+    index--;
+  }
+  scene->body_proxy_count++;
+  scene->body_proxies[index] = (body_proxy_t){.body = body};
+  place_body_proxy(scene, &scene->body_proxies[index]);
+}
+
+void remove_body_proxy(scene_t *scene, body_t *body)
+{
+  body_proxy_t *record = find_body_proxy(scene, body);
+  if (record == NULL)
+  {
+    return;
+  }
+  aabb_tree_remove(record->is_static ? scene->static_tree
+                                     : scene->dynamic_tree,
+                   record->proxy);
+  size_t index = record - scene->body_proxies;
+  scene->body_proxy_count--;
+  memmove(record, record + 1,
+          (scene->body_proxy_count - index) * sizeof(body_proxy_t));
+}
+
+/**
+ * Brings the AABB trees up to date with the bodies, putting every body in
+ * them the first time. Moving bodies are moved in their tree, which only
+ * changes the tree when they leave their fat box. Static bodies are only
+ * looked at again if they were moved (e.g. by the camera) or reshaped.
+ */
+void update_body_trees(scene_t *scene)
+{
+  if (!scene->trees_live)
+  {
+    scene->trees_live = true;
+    for (size_t idx = 0; idx < scene_bodies(scene); idx++)
+    {
+      add_body_proxy(scene, scene_get_body(scene, idx));
+    }
+    return;
+  }
+  for (size_t idx = 0; idx < scene->body_proxy_count; idx++)
+  {
+    body_proxy_t *record = &scene->body_proxies[idx];
+    body_t *body = record->body;
+    bool is_static = !body_is_movable(body);
+    if (is_static != record->is_static)
+    {
+      aabb_tree_remove(record->is_static ? scene->static_tree
+                                         : scene->dynamic_tree,
+                       record->proxy);
+      place_body_proxy(scene, record);
+      continue;
+    }
+    vector_t centroid = body_get_centroid(body);
+    if (is_static && centroid.x == record->centroid.x &&
+        centroid.y == record->centroid.y &&
+        body_get_rotation(body) == record->rotation &&
+        body_get_local_shape(body) == record->shape)
+    {
+      continue;
+    }
+    record->centroid = centroid;
+    record->rotation = body_get_rotation(body);
+    record->shape = body_get_local_shape(body);
+    aabb_tree_move(is_static ? scene->static_tree : scene->dynamic_tree,
+                   record->proxy, body_get_aabb(body));
+  }
+}
+
 size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
 
 size_t scene_forces(scene_t *scene) { return list_size(scene->forces); }
@@ -101,6 +301,10 @@ body_t *scene_get_body(scene_t *scene, size_t index)
 void scene_add_body(scene_t *scene, body_t *body)
 {
   list_add(scene->bodies, body);
+  if (scene->trees_live)
+  {
+    add_body_proxy(scene, body);
+  }
 }
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
@@ -117,6 +321,136 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
   list_add(scene->forces, force);
 }
 
+void scene_add_collision_creator(scene_t *scene, body_t *body1, body_t *body2,
+                                 collision_creator_t collider, void *aux,
+                                 free_func_t freer)
+{
+  list_t *bodies = list_init(2, NULL);
+  list_add(bodies, body1);
+  list_add(bodies, body2);
+  force_t *force = force_init(NULL, aux, freer, bodies);
+  force->collider = collider;
+  list_add(scene->forces, force);
+}
+
+void scene_set_broadphase_mode(scene_t *scene, broadphase_mode_t mode)
+{
+  broadphase_set_mode(scene->broadphase, mode);
+}
+
+broadphase_mode_t scene_get_broadphase_mode(scene_t *scene)
+{
+  return broadphase_get_mode(scene->broadphase);
+}
+
+typedef struct scene_query_aux
+{
+  aabb_t box;
+  scene_query_func_t func;
+  void *aux;
+  bool stopped;
+} scene_query_aux_t;
+
+bool scene_query_body(void *aux, size_t proxy, void *data)
+{
+  scene_query_aux_t *query = aux;
+  body_t *body = data;
+  if (body_is_removed(body) || !aabb_overlaps(body_get_aabb(body), query->box))
+  {
+    return true;
+  }
+  query->stopped = !query->func(body, query->aux);
+  return !query->stopped;
+}
+
+void scene_query_aabb(scene_t *scene, aabb_t box, scene_query_func_t func,
+                      void *aux)
+{
+  update_body_trees(scene);
+  scene_query_aux_t query = {
+      .box = box, .func = func, .aux = aux, .stopped = false};
+  aabb_tree_query(scene->static_tree, box, scene_query_body, &query);
+  if (!query.stopped)
+  {
+    aabb_tree_query(scene->dynamic_tree, box, scene_query_body, &query);
+  }
+}
+
+typedef struct scene_ray
+{
+  vector_t origin;
+  vector_t direction;
+} scene_ray_t;
+
+/**
+ * Finds how far along a ray it first crosses an edge of a body's shape.
+ *
+ * @return the distance, or -1 if the ray misses the body
+ */
+double scene_ray_body(void *aux, size_t proxy, void *data)
+{
+  scene_ray_t *ray = aux;
+  body_t *body = data;
+  if (body_is_removed(body))
+  {
+    return -1;
+  }
+  double closest = -1;
+  size_t count = body_vertex_count(body);
+  vector_t start = body_get_vertex(body, count - 1);
+  for (size_t idx = 0; idx < count; idx++)
+  {
+    vector_t end = body_get_vertex(body, idx);
+    vector_t edge = vec_subtract(end, start);
+    double denominator = vec_cross(ray->direction, edge);
+    if (denominator != 0)
+    {
+      // Solve origin + distance * direction = start + along * edge
+      vector_t to_start = vec_subtract(start, ray->origin);
+      double distance = vec_cross(to_start, edge) / denominator;
+      double along = vec_cross(to_start, ray->direction) / denominator;
+      if (distance >= 0 && along >= 0 && along <= 1 &&
+          (closest < 0 || distance < closest))
+      {
+        closest = distance;
+      }
+    }
+    start = end;
+  }
+  return closest;
+}
+
+body_t *scene_raycast(scene_t *scene, vector_t origin, vector_t direction,
+                      double max_distance, double *distance)
+{
+  update_body_trees(scene);
+  scene_ray_t ray = {.origin = origin, .direction = vec_unit(direction)};
+  double static_distance = max_distance;
+  size_t static_hit =
+      aabb_tree_raycast(scene->static_tree, ray.origin, ray.direction,
+                        max_distance, scene_ray_body, &ray, &static_distance);
+  // Moving bodies only matter if they are hit before the closest static one
+  double dynamic_distance = static_distance;
+  size_t dynamic_hit = aabb_tree_raycast(
+      scene->dynamic_tree, ray.origin, ray.direction, static_distance,
+      scene_ray_body, &ray, &dynamic_distance);
+
+  body_t *hit = NULL;
+  if (dynamic_hit != AABB_TREE_NULL)
+  {
+    hit = aabb_tree_get_data(scene->dynamic_tree, dynamic_hit);
+  }
+  else if (static_hit != AABB_TREE_NULL)
+  {
+    hit = aabb_tree_get_data(scene->static_tree, static_hit);
+  }
+  if (hit != NULL && distance != NULL)
+  {
+    *distance = dynamic_distance;
+  }
+  return hit;
+}
+
 void scene_remove_body(scene_t *scene, size_t index)
 {
   assert(index >= 0 && index < scene_bodies(scene));
@@ -172,14 +506,233 @@ void apply_camera(scene_t *scene)
     vector_t movement = scene->camera_mover(offset, current_body);
     body_adjust_for_camera(current_body, movement);
   }
+  for (size_t idx = 0; idx < scene_particle_fields(scene); idx++)
+  {
+    body_t *anchor =
+        particle_field_get_anchor(scene_get_particle_field(scene, idx));
+    vector_t movement = scene->camera_mover(offset, anchor);
+    body_adjust_for_camera(anchor, movement);
+  }
+}
+
+void add_collision_body(scene_t *scene, body_t *body)
+{
+  if (scene->collision_body_count == scene->collision_body_capacity)
+  {
+    scene->collision_body_capacity =
+        scene->collision_body_capacity > 0
+            ? 2 * scene->collision_body_capacity
+            : COLLISION_BODIES_INITIAL_CAPACITY;
+    scene->collision_bodies =
+        realloc(scene->collision_bodies,
+                scene->collision_body_capacity * sizeof(body_t *));
+    assert(scene->collision_bodies != NULL);
+  }
+  scene->collision_bodies[scene->collision_body_count++] = body;
+}
+
+int tree_pair_cmp(const void *a, const void *b)
+{
+  const broadphase_pair_t *pair_a = a;
+  const broadphase_pair_t *pair_b = b;
+  if (pair_a->first != pair_b->first)
+  {
+    return pair_a->first < pair_b->first ? -1 : 1;
+  }
+  return pair_a->second < pair_b->second ? -1
+                                         : pair_a->second > pair_b->second;
+}
+
+typedef struct tree_candidate_aux
+{
+  scene_t *scene;
+  // The index in collision_bodies of the body being looked up
+  size_t first;
+  // Whether the tree being searched holds moving bodies
+  bool dynamic;
+} tree_candidate_aux_t;
+
+bool add_tree_candidate(void *aux, size_t proxy, void *data)
+{
+  tree_candidate_aux_t *candidate = aux;
+  scene_t *scene = candidate->scene;
+  body_t *body = data;
+  body_t **found =
+      bsearch(&body, scene->collision_bodies, scene->collision_body_count,
+              sizeof(body_t *), body_address_cmp);
+  if (found == NULL)
+  {
+    return true;
+  }
+  size_t second = found - scene->collision_bodies;
+  // Pairs of moving bodies are found from both sides; keep one
+  if (candidate->dynamic ? second <= candidate->first
+                         : second == candidate->first)
+  {
+    return true;
+  }
+  if (scene->tree_pair_count == scene->tree_pair_capacity)
+  {
+    scene->tree_pair_capacity = scene->tree_pair_capacity > 0
+                                    ? 2 * scene->tree_pair_capacity
+                                    : COLLISION_BODIES_INITIAL_CAPACITY;
+    scene->tree_pairs =
+        realloc(scene->tree_pairs,
+                scene->tree_pair_capacity * sizeof(broadphase_pair_t));
+    assert(scene->tree_pairs != NULL);
+  }
+  size_t first = candidate->first;
+  scene->tree_pairs[scene->tree_pair_count++] =
+      first < second
+          ? (broadphase_pair_t){.first = first, .second = second}
+          : (broadphase_pair_t){.first = second, .second = first};
+  return true;
+}
+
+/**
+ * Finds the pairs of collision bodies that may overlap by looking up each
+ * moving collision body's box in both AABB trees. Two static bodies are
+ * never a pair.
+ */
+void find_tree_candidates(scene_t *scene)
+{
+  update_body_trees(scene);
+  for (size_t idx = 0; idx < scene->collision_body_count; idx++)
+  {
+    body_proxy_t *record =
+        find_body_proxy(scene, scene->collision_bodies[idx]);
+    if (record == NULL || record->is_static)
+    {
+      continue;
+    }
+    aabb_t box = body_get_aabb(record->body);
+    tree_candidate_aux_t aux = {.scene = scene, .first = idx, .dynamic = false};
+    aabb_tree_query(scene->static_tree, box, add_tree_candidate, &aux);
+    aux.dynamic = true;
+    aabb_tree_query(scene->dynamic_tree, box, add_tree_candidate, &aux);
+  }
+  // The pairs array is NULL until the first pair is found
+  if (scene->tree_pair_count > 0)
+  {
+    qsort(scene->tree_pairs, scene->tree_pair_count,
+          sizeof(broadphase_pair_t), tree_pair_cmp);
+  }
+}
+
+/**
+ * Puts the bounding box of each body in a collision force creator into the
+ * broadphase once, and finds which of them overlap.
+ */
+void find_collision_candidates(scene_t *scene)
+{
+  scene->collision_body_count = 0;
+  for (size_t idx = 0; idx < scene_forces(scene); idx++)
+  {
+    force_t *force = list_get(scene->forces, idx);
+    if (force->collider != NULL)
+    {
+      add_collision_body(scene, list_get(force->bodies, 0));
+      add_collision_body(scene, list_get(force->bodies, 1));
+    }
+  }
+  broadphase_clear(scene->broadphase);
+  scene->tree_pair_count = 0;
+  if (scene->collision_body_count == 0)
+  {
+    return;
+  }
+  bool use_trees =
+      broadphase_get_mode(scene->broadphase) == BROADPHASE_AABB_TREE;
+
+  qsort(scene->collision_bodies, scene->collision_body_count,
+        sizeof(body_t *), body_address_cmp);
+  size_t unique = 0;
+  for (size_t idx = 0; idx < scene->collision_body_count; idx++)
+  {
+    body_t *body = scene->collision_bodies[idx];
+    if (unique == 0 || scene->collision_bodies[unique - 1] != body)
+    {
+      scene->collision_bodies[unique++] = body;
+      if (!use_trees)
+      {
+        broadphase_add(scene->broadphase, body_get_aabb(body));
+      }
+    }
+  }
+  scene->collision_body_count = unique;
+  if (use_trees)
+  {
+    find_tree_candidates(scene);
+  }
+  else
+  {
+    broadphase_find_pairs(scene->broadphase);
+  }
+}
+
+/**
+ * Checks whether the broadphase (or the AABB trees) found the bodies of a
+ * collision force creator overlapping. Force creators added during this tick, whose bodies
+ * the broadphase may not have seen, always may collide.
+ */
+bool collision_is_candidate(scene_t *scene, force_t *force)
+{
+  body_t *body1 = list_get(force->bodies, 0);
+  body_t *body2 = list_get(force->bodies, 1);
+  if (scene->collision_body_count == 0)
+  {
+    return true;
+  }
+  body_t **found1 =
+      bsearch(&body1, scene->collision_bodies, scene->collision_body_count,
+              sizeof(body_t *), body_address_cmp);
+  body_t **found2 =
+      bsearch(&body2, scene->collision_bodies, scene->collision_body_count,
+              sizeof(body_t *), body_address_cmp);
+  if (found1 == NULL || found2 == NULL || found1 == found2)
+  {
+    return true;
+  }
+  if (broadphase_get_mode(scene->broadphase) == BROADPHASE_AABB_TREE)
+  {
+    // Bodies outside the scene are not in the trees
+    if (find_body_proxy(scene, body1) == NULL ||
+        find_body_proxy(scene, body2) == NULL)
+    {
+      return true;
+    }
+    size_t first = found1 - scene->collision_bodies;
+    size_t second = found2 - scene->collision_bodies;
+    if (scene->tree_pair_count == 0)
+    {
+      return false;
+    }
+    broadphase_pair_t key =
+        first < second
+            ? (broadphase_pair_t){.first = first, .second = second}
+            : (broadphase_pair_t){.first = second, .second = first};
+    return bsearch(&key, scene->tree_pairs, scene->tree_pair_count,
+                   sizeof(broadphase_pair_t), tree_pair_cmp) != NULL;
+  }
+  return broadphase_has_pair(scene->broadphase,
+                             found1 - scene->collision_bodies,
+                             found2 - scene->collision_bodies);
 }
 
 void apply_forces(scene_t *scene)
 {
+  find_collision_candidates(scene);
   for (size_t idx = 0; idx < scene_forces(scene); idx++)
   {
     force_t *force = list_get(scene->forces, idx);
-    force->forcer(force->aux);
+    if (force->collider != NULL)
+    {
+      force->collider(force->aux, collision_is_candidate(scene, force));
+    }
+    else
+    {
+      force->forcer(force->aux);
+    }
   }
 }
 
@@ -206,12 +759,40 @@ void move_and_clean_bodies(scene_t *scene, double dt)
     if (body_is_removed(current_body))
     {
       list_remove(scene->bodies, idx);
+      if (scene->trees_live)
+      {
+        remove_body_proxy(scene, current_body);
+      }
       body_free(current_body);
       idx--;
     }
   }
 }
 
+void move_particle_fields(scene_t *scene, double dt)
+{
+  for (size_t idx = 0; idx < scene_particle_fields(scene); idx++)
+  {
+    particle_field_tick(scene_get_particle_field(scene, idx), dt);
+  }
+}
+
+void scene_add_particle_field(scene_t *scene, particle_field_t *field)
+{
+  list_add(scene->particle_fields, field);
+}
+
+size_t scene_particle_fields(scene_t *scene)
+{
+  return list_size(scene->particle_fields);
+}
+
+particle_field_t *scene_get_particle_field(scene_t *scene, size_t index)
+{
+  assert(index < list_size(scene->particle_fields));
+  return list_get(scene->particle_fields, index);
+}
+
 void scene_add_text(scene_t *scene, text_t *text)
 {
   list_add(scene->text, text);
@@ -233,8 +814,46 @@ void scene_remove_text(scene_t *scene, size_t index)
 
 void scene_tick(scene_t *scene, double dt)
 {
+  scene->tick_calls++;
   apply_forces(scene);
   clean_forces(scene);
   move_and_clean_bodies(scene, dt);
+  move_particle_fields(scene, dt);
   apply_camera(scene);
 }
+
+void scene_set_fixed_step(scene_t *scene, double step, size_t max_steps)
+{
+  assert(step > 0);
+  assert(max_steps > 0);
+  scene->fixed_step = step;
+  scene->max_fixed_steps = max_steps;
+}
+
+double scene_tick_fixed(scene_t *scene, double dt)
+{
+  // Counts even if no step is due, since the scene is still running
+  scene->tick_calls++;
+  scene->accumulator += dt;
+  size_t steps = 0;
+  while (scene->accumulator >= scene->fixed_step &&
+         steps < scene->max_fixed_steps)
+  {
+    scene_tick(scene, scene->fixed_step);
+    scene->accumulator -= scene->fixed_step;
+    steps++;
+  }
+  if (scene->accumulator >= scene->fixed_step)
+  {
+    // Drop the time that could not be caught up, keeping the partial step
+    scene->accumulator = fmod(scene->accumulator, scene->fixed_step);
+  }
+  return steps * scene->fixed_step;
+}
+
+size_t scene_get_tick_calls(scene_t *scene) { return scene->tick_calls; }
+
+double scene_get_interpolation_alpha(scene_t *scene)
+{
+  return scene->accumulator / scene->fixed_step;
+}
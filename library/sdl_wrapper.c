@@ -1,5 +1,16 @@
 #include "sdl_wrapper.h"
+#include "asset_bundle.h"
+#include "asset_loader.h"
+#include "asset_manifest.h"
+#include "font_cache.h"
+#include "frame_clock.h"
+#include "projection.h"
+#include "render_snapshot.h"
+#include "sprite.h"
 #include "text.h"
+#include "text_cache.h"
+#include "texture_atlas.h"
+#include "texture_cache.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_image.h>
@@ -8,12 +19,135 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 const char WINDOW_TITLE[] = "CS 3";
 const int WINDOW_WIDTH = 1000;
 const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
+const char TEXT_FONT_FILE[] = "CourierPrime-Regular.ttf";
+const int TEXT_FONT_SIZE = 100;
+const size_t BATCH_INITIAL_VERTICES = 1024;
+const size_t POLYGON_INITIAL_VERTICES = 64;
+const size_t RENDER_QUEUE_INITIAL_ITEMS = 256;
+// How long sdl_run_simulation() waits for input while the screen is static
+const double IDLE_WAIT_TIMEOUT = 0.1;
+// The statistics overlay's text is drawn with the HUD font, scaled down
+const double STATS_OVERLAY_SCALE = 0.16;
+const int STATS_OVERLAY_MARGIN = 8;
+// Frames of statistics kept before they are written to the CSV file
+const size_t STATS_HISTORY_FRAMES = 256;
+// Column names for each render_phase_t
+const char *const RENDER_PHASE_NAMES[RENDER_PHASE_COUNT] = {
+    [RENDER_PHASE_CAPTURE] = "capture",
+    [RENDER_PHASE_UPLOAD] = "upload",
+    [RENDER_PHASE_STATIC_LAYERS] = "static_layers",
+    [RENDER_PHASE_QUEUE] = "queue",
+    [RENDER_PHASE_BODIES] = "bodies",
+    [RENDER_PHASE_TEXT] = "text",
+    [RENDER_PHASE_PRESENT] = "present",
+};
+
+#define STATIC_LAYER_COUNT (SCENE + 1)
+// Textures given their own id in a frame's sort keys; any further textures
+// share one id, so they are drawn in scene order rather than grouped
+#define RENDER_QUEUE_TEXTURE_SLOTS 255
+// Sort key layout, from the most significant bit: the body's layer (biased
+// to be unsigned), the id of its texture (0 for flat colors), and whether
+// it is alpha blended. Only the bytes holding these bits are radix sorted.
+#define RENDER_KEY_TEXTURE_SHIFT 1
+#define RENDER_KEY_LAYER_SHIFT 17
+#define RENDER_KEY_BYTES 5
+#define STATS_OVERLAY_MAX_LINES (6 + RENDER_PHASE_COUNT)
+#define STATS_OVERLAY_LINE_LENGTH 64
+
+/**
+ * The static background bodies of one camera mode, drawn into one texture.
+ * All of them move together, so the texture follows one of them (the anchor).
+ */
+typedef struct static_layer
+{
+  // Identifies the set of bodies in the layer
+  size_t count, id_sum, id_xor;
+  size_t anchor_id;
+  // The anchor's centroid when the layer was drawn
+  vector_t anchor_centroid;
+  // The scene rectangle drawn into the texture, and the bounds of all of the
+  // layer's bodies, as they were when the layer was drawn
+  vector_t min, max;
+  vector_t bodies_min, bodies_max;
+  double scale;
+  // NULL if no part of the layer was in range when it was drawn
+  SDL_Texture *texture;
+  // Whether the layer's bodies are drawn by the texture, rather than
+  // individually (if the renderer could not create the texture)
+  bool drawn;
+} static_layer_t;
+
+/**
+ * The operations that differ between render backends.
+ */
+typedef struct backend_ops
+{
+  // Sets up SDL and the renderer global (NULL if nothing is drawn)
+  void (*open)(void);
+  // Releases what open() created
+  void (*close)(void);
+  // Gets the size of the render output in pixels
+  void (*get_size)(int *width, int *height);
+} backend_ops_t;
+
+/**
+ * The thread that sdl_run_simulation() steps the simulation on,
+ * and the state it shares with the main thread.
+ */
+typedef struct simulation_worker
+{
+  SDL_Thread *thread;
+  SDL_mutex *lock;
+  // Signalled whenever busy or quit changes
+  SDL_cond *changed;
+  simulation_step_t step;
+  void *aux;
+  // The snapshot that the current step is captured into, and the number of
+  // the frame it will be drawn in
+  render_snapshot_t *target;
+  size_t frame;
+  // Set by the main thread to start a step; cleared by the worker when done
+  bool busy;
+  // Whether the last step returned NULL
+  bool finished;
+  // Set by the main thread to stop the worker
+  bool quit;
+} simulation_worker_t;
+
+/**
+ * The texture and source rectangle that a textured body is drawn with.
+ */
+typedef struct body_image
+{
+  // NULL if the body's image could not be loaded
+  SDL_Texture *texture;
+  SDL_Rect source;
+  // The size of the whole texture, to compute texture coordinates
+  SDL_Point texture_size;
+} body_image_t;
+
+/**
+ * A body or particle field waiting in the render queue to be drawn.
+ */
+typedef struct render_item
+{
+  // Items are drawn in increasing order of key; see RENDER_KEY_LAYER_SHIFT
+  uint64_t key;
+  // Exactly one of these is set
+  body_record_t *record;
+  particle_field_record_t *field;
+  SDL_Rect bounds;
+  // Whether the body is drawn with image rather than as a polygon
+  bool has_image;
+  body_image_t image;
+} render_item_t;
 
 /**
  * The coordinate at the center of the screen.
@@ -24,13 +158,165 @@ vector_t center;
  */
 vector_t max_diff;
 /**
- * The SDL window where the scene is rendered.
+ * The SDL window where the scene is rendered, or NULL if there is none.
+ */
+SDL_Window *window = NULL;
+/**
+ * The surface the software backend draws into, or NULL.
+ */
+SDL_Surface *software_surface = NULL;
+/**
+ * The view that fits the scene in the window. It only changes when the
+ * window is resized, so it is computed once and kept until then.
+ */
+view_t window_view;
+bool window_view_valid = false;
+/**
+ * The renderer used to draw the scene, or NULL for the null backend.
+ */
+SDL_Renderer *renderer = NULL;
+/**
+ * The operations of the backend chosen in sdl_init().
+ */
+const backend_ops_t *backend = NULL;
+/**
+ * sdl_is_done() returns true after this many frames; 0 means never.
+ */
+size_t max_frames = 0;
+/**
+ * Textures for body images, keyed by path, so each image is decoded once.
+ */
+texture_cache_t *textures = NULL;
+/**
+ * Images packed into one texture by sdl_load_texture_atlas(), or NULL.
+ */
+texture_atlas_t *image_atlas = NULL;
+/**
+ * The manifest passed to sdl_load_assets(), which owns the paths of the
+ * textures cached from it, and the loader decoding its assets (NULL once
+ * every asset has been uploaded).
+ */
+asset_manifest_t *asset_manifest = NULL;
+asset_loader_t *asset_loader = NULL;
+/**
+ * The bundle passed to sdl_load_assets(), or NULL if there is none.
+ * Fonts read glyphs from it, so it is closed after the font cache is freed.
+ */
+asset_bundle_t *asset_bundle = NULL;
+/**
+ * The callback told about loading progress, its argument, and whether
+ * assets were uploaded since it was last called.
+ */
+asset_progress_t asset_progress = NULL;
+void *asset_progress_aux = NULL;
+bool asset_progress_changed = false;
+size_t assets_uploaded = 0, assets_total = 0;
+/**
+ * Images that sdl_load_texture_atlas() asked to pack while they were still
+ * being loaded, and their surfaces (NULL until each has been decoded).
+ */
+char **pending_atlas_paths = NULL;
+SDL_Surface **pending_atlas_surfaces = NULL;
+size_t pending_atlas_count = 0;
+/**
+ * The number of frames shown so far. Animations are timed by this count.
+ */
+size_t frames_shown = 0;
+/**
+ * Fonts and their glyph atlases, opened once per file and point size.
+ */
+font_cache_t *fonts = NULL;
+/**
+ * Rendered text textures, rebuilt only when a text's version changes.
+ */
+text_cache_t *text_textures = NULL;
+/**
+ * How sdl_render_scene() submits bodies; see sdl_set_render_mode().
+ */
+render_mode_t render_mode = RENDER_IMMEDIATE;
+/**
+ * Statistics for the frame being drawn and for the last frame shown.
+ * A frame is open from the first sdl_clear() until the next sdl_show().
+ */
+render_stats_t frame_stats;
+render_stats_t last_frame_stats;
+bool frame_open = false;
+/**
+ * The caches' counts of textures created and texts drawn when the open
+ * frame began, so the frame's statistics count what it added to them.
+ */
+size_t frame_start_uploads = 0, frame_start_rasterizations = 0;
+/**
+ * Whether the statistics overlay is drawn; toggled by pressing F3.
+ */
+bool stats_overlay = false;
+/**
+ * The file every frame's statistics are written to (NULL if
+ * SDL_WRAPPER_STATS_CSV is not set), the frames not written yet, and the
+ * number of rows written so far. Rows are written STATS_HISTORY_FRAMES at
+ * a time, so file I/O rarely slows down a frame, and the statistics never
+ * take more memory than the buffer allocated when the file is opened.
+ */
+FILE *stats_csv_file = NULL;
+render_stats_t *stats_history = NULL;
+size_t stats_history_count = 0;
+size_t stats_csv_rows = 0;
+/**
+ * The signature of the snapshot on screen (see render_snapshot_signature()),
+ * and
+ * whether the screen must be redrawn even if the next frame's signature
+ * matches it, e.g. because the window was resized or drawn to directly.
+ */
+uint64_t presented_signature = 0;
+bool frame_dirty = true;
+/**
+ * The number of events that sdl_is_done() has handled.
+ */
+size_t handled_events = 0;
+/**
+ * The geometry batch being built in RENDER_BATCHED mode.
+ * The arrays are kept between frames and only grow.
+ */
+SDL_Vertex *batch_vertices = NULL;
+int *batch_indices = NULL;
+size_t batch_vertex_count = 0, batch_vertex_capacity = 0;
+size_t batch_index_count = 0, batch_index_capacity = 0;
+/**
+ * Scratch buffers for drawing one polygon at a time.
+ * Like the batch, they are kept between frames and only grow.
+ */
+vector_t *polygon_vertices = NULL;
+size_t polygon_vertex_capacity = 0;
+// The x coordinates of the pixels, followed by the y coordinates
+int16_t *polygon_pixels = NULL;
+size_t polygon_pixel_capacity = 0;
+/**
+ * The texture the current batch is drawn with, or NULL for flat colors.
+ */
+SDL_Texture *batch_texture = NULL;
+/**
+ * The bodies to draw this frame, and a second array to radix sort them
+ * through. Like the batch, they are kept between frames and only grow.
+ */
+render_item_t *queue_items = NULL, *queue_sorted = NULL;
+size_t queue_item_capacity = 0, queue_sorted_capacity = 0;
+/**
+ * The textures given ids in this frame's sort keys, in the order they were
+ * first queued. A texture's id is its index plus one.
+ */
+SDL_Texture *queue_textures[RENDER_QUEUE_TEXTURE_SLOTS];
+size_t queue_texture_count = 0;
+// The texture whose id was last looked up, and its id
+SDL_Texture *queue_last_texture = NULL;
+size_t queue_last_texture_id = 0;
+/**
+ * The snapshot that sdl_render_scene() captures scenes into.
  */
-SDL_Window *window;
+render_snapshot_t *scene_snapshot = NULL;
 /**
- * The renderer used to draw the scene.
+ * The static background layer for each camera mode.
  */
-SDL_Renderer *renderer;
+static_layer_t static_layers[STATIC_LAYER_COUNT];
 /**
  * The keypress handler, or NULL if none has been configured.
  */
@@ -47,21 +333,76 @@ void *event_args = NULL;
  */
 uint32_t key_start_timestamp;
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * The clock read by time_since_last_tick(), or NULL until it is first called.
+ */
+frame_clock_t *tick_clock = NULL;
+
+/**
+ * Grows a scratch buffer so it can hold at least the needed number of
+ * elements, doubling its capacity. Each growth is counted in the frame's
+ * statistics, so a frame that reuses its buffers reports no allocations.
+ * The buffer's contents are not kept.
+ */
+void *scratch_reserve(void *buffer, size_t *capacity, size_t needed,
+                      size_t initial, size_t element_size)
+{
+  if (needed <= *capacity)
+  {
+    return buffer;
+  }
+  size_t new_capacity = *capacity > 0 ? *capacity : initial;
+  while (new_capacity < needed)
+  {
+    new_capacity *= 2;
+  }
+  free(buffer);
+  buffer = malloc(new_capacity * element_size);
+  assert(buffer != NULL);
+  *capacity = new_capacity;
+  frame_stats.allocations++;
+  return buffer;
+}
+
+/**
+ * Finds an image that is waiting to be packed into the atlas,
+ * or returns TEXTURE_ATLAS_NOT_FOUND.
  */
-clock_t last_clock = 0;
+size_t pending_atlas_find(const char *texture_path)
+{
+  for (size_t i = 0; i < pending_atlas_count; i++)
+  {
+    if (pending_atlas_paths[i] == texture_path ||
+        strcmp(pending_atlas_paths[i], texture_path) == 0)
+    {
+      return i;
+    }
+  }
+  return TEXTURE_ATLAS_NOT_FOUND;
+}
+
+/** Releases the images waiting to be packed into the atlas */
+void pending_atlas_free(void)
+{
+  for (size_t i = 0; i < pending_atlas_count; i++)
+  {
+    if (pending_atlas_surfaces[i] != NULL)
+    {
+      SDL_FreeSurface(pending_atlas_surfaces[i]);
+    }
+  }
+  free(pending_atlas_paths);
+  free(pending_atlas_surfaces);
+  pending_atlas_paths = NULL;
+  pending_atlas_surfaces = NULL;
+  pending_atlas_count = 0;
+}
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void)
 {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  backend->get_size(&width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -78,18 +419,106 @@ double get_scene_scale(vector_t window_center)
   return x_scale < y_scale ? x_scale : y_scale;
 }
 
-/** Maps a scene coordinate to a window coordinate */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center)
+/**
+ * Computes the corners of the scene rectangle that is visible in a view
+ * of the whole window. This can be larger than the rectangle passed to
+ * sdl_init() in one dimension if the window's aspect ratio differs from
+ * the scene's.
+ */
+void get_visible_scene_bounds(view_t view, vector_t *min, vector_t *max)
+{
+  vector_t half_size = vec_multiply(1 / view.scale, view.pixel_center);
+  *min = vec_subtract(view.center, half_size);
+  *max = vec_add(view.center, half_size);
+}
+
+/**
+ * Checks whether a bounding rectangle in scene coordinates overlaps the
+ * visible scene rectangle. Bounding rectangles are truncated to integers,
+ * so one extra unit is allowed on each side.
+ */
+bool is_visible(SDL_Rect *bounds, vector_t visible_min, vector_t visible_max)
+{
+  return bounds->x - 1 <= visible_max.x &&
+         bounds->x + bounds->w + 1 >= visible_min.x &&
+         bounds->y - 1 <= visible_max.y &&
+         bounds->y + bounds->h + 1 >= visible_min.y;
+}
+
+/**
+ * Gets the view that fits the scene in the window, recomputing it only
+ * after the window has been resized.
+ */
+view_t get_window_view(void)
+{
+  if (!window_view_valid)
+  {
+    vector_t window_center = get_window_center();
+    window_view = (view_t){.center = center,
+                           .pixel_center = window_center,
+                           .scale = get_scene_scale(window_center)};
+    window_view_valid = true;
+  }
+  return window_view;
+}
+
+/**
+ * Gets the bounding rectangle of a body record, truncated to integers
+ * like body_get_bounding_rect().
+ */
+SDL_Rect record_get_bounds(body_record_t *record)
+{
+  return (SDL_Rect){.x = record->min.x,
+                    .y = record->min.y,
+                    .w = record->max.x - record->min.x,
+                    .h = record->max.y - record->min.y};
+}
+
+/**
+ * Gets the outline to draw a body record's polygon with. A circle is
+ * tessellated into a scratch buffer, valid until the next call, with as
+ * many vertices as its radius in the view's pixels needs; other bodies
+ * are drawn with their own vertices.
+ */
+vector_t *record_get_outline(render_snapshot_t *snapshot,
+                             body_record_t *record, view_t view, size_t *count)
+{
+  if (record->circle_radius <= 0)
+  {
+    *count = record->vertex_count;
+    return render_snapshot_get_vertices(snapshot, record);
+  }
+  size_t n = sprite_circle_points_for_radius(record->circle_radius * view.scale);
+  polygon_vertices =
+      scratch_reserve(polygon_vertices, &polygon_vertex_capacity, n,
+                      POLYGON_INITIAL_VERTICES, sizeof(vector_t));
+  sprite_fill_circle(polygon_vertices, n, record->centroid,
+                     record->circle_radius, record->rotation);
+  *count = n;
+  return polygon_vertices;
+}
+
+/** Maps a rectangle in scene coordinates to a pixel rectangle in a view */
+SDL_Rect view_get_pixel_rect(view_t view, SDL_Rect *bounds)
+{
+  vector_t min = {.x = bounds->x, .y = bounds->y};
+  vector_t max = {.x = bounds->x + bounds->w, .y = bounds->y + bounds->h};
+  vector_t pixel_min = view_project(view, min);
+  vector_t pixel_max = view_project(view, max);
+  return (SDL_Rect){.x = fmin(pixel_min.x, pixel_max.x),
+                    .y = fmin(pixel_min.y, pixel_max.y),
+                    .w = fabs(pixel_max.x - pixel_min.x),
+                    .h = fabs(pixel_max.y - pixel_min.y)};
+}
+
+/** Frees a layer's texture and forgets its bodies */
+void static_layer_reset(static_layer_t *layer)
 {
-  // Scale scene coordinates by the scaling factor
-  // and map the center of the scene to the center of the window
-  vector_t scene_center_offset = vec_subtract(scene_pos, center);
-  double scale = get_scene_scale(window_center);
-  vector_t pixel_center_offset = vec_multiply(scale, scene_center_offset);
-  vector_t pixel = {.x = round(window_center.x + pixel_center_offset.x),
-                    // Flip y axis since positive y is down on the screen
-                    .y = round(window_center.y - pixel_center_offset.y)};
-  return pixel;
+  if (layer->texture != NULL)
+  {
+    SDL_DestroyTexture(layer->texture);
+  }
+  *layer = (static_layer_t){0};
 }
 
 /**
@@ -127,233 +556,1708 @@ char get_keycode(SDL_Keycode key)
   }
 }
 
-void sdl_init(vector_t min, vector_t max)
+void window_open(void)
 {
-  // Check parameters
-  assert(min.x < max.x);
-  assert(min.y < max.y);
-  center = vec_multiply(0.5, vec_add(min, max));
-  max_diff = vec_subtract(max, center);
   SDL_Init(SDL_INIT_EVERYTHING);
   window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
                             SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
                             SDL_WINDOW_RESIZABLE);
   renderer = SDL_CreateRenderer(window, -1, 0);
   SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
-  IMG_Init(IMG_INIT_PNG);
 }
 
-bool sdl_is_done()
+void window_close(void)
 {
-  SDL_Event *event = malloc(sizeof(*event));
-  assert(event != NULL);
-  while (SDL_PollEvent(event))
-  {
-    switch (event->type)
-    {
-    case SDL_QUIT:
-      free(event);
-      return true;
-    case SDL_KEYDOWN:
-    case SDL_KEYUP:
-      // Skip the keypress if no handler is configured
-      // or an unrecognized key was pressed
-      if (key_handler == NULL)
-        break;
-      char key = get_keycode(event->key.keysym.sym);
-      if (key == '\0')
-        break;
-
-      uint32_t timestamp = event->key.timestamp;
-      if (!event->key.repeat)
-      {
-        key_start_timestamp = timestamp;
-      }
-      key_event_type_t type =
-          event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
-      double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
-      key_handler(key, type, held_time, event_args);
-      break;
-    }
-  }
-  free(event);
-  return false;
+  SDL_DestroyRenderer(renderer);
+  SDL_DestroyWindow(window);
+  renderer = NULL;
+  window = NULL;
 }
 
-void sdl_clear(void)
+void window_get_size(int *width, int *height)
 {
-  SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-  SDL_RenderClear(renderer);
+  SDL_GetWindowSize(window, width, height);
 }
 
-void sdl_draw_polygon(list_t *points, rgb_color_t color)
+void software_open(void)
 {
-  // Check parameters
-  size_t n = list_size(points);
-  assert(n >= 3);
-  assert(0 <= color.r && color.r <= 1);
-  assert(0 <= color.g && color.g <= 1);
-  assert(0 <= color.b && color.b <= 1);
+  // Events are still polled, for SDL_QUIT and keys sent by the harness
+  SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER);
+  software_surface = SDL_CreateRGBSurfaceWithFormat(
+      0, WINDOW_WIDTH, WINDOW_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32);
+  assert(software_surface != NULL);
+  renderer = SDL_CreateSoftwareRenderer(software_surface);
+  assert(renderer != NULL);
+}
 
-  vector_t window_center = get_window_center();
+void software_close(void)
+{
+  SDL_DestroyRenderer(renderer);
+  SDL_FreeSurface(software_surface);
+  renderer = NULL;
+  software_surface = NULL;
+}
 
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
-  for (size_t i = 0; i < n; i++)
-  {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
-  }
+void software_get_size(int *width, int *height)
+{
+  *width = software_surface->w;
+  *height = software_surface->h;
+}
 
-  // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
-                    color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
+void null_open(void) { SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER); }
+
+void null_close(void) {}
+
+void null_get_size(int *width, int *height)
+{
+  *width = WINDOW_WIDTH;
+  *height = WINDOW_HEIGHT;
 }
 
-void sdl_show(void)
+const backend_ops_t BACKENDS[] = {
+    [BACKEND_WINDOW] = {.open = window_open,
+                        .close = window_close,
+                        .get_size = window_get_size},
+    [BACKEND_SOFTWARE] = {.open = software_open,
+                          .close = software_close,
+                          .get_size = software_get_size},
+    [BACKEND_NULL] = {.open = null_open,
+                      .close = null_close,
+                      .get_size = null_get_size},
+};
+
+/** Writes the frames kept so far to the CSV file */
+void stats_csv_flush(void)
 {
-  // Draw boundary lines
-  vector_t window_center = get_window_center();
-  vector_t max = vec_add(center, max_diff),
-           min = vec_subtract(center, max_diff);
-  vector_t max_pixel = get_window_position(max, window_center),
-           min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
-  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  for (size_t i = 0; i < stats_history_count; i++)
+  {
+    render_stats_t *stats = &stats_history[i];
+    fprintf(stats_csv_file,
+            "%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%zu,%d",
+            stats_csv_rows++, stats->draw_calls, stats->bodies_drawn,
+            stats->culled_bodies, stats->polygons_drawn,
+            stats->vertices_drawn, stats->particles_drawn,
+            stats->texture_switches, stats->static_layer_redraws,
+            stats->textures_created, stats->text_rasterizations,
+            stats->allocations, stats->idle);
+    for (size_t phase = 0; phase < RENDER_PHASE_COUNT; phase++)
+    {
+      fprintf(stats_csv_file, ",%.3f", stats->phase_ms[phase]);
+    }
+    fputc('\n', stats_csv_file);
+  }
+  stats_history_count = 0;
+}
 
-  SDL_RenderPresent(renderer);
+/** Writes the last frames to the CSV file, if one is open, and closes it */
+void stats_csv_close(void)
+{
+  if (stats_csv_file == NULL)
+  {
+    return;
+  }
+  stats_csv_flush();
+  fclose(stats_csv_file);
+  stats_csv_file = NULL;
+  free(stats_history);
+  stats_history = NULL;
 }
 
-void sdl_draw_img(char *texture_path, SDL_Rect *bounds, double rotation)
+/** Starts a CSV file of every frame's statistics, with its header row */
+void stats_csv_open(const char *path)
 {
-  SDL_Surface *image = IMG_Load(texture_path);
-  SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, image);
-  SDL_RenderCopyEx(renderer, texture, NULL, bounds, rotation, NULL,
-                   SDL_FLIP_NONE);
-  free(bounds);
-  SDL_DestroyTexture(texture);
-  SDL_FreeSurface(image);
+  // sdl_init() may run again without sdl_quit()
+  stats_csv_close();
+  stats_csv_file = fopen(path, "w");
+  if (stats_csv_file == NULL)
+  {
+    fprintf(stderr, "sdl_wrapper: could not write %s\n", path);
+    return;
+  }
+  fprintf(stats_csv_file,
+          "frame,draw_calls,bodies_drawn,culled_bodies,polygons_drawn,"
+          "vertices_drawn,particles_drawn,texture_switches,"
+          "static_layer_redraws,textures_created,text_rasterizations,"
+          "allocations,idle");
+  for (size_t phase = 0; phase < RENDER_PHASE_COUNT; phase++)
+  {
+    fprintf(stats_csv_file, ",%s_ms", RENDER_PHASE_NAMES[phase]);
+  }
+  fputc('\n', stats_csv_file);
+  stats_history = malloc(STATS_HISTORY_FRAMES * sizeof(render_stats_t));
+  assert(stats_history != NULL);
+  stats_history_count = 0;
+  stats_csv_rows = 0;
 }
 
-SDL_Rect *transform_bounds_to_screen(SDL_Rect *bounds)
+void sdl_init_with_backend(vector_t min, vector_t max,
+                           render_backend_t backend_type)
 {
-  vector_t min = {.x = bounds->x, .y = bounds->y};
-  vector_t max = {.x = bounds->x + bounds->w, .y = bounds->y + bounds->h};
-  vector_t window_center = get_window_center();
-  vector_t screen_min = get_window_position(min, window_center);
-  vector_t screen_max = get_window_position(max, window_center);
+  // Check parameters
+  assert(min.x < max.x);
+  assert(min.y < max.y);
+  center = vec_multiply(0.5, vec_add(min, max));
+  max_diff = vec_subtract(max, center);
+  window_view_valid = false;
+  frame_dirty = true;
+  backend = &BACKENDS[backend_type];
+  backend->open();
 
-  double x = fmin(screen_min.x, screen_max.x);
-  double y = fmin(screen_min.y, screen_max.y);
-  double w = fabs(screen_max.x - screen_min.x);
-  double h = fabs(screen_max.y - screen_min.y);
+  char *max_frames_env = getenv("SDL_WRAPPER_MAX_FRAMES");
+  max_frames = max_frames_env != NULL ? strtoul(max_frames_env, NULL, 10) : 0;
+  char *stats_csv_env = getenv("SDL_WRAPPER_STATS_CSV");
+  if (stats_csv_env != NULL && stats_csv_env[0] != '\0')
+  {
+    stats_csv_open(stats_csv_env);
+  }
 
-  SDL_Rect *rect = malloc(sizeof(SDL_Rect));
-  *rect = (SDL_Rect){.x = x, .y = y, .w = w, .h = h};
-  return rect;
+  if (renderer == NULL)
+  {
+    // Nothing is drawn, so there is nothing to load images or fonts for
+    return;
+  }
+  IMG_Init(IMG_INIT_PNG);
+  textures = texture_cache_init(renderer);
+  fonts = font_cache_init(renderer);
+  text_textures = text_cache_init(renderer);
 }
 
-void sdl_create_words_numbers(text_t *text)
+void sdl_init(vector_t min, vector_t max)
 {
-  TTF_Font *font = font = TTF_OpenFont("CourierPrime-Regular.ttf", 100);
-  SDL_Color color = {255, 255, 255};
-  char score_print[500];
-  if (text_get_numbers(text) > -1)
+  render_backend_t backend_type = BACKEND_WINDOW;
+  char *backend_env = getenv("SDL_WRAPPER_BACKEND");
+  if (backend_env != NULL && strcmp(backend_env, "software") == 0)
+  {
+    backend_type = BACKEND_SOFTWARE;
+  }
+  else if (backend_env != NULL && strcmp(backend_env, "null") == 0)
   {
-    sprintf(score_print, "%s%d", text_get_words(text),
-            (int)text_get_numbers(text));
+    backend_type = BACKEND_NULL;
   }
-  else
+  else if (backend_env != NULL && strcmp(backend_env, "window") != 0)
   {
-    sprintf(score_print, "%s", text_get_words(text));
+    fprintf(stderr, "sdl_wrapper: unknown SDL_WRAPPER_BACKEND %s\n",
+            backend_env);
   }
-  SDL_Surface *surface = TTF_RenderUTF8_Blended(font, score_print, color);
-  SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-  SDL_Rect *boundary = malloc(sizeof(SDL_Rect));
-  boundary->w = text_get_text_dimensions(text).x;
-  boundary->h = text_get_text_dimensions(text).y;
-  boundary->x = text_get_text_position(text).x;
-  boundary->y = text_get_text_position(text).y;
-  SDL_Rect *screen_bounds = transform_bounds_to_screen(boundary);
-  SDL_RenderCopy(renderer, texture, NULL, screen_bounds);
-  SDL_DestroyTexture(texture);
-  SDL_FreeSurface(surface);
-  free(boundary);
-  free(screen_bounds);
-  TTF_CloseFont(font);
+  sdl_init_with_backend(min, max, backend_type);
 }
 
-void sdl_render_scene(scene_t *scene)
-{
-  sdl_clear();
-  size_t body_count = scene_bodies(scene);
+SDL_Surface *sdl_get_surface(void) { return software_surface; }
 
-  for (size_t i = 0; i < body_count; i++)
+void sdl_quit(void)
+{
+  stats_csv_close();
+  if (textures != NULL)
+  {
+    texture_cache_free(textures);
+    textures = NULL;
+  }
+  if (text_textures != NULL)
+  {
+    text_cache_free(text_textures);
+    text_textures = NULL;
+  }
+  if (fonts != NULL)
+  {
+    font_cache_free(fonts);
+    fonts = NULL;
+  }
+  if (image_atlas != NULL)
+  {
+    texture_atlas_free(image_atlas);
+    image_atlas = NULL;
+  }
+  pending_atlas_free();
+  if (asset_loader != NULL)
+  {
+    asset_loader_free(asset_loader);
+    asset_loader = NULL;
+  }
+  if (asset_manifest != NULL)
+  {
+    asset_manifest_free(asset_manifest);
+    asset_manifest = NULL;
+  }
+  if (asset_bundle != NULL)
+  {
+    asset_bundle_close(asset_bundle);
+    asset_bundle = NULL;
+  }
+  free(batch_vertices);
+  free(batch_indices);
+  batch_vertices = NULL;
+  batch_indices = NULL;
+  batch_vertex_capacity = batch_index_capacity = 0;
+  free(polygon_vertices);
+  free(polygon_pixels);
+  polygon_vertices = NULL;
+  polygon_pixels = NULL;
+  polygon_vertex_capacity = polygon_pixel_capacity = 0;
+  free(queue_items);
+  free(queue_sorted);
+  queue_items = NULL;
+  queue_sorted = NULL;
+  queue_item_capacity = queue_sorted_capacity = 0;
+  for (size_t i = 0; i < STATIC_LAYER_COUNT; i++)
+  {
+    static_layer_reset(&static_layers[i]);
+  }
+  if (scene_snapshot != NULL)
+  {
+    render_snapshot_free(scene_snapshot);
+    scene_snapshot = NULL;
+  }
+  if (tick_clock != NULL)
   {
-    body_t *body = scene_get_body(scene, i);
-    char *texture_path = body_get_texture_path(body);
+    frame_clock_free(tick_clock);
+    tick_clock = NULL;
+  }
+  backend->close();
+  IMG_Quit();
+  SDL_Quit();
+}
 
-    if (texture_path)
+/**
+ * Handles one event, calling the key handler for key events.
+ * Returns whether the event closes the window.
+ */
+bool handle_event(SDL_Event *event)
+{
+  handled_events++;
+  switch (event->type)
+  {
+  case SDL_QUIT:
+    return true;
+  case SDL_WINDOWEVENT:
+    if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
     {
-      SDL_Rect *bounds = body_get_bounding_rect(body);
-      SDL_Rect *screen_bounds = transform_bounds_to_screen(bounds);
-      free(bounds);
-
-      double rotation_radians = body_get_rotation(body);
-      // Must be converted to clockwise, in degrees
-      double rotation = -180 * rotation_radians / M_PI;
-      sdl_draw_img(texture_path, screen_bounds, rotation);
+      window_view_valid = false;
+      frame_dirty = true;
     }
-    else
+    else if (event->window.event == SDL_WINDOWEVENT_EXPOSED)
     {
-      list_t *shape = body_get_shape(body);
-      sdl_draw_polygon(shape, body_get_color(body));
-      list_free(shape);
+      // The window's contents may have been lost while it was covered
+      frame_dirty = true;
     }
-  }
-
-  size_t text_count = scene_text(scene);
-  for (size_t i = 0; i < text_count; i++)
-  {
-    text_t *text = scene_get_text(scene, i);
-    if (*(enum text_type_t *)text_get_type(text) == WORDS_STAY)
+    break;
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    if (event->key.keysym.sym == SDLK_F3)
     {
-      sdl_create_words_numbers(text);
+      // The overlay's key is not passed to the key handler
+      if (event->type == SDL_KEYDOWN && !event->key.repeat)
+      {
+        stats_overlay = !stats_overlay;
+        frame_dirty = true;
+      }
+      break;
     }
-    if (*(enum text_type_t *)text_get_type(text) == WORDS_POWERUP)
+    // Skip the keypress if no handler is configured
+    // or an unrecognized key was pressed
+    if (key_handler == NULL)
+      break;
+    char key = get_keycode(event->key.keysym.sym);
+    if (key == '\0')
+      break;
+
+    uint32_t timestamp = event->key.timestamp;
+    if (!event->key.repeat)
     {
-      sdl_create_words_numbers(text);
+      key_start_timestamp = timestamp;
     }
+    key_event_type_t type =
+        event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
+    double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
+    key_handler(key, type, held_time, event_args);
+    break;
   }
-
-  sdl_show();
+  return false;
 }
 
-void sdl_on_key(key_handler_t handler) { key_handler = handler; }
-
-void sdl_event_args(void *args) { event_args = args; }
+bool sdl_is_done()
+{
+  if (max_frames > 0 && frames_shown >= max_frames)
+  {
+    return true;
+  }
+  SDL_Event event;
+  while (SDL_PollEvent(&event))
+  {
+    if (handle_event(&event))
+    {
+      return true;
+    }
+  }
+  return false;
+}
 
-double time_since_last_tick(void)
+bool sdl_is_done_wait(double timeout)
+{
+  if (max_frames > 0 && frames_shown >= max_frames)
+  {
+    return true;
+  }
+  SDL_Event event;
+  if (SDL_WaitEventTimeout(&event, timeout * MS_PER_S) &&
+      handle_event(&event))
+  {
+    return true;
+  }
+  // Handle any other events that arrived with the first one
+  return sdl_is_done();
+}
+
+/** Counts the textures the caches have created since sdl_init() */
+size_t caches_get_uploads(void)
+{
+  size_t uploads = 0;
+  if (textures != NULL)
+  {
+    uploads += texture_cache_uploads(textures);
+  }
+  if (fonts != NULL)
+  {
+    uploads += font_cache_uploads(fonts);
+  }
+  if (text_textures != NULL)
+  {
+    uploads += text_cache_uploads(text_textures);
+  }
+  return uploads;
+}
+
+/** Counts the texts drawn into their textures since sdl_init() */
+size_t caches_get_rasterizations(void)
+{
+  return text_textures != NULL ? text_cache_rasterizations(text_textures) : 0;
+}
+
+/**
+ * Keeps a frame's statistics to be written to the CSV file,
+ * writing the frames kept so far once the buffer is full.
+ */
+void stats_history_add(render_stats_t *stats)
+{
+  if (stats_history_count == STATS_HISTORY_FRAMES)
+  {
+    stats_csv_flush();
+  }
+  stats_history[stats_history_count++] = *stats;
+}
+
+/** Starts counting a new frame's statistics, unless a frame is open */
+void frame_begin(void)
+{
+  if (!frame_open)
+  {
+    frame_stats = (render_stats_t){0};
+    frame_start_uploads = caches_get_uploads();
+    frame_start_rasterizations = caches_get_rasterizations();
+    frame_open = true;
+  }
+}
+
+/** Finishes counting the open frame's statistics */
+void frame_end(void)
+{
+  if (frame_open)
+  {
+    frame_stats.textures_created += caches_get_uploads() - frame_start_uploads;
+    frame_stats.text_rasterizations +=
+        caches_get_rasterizations() - frame_start_rasterizations;
+    last_frame_stats = frame_stats;
+    frame_open = false;
+    frames_shown++;
+    if (stats_csv_file != NULL)
+    {
+      stats_history_add(&last_frame_stats);
+    }
+  }
+}
+
+/**
+ * Adds the wall time since a phase started to the frame's statistics.
+ * Returns the time now, when the next phase starts.
+ */
+double phase_end(render_phase_t phase, double start)
+{
+  double now = frame_clock_now();
+  frame_stats.phase_ms[phase] += (now - start) * MS_PER_S;
+  return now;
+}
+
+void sdl_clear(void)
+{
+  frame_begin();
+  // Whatever is drawn until the next sdl_show() is not a snapshot
+  frame_dirty = true;
+  if (renderer != NULL)
+  {
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderClear(renderer);
+  }
+}
+
+/** Draws a polygon, mapping its vertices to pixels with a view */
+void draw_polygon_in_view(view_t view, const vector_t *vertices, size_t n,
+                          rgb_color_t color)
+{
+  // Check parameters
+  assert(n >= 3);
+  assert(0 <= color.r && color.r <= 1);
+  assert(0 <= color.g && color.g <= 1);
+  assert(0 <= color.b && color.b <= 1);
+  frame_stats.polygons_drawn++;
+  frame_stats.vertices_drawn += n;
+  if (renderer == NULL)
+  {
+    // The null backend only counts the draw call
+    frame_stats.draw_calls++;
+    return;
+  }
+
+  // Convert each vertex to a point on screen
+  polygon_pixels =
+      scratch_reserve(polygon_pixels, &polygon_pixel_capacity, 2 * n,
+                      2 * POLYGON_INITIAL_VERTICES, sizeof(int16_t));
+  int16_t *polygon_x = polygon_pixels, *polygon_y = polygon_pixels + n;
+  view_project_pixels(view, vertices, n, polygon_x, polygon_y);
+
+  // Draw polygon with the given color
+  filledPolygonRGBA(renderer, polygon_x, polygon_y, n, color.r * 255,
+                    color.g * 255, color.b * 255, 255);
+  frame_stats.draw_calls++;
+}
+
+void sdl_draw_polygon(list_t *points, rgb_color_t color)
+{
+  size_t n = list_size(points);
+  polygon_vertices =
+      scratch_reserve(polygon_vertices, &polygon_vertex_capacity, n,
+                      POLYGON_INITIAL_VERTICES, sizeof(vector_t));
+  for (size_t i = 0; i < n; i++)
+  {
+    polygon_vertices[i] = *(vector_t *)list_get(points, i);
+  }
+  draw_polygon_in_view(get_window_view(), polygon_vertices, n, color);
+}
+
+void sdl_draw_polygon_view(polygon_view_t polygon, rgb_color_t color)
+{
+  draw_polygon_in_view(get_window_view(), polygon.vertices, polygon.count,
+                       color);
+}
+
+/**
+ * Draws the statistics of the last frame shown in the top left corner.
+ * The overlay's own drawing is not counted in any frame's statistics.
+ */
+void stats_overlay_draw(void)
+{
+  if (fonts == NULL || (asset_loader != NULL &&
+                        asset_loader_pending(asset_loader, TEXT_FONT_FILE)))
+  {
+    return;
+  }
+  glyph_atlas_t *atlas = font_cache_get(fonts, TEXT_FONT_FILE, TEXT_FONT_SIZE);
+  if (atlas == NULL)
+  {
+    return;
+  }
+  render_stats_t *stats = &last_frame_stats;
+  char lines[STATS_OVERLAY_MAX_LINES][STATS_OVERLAY_LINE_LENGTH];
+  size_t count = 0;
+  snprintf(lines[count++], STATS_OVERLAY_LINE_LENGTH,
+           "draw calls %zu, texture switches %zu", stats->draw_calls,
+           stats->texture_switches);
+  snprintf(lines[count++], STATS_OVERLAY_LINE_LENGTH,
+           "bodies %zu, culled %zu, particles %zu", stats->bodies_drawn,
+           stats->culled_bodies, stats->particles_drawn);
+  snprintf(lines[count++], STATS_OVERLAY_LINE_LENGTH,
+           "polygons %zu, vertices %zu", stats->polygons_drawn,
+           stats->vertices_drawn);
+  snprintf(lines[count++], STATS_OVERLAY_LINE_LENGTH,
+           "textures created %zu, texts drawn %zu", stats->textures_created,
+           stats->text_rasterizations);
+  snprintf(lines[count++], STATS_OVERLAY_LINE_LENGTH,
+           "static redraws %zu, allocations %zu%s",
+           stats->static_layer_redraws, stats->allocations,
+           stats->idle ? ", idle" : "");
+  double total_ms = 0;
+  for (size_t phase = 0; phase < RENDER_PHASE_COUNT; phase++)
+  {
+    snprintf(lines[count++], STATS_OVERLAY_LINE_LENGTH, "%s %.2f ms",
+             RENDER_PHASE_NAMES[phase], stats->phase_ms[phase]);
+    total_ms += stats->phase_ms[phase];
+  }
+  snprintf(lines[count++], STATS_OVERLAY_LINE_LENGTH, "total %.2f ms",
+           total_ms);
+
+  int line_height = glyph_atlas_measure(atlas, " ").y * STATS_OVERLAY_SCALE;
+  int width = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    int line_width =
+        glyph_atlas_measure(atlas, lines[i]).x * STATS_OVERLAY_SCALE;
+    width = line_width > width ? line_width : width;
+  }
+  SDL_Rect background = {.x = 0,
+                         .y = 0,
+                         .w = width + 2 * STATS_OVERLAY_MARGIN,
+                         .h = count * line_height + 2 * STATS_OVERLAY_MARGIN};
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
+  SDL_RenderFillRect(renderer, &background);
+  SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+  for (size_t i = 0; i < count; i++)
+  {
+    SDL_Point size = glyph_atlas_measure(atlas, lines[i]);
+    SDL_Rect bounds = {.x = STATS_OVERLAY_MARGIN,
+                       .y = STATS_OVERLAY_MARGIN + i * line_height,
+                       .w = size.x * STATS_OVERLAY_SCALE,
+                       .h = line_height};
+    glyph_atlas_draw(atlas, renderer, lines[i], bounds);
+  }
+}
+
+void sdl_show(void)
+{
+  double start = frame_clock_now();
+  if (renderer != NULL)
+  {
+    // Draw boundary lines
+    view_t view = get_window_view();
+    vector_t max = vec_add(center, max_diff),
+             min = vec_subtract(center, max_diff);
+    vector_t max_pixel = view_project(view, max),
+             min_pixel = view_project(view, min);
+    SDL_Rect boundary = {.x = min_pixel.x,
+                         .y = max_pixel.y,
+                         .w = max_pixel.x - min_pixel.x,
+                         .h = min_pixel.y - max_pixel.y};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderDrawRect(renderer, &boundary);
+
+    if (stats_overlay)
+    {
+      stats_overlay_draw();
+    }
+    SDL_RenderPresent(renderer);
+  }
+  phase_end(RENDER_PHASE_PRESENT, start);
+  frame_end();
+}
+
+void sdl_draw_img(char *texture_path, SDL_Rect bounds, double rotation)
+{
+  SDL_Texture *texture =
+      textures != NULL ? texture_cache_get(textures, texture_path) : NULL;
+  if (renderer == NULL)
+  {
+    frame_stats.draw_calls++;
+  }
+  else if (texture != NULL)
+  {
+    SDL_RenderCopyEx(renderer, texture, NULL, &bounds, rotation, NULL,
+                     SDL_FLIP_NONE);
+    frame_stats.draw_calls++;
+  }
+}
+
+/** Gets the image for a texture path, from the atlas if it is packed there */
+body_image_t get_path_image(const char *texture_path)
+{
+  if (textures == NULL)
+  {
+    // The null backend loads no images
+    return (body_image_t){.texture = NULL};
+  }
+  if (asset_loader != NULL &&
+      (asset_loader_pending(asset_loader, texture_path) ||
+       pending_atlas_find(texture_path) != TEXTURE_ATLAS_NOT_FOUND))
+  {
+    // Not drawn until the loader has decoded it, rather than loaded here
+    return (body_image_t){.texture = NULL};
+  }
+  if (image_atlas != NULL)
+  {
+    size_t index = texture_atlas_find(image_atlas, texture_path);
+    if (index != TEXTURE_ATLAS_NOT_FOUND)
+    {
+      return (body_image_t){
+          .texture = texture_atlas_get_texture(image_atlas),
+          .source = texture_atlas_get_source(image_atlas, index),
+          .texture_size = texture_atlas_get_size(image_atlas)};
+    }
+  }
+  body_image_t image = {.texture = texture_cache_get(textures, texture_path)};
+  if (image.texture != NULL)
+  {
+    SDL_QueryTexture(image.texture, NULL, NULL, &image.texture_size.x,
+                     &image.texture_size.y);
+    image.source = (SDL_Rect){
+        .x = 0, .y = 0, .w = image.texture_size.x, .h = image.texture_size.y};
+  }
+  return image;
+}
+
+/**
+ * Finds the image to draw a body with, if it has a texture or animation.
+ * Animated bodies were reduced to the path of their frame when captured.
+ */
+bool get_body_image(body_record_t *record, body_image_t *image)
+{
+  if (record->texture_path == NULL)
+  {
+    return false;
+  }
+  *image = get_path_image(record->texture_path);
+  return true;
+}
+
+/** Draws a body's image into a rectangle, rotated clockwise in degrees */
+void draw_body_image(body_image_t *image, SDL_Rect *bounds, double rotation)
+{
+  if (renderer == NULL)
+  {
+    frame_stats.draw_calls++;
+  }
+  else if (image->texture != NULL)
+  {
+    SDL_RenderCopyEx(renderer, image->texture, &image->source, bounds,
+                     rotation, NULL, SDL_FLIP_NONE);
+    frame_stats.draw_calls++;
+  }
+}
+
+/** Makes room in the batch for the given number of vertices and indices */
+void batch_reserve(size_t vertices, size_t indices)
+{
+  // The batch keeps its contents when it grows, so it is reallocated
+  // rather than reserved like the other scratch buffers
+  if (batch_vertex_count + vertices > batch_vertex_capacity)
+  {
+    size_t capacity = batch_vertex_capacity ? batch_vertex_capacity
+                                            : BATCH_INITIAL_VERTICES;
+    while (capacity < batch_vertex_count + vertices)
+    {
+      capacity *= 2;
+    }
+    batch_vertices = realloc(batch_vertices, capacity * sizeof(SDL_Vertex));
+    assert(batch_vertices != NULL);
+    batch_vertex_capacity = capacity;
+    frame_stats.allocations++;
+  }
+  if (batch_index_count + indices > batch_index_capacity)
+  {
+    size_t capacity = batch_index_capacity ? batch_index_capacity
+                                           : 3 * BATCH_INITIAL_VERTICES;
+    while (capacity < batch_index_count + indices)
+    {
+      capacity *= 2;
+    }
+    batch_indices = realloc(batch_indices, capacity * sizeof(int));
+    assert(batch_indices != NULL);
+    batch_index_capacity = capacity;
+    frame_stats.allocations++;
+  }
+}
+
+/** Submits everything in the batch with a single draw call */
+void batch_flush(void)
+{
+  if (batch_index_count > 0)
+  {
+    if (renderer != NULL)
+    {
+      SDL_RenderGeometry(renderer, batch_texture, batch_vertices,
+                         batch_vertex_count, batch_indices, batch_index_count);
+    }
+    frame_stats.draw_calls++;
+  }
+  batch_vertex_count = 0;
+  batch_index_count = 0;
+}
+
+/** Flushes the batch if the next geometry needs a different texture */
+void batch_use_texture(SDL_Texture *texture)
+{
+  if (texture != batch_texture)
+  {
+    batch_flush();
+    batch_texture = texture;
+  }
+}
+
+/**
+ * Adds a polygon to the batch as a fan of triangles around the average of
+ * its vertices. This handles the convex and star-shaped polygons that
+ * sprite.c makes, which a fan around the first vertex would not.
+ */
+void batch_add_polygon(vector_t *vertices, size_t n, rgb_color_t color)
+{
+  assert(n >= 3);
+  batch_use_texture(NULL);
+  batch_reserve(n + 1, 3 * n);
+  frame_stats.polygons_drawn++;
+  frame_stats.vertices_drawn += n;
+
+  SDL_Color vertex_color = {color.r * 255, color.g * 255, color.b * 255, 255};
+  size_t center_idx = batch_vertex_count++;
+  SDL_Vertex *outline = &batch_vertices[batch_vertex_count];
+  view_project_floats(get_window_view(), vertices, n, &outline[0].position.x,
+                      sizeof(SDL_Vertex));
+  batch_vertex_count += n;
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < n; i++)
+  {
+    outline[i].color = vertex_color;
+    outline[i].tex_coord = (SDL_FPoint){.x = 0, .y = 0};
+    sum.x += outline[i].position.x;
+    sum.y += outline[i].position.y;
+  }
+  batch_vertices[center_idx] = (SDL_Vertex){
+      .position = {.x = sum.x / n, .y = sum.y / n}, .color = vertex_color};
+
+  for (size_t i = 0; i < n; i++)
+  {
+    batch_indices[batch_index_count++] = center_idx;
+    batch_indices[batch_index_count++] = center_idx + 1 + i;
+    batch_indices[batch_index_count++] = center_idx + 1 + (i + 1) % n;
+  }
+}
+
+/**
+ * Adds the particles of a field that are on screen to the batch, each as a
+ * diamond of two triangles. In RENDER_IMMEDIATE mode the batch is drawn
+ * right away, so a field of any size costs one draw call.
+ */
+void batch_add_particle_field(render_snapshot_t *snapshot,
+                              particle_field_record_t *record, view_t view,
+                              vector_t visible_min, vector_t visible_max)
+{
+  particle_t *particles = render_snapshot_get_particles(snapshot, record);
+  size_t n = record->particle_count;
+  batch_use_texture(NULL);
+  batch_reserve(4 * n, 6 * n);
+  // Cull against the visible rectangle in the field's own coordinates
+  vector_t min = vec_subtract(visible_min, record->origin),
+           max = vec_subtract(visible_max, record->origin);
+  for (size_t i = 0; i < n; i++)
+  {
+    particle_t *particle = &particles[i];
+    vector_t position = particle->position;
+    if (position.x + particle->size < min.x ||
+        position.x - particle->size > max.x ||
+        position.y + particle->size < min.y ||
+        position.y - particle->size > max.y)
+    {
+      continue;
+    }
+    vector_t pixel = view_project(view, vec_add(record->origin, position));
+    float x = pixel.x, y = pixel.y, radius = particle->size * view.scale;
+    rgb_color_t color = particle->color;
+    SDL_Color vertex_color = {color.r * 255, color.g * 255, color.b * 255,
+                              255};
+    SDL_FPoint corners[4] = {
+        {x + radius, y}, {x, y - radius}, {x - radius, y}, {x, y + radius}};
+    size_t base = batch_vertex_count;
+    for (size_t corner = 0; corner < 4; corner++)
+    {
+      batch_vertices[batch_vertex_count++] =
+          (SDL_Vertex){.position = corners[corner], .color = vertex_color};
+    }
+    int *indices = &batch_indices[batch_index_count];
+    indices[0] = base;
+    indices[1] = base + 1;
+    indices[2] = base + 2;
+    indices[3] = base;
+    indices[4] = base + 2;
+    indices[5] = base + 3;
+    batch_index_count += 6;
+    frame_stats.particles_drawn++;
+  }
+  if (render_mode == RENDER_IMMEDIATE)
+  {
+    batch_flush();
+  }
+}
+
+/**
+ * Adds a textured quad to the batch, rotated clockwise by the given number
+ * of degrees about its center (matching SDL_RenderCopyEx()).
+ */
+void batch_add_image(body_image_t *image, SDL_Rect bounds, double rotation)
+{
+  // Corners of the unit square, clockwise on screen
+  const float corner_u[] = {0, 1, 1, 0}, corner_v[] = {0, 0, 1, 1};
+  batch_use_texture(image->texture);
+  batch_reserve(4, 6);
+
+  // Map the unit square to the image's source rectangle in the texture
+  float u_min = (float)image->source.x / image->texture_size.x,
+        v_min = (float)image->source.y / image->texture_size.y,
+        u_size = (float)image->source.w / image->texture_size.x,
+        v_size = (float)image->source.h / image->texture_size.y;
+
+  double radians = rotation * M_PI / 180;
+  double c = cos(radians), s = sin(radians);
+  double center_x = bounds.x + bounds.w / 2.0,
+         center_y = bounds.y + bounds.h / 2.0;
+  size_t base = batch_vertex_count;
+  for (size_t i = 0; i < 4; i++)
+  {
+    double dx = (corner_u[i] - 0.5) * bounds.w,
+           dy = (corner_v[i] - 0.5) * bounds.h;
+    batch_vertices[batch_vertex_count++] = (SDL_Vertex){
+        .position = {.x = center_x + dx * c - dy * s,
+                     .y = center_y + dx * s + dy * c},
+        .color = {255, 255, 255, 255},
+        .tex_coord = {.x = u_min + corner_u[i] * u_size,
+                      .y = v_min + corner_v[i] * v_size}};
+  }
+  const int quad[] = {0, 1, 2, 0, 2, 3};
+  for (size_t i = 0; i < 6; i++)
+  {
+    batch_indices[batch_index_count++] = base + quad[i];
+  }
+}
+
+void sdl_load_texture_atlas(char **texture_paths, size_t count)
+{
+  assert(image_atlas == NULL && pending_atlas_count == 0);
+  if (renderer != NULL && asset_loader != NULL)
+  {
+    // The loader's surfaces are packed once it has decoded them all;
+    // images it does not load are loaded now
+    pending_atlas_paths = malloc(sizeof(char *) * count);
+    pending_atlas_surfaces = malloc(sizeof(SDL_Surface *) * count);
+    assert(count == 0 || pending_atlas_paths != NULL);
+    assert(count == 0 || pending_atlas_surfaces != NULL);
+    for (size_t i = 0; i < count; i++)
+    {
+      pending_atlas_paths[i] = texture_paths[i];
+      pending_atlas_surfaces[i] = NULL;
+      if (asset_manifest_find(asset_manifest, texture_paths[i]) ==
+          ASSET_MANIFEST_NOT_FOUND)
+      {
+        pending_atlas_surfaces[i] = IMG_Load(texture_paths[i]);
+        if (pending_atlas_surfaces[i] == NULL)
+        {
+          fprintf(stderr, "sdl_wrapper: could not load %s: %s\n",
+                  texture_paths[i], SDL_GetError());
+        }
+      }
+    }
+    pending_atlas_count = count;
+  }
+  else if (renderer != NULL)
+  {
+    image_atlas = texture_atlas_init(renderer, texture_paths, count);
+    if (image_atlas != NULL)
+    {
+      frame_stats.textures_created++;
+    }
+  }
+  frame_dirty = true;
+}
+
+void sdl_load_assets(const char *manifest_path, const char *bundle_path,
+                     asset_progress_t progress, void *aux)
+{
+  assert(asset_manifest == NULL);
+  assert(image_atlas == NULL && pending_atlas_count == 0);
+  if (renderer == NULL)
+  {
+    // The null backend loads no images or fonts
+    return;
+  }
+  asset_manifest = asset_manifest_load(manifest_path);
+  if (asset_manifest == NULL)
+  {
+    fprintf(stderr, "sdl_wrapper: could not read asset manifest %s\n",
+            manifest_path);
+    return;
+  }
+  asset_progress = progress;
+  asset_progress_aux = aux;
+  if (bundle_path != NULL)
+  {
+    asset_bundle = asset_bundle_open(bundle_path);
+  }
+  asset_loader = asset_loader_start(asset_manifest, asset_bundle);
+  assets_uploaded = 0;
+  assets_total = asset_loader_total(asset_loader);
+}
+
+bool sdl_assets_loaded(void) { return asset_loader == NULL; }
+
+/**
+ * Uploads the assets decoded since the last frame, packs the atlas once
+ * all of its images are in, and frees the loader once it is done.
+ * Uploads must happen on the thread that owns the renderer.
+ */
+void assets_upload(void)
+{
+  if (asset_loader == NULL)
+  {
+    return;
+  }
+  loaded_asset_t asset;
+  while (asset_loader_poll(asset_loader, &asset))
+  {
+    asset_progress_changed = true;
+    if (asset.type == ASSET_FONT)
+    {
+      font_cache_add(fonts, asset.path, asset.point_size, asset.data,
+                     asset.size, !asset.borrowed);
+      continue;
+    }
+    size_t atlas_index = pending_atlas_find(asset.path);
+    if (atlas_index != TEXTURE_ATLAS_NOT_FOUND)
+    {
+      pending_atlas_surfaces[atlas_index] = asset.surface;
+      continue;
+    }
+    texture_cache_add(textures, asset.path, asset.surface);
+    if (asset.surface != NULL)
+    {
+      SDL_FreeSurface(asset.surface);
+    }
+  }
+
+  assets_uploaded = asset_loader_taken(asset_loader);
+
+  if (pending_atlas_count > 0)
+  {
+    bool decoded = true;
+    for (size_t i = 0; i < pending_atlas_count && decoded; i++)
+    {
+      decoded = !asset_loader_pending(asset_loader, pending_atlas_paths[i]);
+    }
+    if (decoded)
+    {
+      image_atlas = texture_atlas_pack(renderer, pending_atlas_paths,
+                                       pending_atlas_surfaces,
+                                       pending_atlas_count);
+      if (image_atlas != NULL)
+      {
+        frame_stats.textures_created++;
+      }
+      pending_atlas_free();
+    }
+  }
+  if (asset_progress_changed)
+  {
+    // Bodies that were waiting for their images can be drawn now
+    frame_dirty = true;
+  }
+  if (assets_uploaded == assets_total)
+  {
+    asset_loader_free(asset_loader);
+    asset_loader = NULL;
+  }
+}
+
+void sdl_evict_texture(const char *texture_path)
+{
+  if (textures != NULL)
+  {
+    texture_cache_evict(textures, texture_path);
+  }
+}
+
+void sdl_clear_textures(void)
+{
+  if (textures != NULL)
+  {
+    texture_cache_clear(textures);
+  }
+}
+
+SDL_Rect transform_bounds_to_screen(SDL_Rect bounds)
+{
+  return view_get_pixel_rect(get_window_view(), &bounds);
+}
+
+/**
+ * Draws a layer's bodies into its texture, covering the part of the layer
+ * within one window of the visible scene rectangle. Layers that span more
+ * than that (e.g. stars across a large arena) would need textures larger
+ * than most renderers allow, so they are redrawn if the camera moves far.
+ */
+void static_layer_draw(static_layer_t *layer, render_snapshot_t *snapshot,
+                       camera_mode_t camera_mode, vector_t anchor_centroid,
+                       view_t view, vector_t visible_min, vector_t visible_max)
+{
+  if (layer->texture != NULL)
+  {
+    SDL_DestroyTexture(layer->texture);
+    layer->texture = NULL;
+  }
+  layer->anchor_centroid = anchor_centroid;
+  layer->scale = view.scale;
+  layer->drawn = true;
+  frame_stats.static_layer_redraws++;
+
+  size_t body_count = render_snapshot_bodies(snapshot);
+  layer->bodies_min = (vector_t){.x = INFINITY, .y = INFINITY};
+  layer->bodies_max = (vector_t){.x = -INFINITY, .y = -INFINITY};
+  for (size_t i = 0; i < body_count; i++)
+  {
+    body_record_t *record = render_snapshot_get_body(snapshot, i);
+    if (record->static_background && record->camera_mode == camera_mode)
+    {
+      SDL_Rect bounds = record_get_bounds(record);
+      layer->bodies_min.x = fmin(layer->bodies_min.x, bounds.x);
+      layer->bodies_min.y = fmin(layer->bodies_min.y, bounds.y);
+      layer->bodies_max.x = fmax(layer->bodies_max.x, bounds.x + bounds.w);
+      layer->bodies_max.y = fmax(layer->bodies_max.y, bounds.y + bounds.h);
+    }
+  }
+
+  vector_t visible_size = vec_subtract(visible_max, visible_min);
+  vector_t range_min = vec_subtract(visible_min, visible_size),
+           range_max = vec_add(visible_max, visible_size);
+  layer->min = (vector_t){.x = fmax(layer->bodies_min.x, range_min.x),
+                          .y = fmax(layer->bodies_min.y, range_min.y)};
+  layer->max = (vector_t){.x = fmin(layer->bodies_max.x, range_max.x),
+                          .y = fmin(layer->bodies_max.y, range_max.y)};
+  int width = ceil((layer->max.x - layer->min.x) * view.scale),
+      height = ceil((layer->max.y - layer->min.y) * view.scale);
+  if (width <= 0 || height <= 0 || renderer == NULL)
+  {
+    return;
+  }
+  layer->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                     SDL_TEXTUREACCESS_TARGET, width, height);
+  if (layer->texture == NULL)
+  {
+    layer->drawn = false;
+    return;
+  }
+  SDL_SetTextureBlendMode(layer->texture, SDL_BLENDMODE_BLEND);
+  frame_stats.textures_created++;
+
+  // Map the top left corner of the layer to the top left of the texture
+  view_t layer_view = {.center = {.x = layer->min.x, .y = layer->max.y},
+                       .pixel_center = VEC_ZERO,
+                       .scale = view.scale};
+  SDL_Texture *previous_target = SDL_GetRenderTarget(renderer);
+  SDL_SetRenderTarget(renderer, layer->texture);
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
+  for (size_t i = 0; i < body_count; i++)
+  {
+    body_record_t *record = render_snapshot_get_body(snapshot, i);
+    if (!record->static_background || record->camera_mode != camera_mode)
+    {
+      continue;
+    }
+    body_image_t image;
+    if (get_body_image(record, &image))
+    {
+      SDL_Rect bounds = record_get_bounds(record);
+      SDL_Rect pixel_bounds = view_get_pixel_rect(layer_view, &bounds);
+      double rotation = -180 * record->rotation / M_PI;
+      draw_body_image(&image, &pixel_bounds, rotation);
+    }
+    else
+    {
+      size_t vertex_count;
+      vector_t *vertices =
+          record_get_outline(snapshot, record, layer_view, &vertex_count);
+      draw_polygon_in_view(layer_view, vertices, vertex_count, record->color);
+    }
+  }
+  SDL_SetRenderTarget(renderer, previous_target);
+}
+
+/**
+ * Checks whether a layer must be redrawn because the visible part of its
+ * bodies is no longer inside the rectangle drawn into its texture.
+ * The rectangles are compared where they were when the layer was drawn.
+ */
+bool static_layer_out_of_range(static_layer_t *layer, vector_t offset,
+                               vector_t visible_min, vector_t visible_max)
+{
+  vector_t needed_min = vec_subtract(visible_min, offset),
+           needed_max = vec_subtract(visible_max, offset);
+  needed_min = (vector_t){.x = fmax(needed_min.x, layer->bodies_min.x),
+                          .y = fmax(needed_min.y, layer->bodies_min.y)};
+  needed_max = (vector_t){.x = fmin(needed_max.x, layer->bodies_max.x),
+                          .y = fmin(needed_max.y, layer->bodies_max.y)};
+  if (needed_min.x >= needed_max.x || needed_min.y >= needed_max.y)
+  {
+    // None of the layer is visible
+    return false;
+  }
+  return needed_min.x < layer->min.x || needed_min.y < layer->min.y ||
+         needed_max.x > layer->max.x || needed_max.y > layer->max.y;
+}
+
+/**
+ * Brings each camera mode's static layer up to date with the snapshot's
+ * static background bodies, then draws the layers behind everything else,
+ * in the order their first bodies appear in the scene.
+ */
+void static_layers_render(render_snapshot_t *snapshot, view_t view,
+                          vector_t visible_min, vector_t visible_max)
+{
+  static_layer_t current[STATIC_LAYER_COUNT] = {0};
+  size_t first_index[STATIC_LAYER_COUNT];
+  // Where each layer's anchor is now
+  vector_t anchor_centroids[STATIC_LAYER_COUNT];
+  size_t body_count = render_snapshot_bodies(snapshot);
+  for (size_t i = 0; i < body_count; i++)
+  {
+    body_record_t *record = render_snapshot_get_body(snapshot, i);
+    if (!record->static_background)
+    {
+      continue;
+    }
+    camera_mode_t camera_mode = record->camera_mode;
+    static_layer_t *layer = &current[camera_mode];
+    if (layer->count == 0)
+    {
+      layer->anchor_id = record->id;
+      layer->anchor_centroid = record->centroid;
+      first_index[camera_mode] = i;
+    }
+    layer->count++;
+    layer->id_sum += record->id;
+    layer->id_xor ^= record->id;
+    if (static_layers[camera_mode].count > 0 &&
+        static_layers[camera_mode].anchor_id == record->id)
+    {
+      anchor_centroids[camera_mode] = record->centroid;
+    }
+  }
+
+  size_t order[STATIC_LAYER_COUNT];
+  size_t layer_count = 0;
+  for (size_t mode = 0; mode < STATIC_LAYER_COUNT; mode++)
+  {
+    static_layer_t *layer = &static_layers[mode];
+    if (current[mode].count == 0)
+    {
+      static_layer_reset(layer);
+      continue;
+    }
+    if (layer->count != current[mode].count ||
+        layer->id_sum != current[mode].id_sum ||
+        layer->id_xor != current[mode].id_xor)
+    {
+      static_layer_reset(layer);
+      layer->count = current[mode].count;
+      layer->id_sum = current[mode].id_sum;
+      layer->id_xor = current[mode].id_xor;
+      layer->anchor_id = current[mode].anchor_id;
+      anchor_centroids[mode] = current[mode].anchor_centroid;
+      static_layer_draw(layer, snapshot, mode, anchor_centroids[mode], view,
+                        visible_min, visible_max);
+    }
+    else if (layer->scale != view.scale ||
+             static_layer_out_of_range(
+                 layer,
+                 vec_subtract(anchor_centroids[mode], layer->anchor_centroid),
+                 visible_min, visible_max))
+    {
+      static_layer_draw(layer, snapshot, mode, anchor_centroids[mode], view,
+                        visible_min, visible_max);
+    }
+
+    // Insert the layer into the drawing order
+    size_t j = layer_count++;
+    while (j > 0 && first_index[order[j - 1]] > first_index[mode])
+    {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = mode;
+  }
+
+  for (size_t i = 0; i < layer_count; i++)
+  {
+    size_t mode = order[i];
+    static_layer_t *layer = &static_layers[mode];
+    if (renderer == NULL)
+    {
+      frame_stats.draw_calls++;
+      continue;
+    }
+    if (layer->texture == NULL)
+    {
+      continue;
+    }
+    vector_t offset =
+        vec_subtract(anchor_centroids[mode], layer->anchor_centroid);
+    vector_t top_left = {.x = layer->min.x + offset.x,
+                         .y = layer->max.y + offset.y};
+    vector_t pixel = view_project(view, top_left);
+    SDL_Rect dest = {.x = pixel.x, .y = pixel.y};
+    SDL_QueryTexture(layer->texture, NULL, NULL, &dest.w, &dest.h);
+    SDL_RenderCopy(renderer, layer->texture, NULL, &dest);
+    frame_stats.draw_calls++;
+  }
+}
+
+/** Draws a text record with the HUD font */
+void draw_text_record(text_record_t *text)
 {
-  clock_t now = clock();
+  if (fonts == NULL)
+  {
+    // The null backend loads no fonts
+    frame_stats.draw_calls++;
+    return;
+  }
+  glyph_atlas_t *atlas = font_cache_get(fonts, TEXT_FONT_FILE, TEXT_FONT_SIZE);
+  if (atlas == NULL)
+  {
+    return;
+  }
+  SDL_Rect boundary = {.w = text->dimensions.x,
+                       .h = text->dimensions.y,
+                       .x = text->position.x,
+                       .y = text->position.y};
+  SDL_Rect screen_bounds = transform_bounds_to_screen(boundary);
+  text_cache_draw(text_textures, atlas, text, screen_bounds);
+  frame_stats.draw_calls++;
+}
 
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
+void sdl_create_words_numbers(text_t *text)
+{
+  text_record_t record = text_record_make(text);
+  draw_text_record(&record);
+}
 
-  return difference;
+/**
+ * Gets the id of a texture in this frame's sort keys, giving it the next id
+ * if it has none yet. Flat colors (a NULL texture) have id 0.
+ */
+size_t render_queue_texture_id(SDL_Texture *texture)
+{
+  if (texture == NULL)
+  {
+    return 0;
+  }
+  // Bodies with the same texture are usually added to a scene together
+  if (texture == queue_last_texture)
+  {
+    return queue_last_texture_id;
+  }
+  size_t id = 0;
+  for (size_t i = 0; i < queue_texture_count && id == 0; i++)
+  {
+    if (queue_textures[i] == texture)
+    {
+      id = i + 1;
+    }
+  }
+  if (id == 0)
+  {
+    if (queue_texture_count < RENDER_QUEUE_TEXTURE_SLOTS)
+    {
+      queue_textures[queue_texture_count++] = texture;
+      id = queue_texture_count;
+    }
+    else
+    {
+      id = RENDER_QUEUE_TEXTURE_SLOTS + 1;
+    }
+  }
+  queue_last_texture = texture;
+  queue_last_texture_id = id;
+  return id;
+}
+
+/** Computes the sort key of a body in a layer, drawn with a texture id */
+uint64_t render_queue_key(int layer, size_t texture_id, bool blended)
+{
+  return (uint64_t)(layer - INT16_MIN) << RENDER_KEY_LAYER_SHIFT |
+         (uint64_t)texture_id << RENDER_KEY_TEXTURE_SHIFT | blended;
+}
+
+/**
+ * Sorts queued items by key with a least significant digit radix sort, one
+ * byte per pass, moving them back and forth between the two arrays.
+ * The sort is stable, so items with equal keys stay in scene order.
+ * Passes over a byte that is the same in every key (e.g. the layer's bytes
+ * when all bodies share a layer) are skipped.
+ *
+ * @return whichever of the two arrays holds the sorted items
+ */
+render_item_t *render_queue_sort(render_item_t *items, render_item_t *scratch,
+                                 size_t n)
+{
+  if (n < 2)
+  {
+    return items;
+  }
+  for (size_t byte = 0; byte < RENDER_KEY_BYTES; byte++)
+  {
+    size_t shift = 8 * byte;
+    size_t offsets[256] = {0};
+    for (size_t i = 0; i < n; i++)
+    {
+      offsets[(items[i].key >> shift) & 0xff]++;
+    }
+    if (offsets[(items[0].key >> shift) & 0xff] == n)
+    {
+      continue;
+    }
+    size_t total = 0;
+    for (size_t digit = 0; digit < 256; digit++)
+    {
+      size_t count = offsets[digit];
+      offsets[digit] = total;
+      total += count;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+      scratch[offsets[(items[i].key >> shift) & 0xff]++] = items[i];
+    }
+    render_item_t *sorted = scratch;
+    scratch = items;
+    items = sorted;
+  }
+  return items;
+}
+
+/**
+ * Queues the snapshot's particle fields and its bodies that are on screen
+ * and not drawn by a static layer, then sorts them into drawing order.
+ *
+ * @param count set to the number of queued items
+ * @return the sorted items
+ */
+render_item_t *render_queue_build(render_snapshot_t *snapshot,
+                                  vector_t visible_min, vector_t visible_max,
+                                  size_t *count)
+{
+  size_t body_count = render_snapshot_bodies(snapshot);
+  size_t field_count = render_snapshot_particle_fields(snapshot);
+  queue_items = scratch_reserve(queue_items, &queue_item_capacity,
+                                body_count + field_count,
+                                RENDER_QUEUE_INITIAL_ITEMS,
+                                sizeof(render_item_t));
+  queue_texture_count = 0;
+  queue_last_texture = NULL;
+
+  size_t queued = 0;
+  for (size_t i = 0; i < field_count; i++)
+  {
+    particle_field_record_t *field =
+        render_snapshot_get_particle_field(snapshot, i);
+    if (field->particle_count == 0)
+    {
+      continue;
+    }
+    // Fields come first, so they are drawn behind bodies in the same layer
+    queue_items[queued++] =
+        (render_item_t){.key = render_queue_key(field->layer, 0, false),
+                        .field = field};
+  }
+  for (size_t i = 0; i < body_count; i++)
+  {
+    body_record_t *record = render_snapshot_get_body(snapshot, i);
+    if (record->static_background &&
+        static_layers[record->camera_mode].drawn)
+    {
+      continue;
+    }
+    // The bounds are computed once and reused to draw textured bodies,
+    // so bodies outside the window cost no copies or transforms
+    SDL_Rect bounds = record_get_bounds(record);
+    if (!is_visible(&bounds, visible_min, visible_max))
+    {
+      frame_stats.culled_bodies++;
+      continue;
+    }
+
+    render_item_t *item = &queue_items[queued++];
+    item->record = record;
+    item->field = NULL;
+    item->bounds = bounds;
+    item->has_image = get_body_image(record, &item->image);
+    SDL_Texture *texture = item->has_image ? item->image.texture : NULL;
+    item->key = render_queue_key(record->layer,
+                                 render_queue_texture_id(texture),
+                                 texture != NULL);
+  }
+
+  queue_sorted =
+      scratch_reserve(queue_sorted, &queue_sorted_capacity, queued,
+                      RENDER_QUEUE_INITIAL_ITEMS, sizeof(render_item_t));
+  *count = queued;
+  return render_queue_sort(queue_items, queue_sorted, queued);
+}
+
+void sdl_render_snapshot(render_snapshot_t *snapshot)
+{
+  frame_begin();
+  double start = frame_clock_now();
+  assets_upload();
+  phase_end(RENDER_PHASE_UPLOAD, start);
+  uint64_t signature = render_snapshot_signature(snapshot);
+  if (!frame_dirty && signature == presented_signature)
+  {
+    // The screen already shows this frame, so it is not drawn or presented
+    frame_stats.idle = true;
+    frame_end();
+    return;
+  }
+
+  sdl_clear();
+  view_t view = get_window_view();
+  vector_t visible_min, visible_max;
+  get_visible_scene_bounds(view, &visible_min, &visible_max);
+  start = frame_clock_now();
+  static_layers_render(snapshot, view, visible_min, visible_max);
+  start = phase_end(RENDER_PHASE_STATIC_LAYERS, start);
+
+  size_t queued;
+  render_item_t *items =
+      render_queue_build(snapshot, visible_min, visible_max, &queued);
+  start = phase_end(RENDER_PHASE_QUEUE, start);
+  for (size_t i = 0; i < queued; i++)
+  {
+    render_item_t *item = &items[i];
+    body_record_t *record = item->record;
+    SDL_Texture *texture = item->has_image ? item->image.texture : NULL;
+    SDL_Texture *previous_texture =
+        i > 0 && items[i - 1].has_image ? items[i - 1].image.texture : NULL;
+    if (i > 0 && texture != previous_texture)
+    {
+      frame_stats.texture_switches++;
+    }
+    if (item->field != NULL)
+    {
+      batch_add_particle_field(snapshot, item->field, view, visible_min,
+                               visible_max);
+      continue;
+    }
+
+    if (item->has_image)
+    {
+      SDL_Rect screen_bounds = transform_bounds_to_screen(item->bounds);
+
+      // Must be converted to clockwise, in degrees
+      double rotation = -180 * record->rotation / M_PI;
+      if (render_mode == RENDER_BATCHED && texture != NULL)
+      {
+        batch_add_image(&item->image, screen_bounds, rotation);
+      }
+      else
+      {
+        draw_body_image(&item->image, &screen_bounds, rotation);
+      }
+    }
+    else
+    {
+      size_t vertex_count;
+      vector_t *vertices =
+          record_get_outline(snapshot, record, view, &vertex_count);
+      if (render_mode == RENDER_BATCHED)
+      {
+        batch_add_polygon(vertices, vertex_count, record->color);
+      }
+      else
+      {
+        draw_polygon_in_view(view, vertices, vertex_count, record->color);
+      }
+    }
+    frame_stats.bodies_drawn++;
+  }
+  batch_flush();
+  start = phase_end(RENDER_PHASE_BODIES, start);
+
+  size_t text_count = render_snapshot_texts(snapshot);
+  for (size_t i = 0; i < text_count; i++)
+  {
+    text_record_t *text = render_snapshot_get_text(snapshot, i);
+    if (text->type == WORDS_STAY || text->type == WORDS_POWERUP)
+    {
+      draw_text_record(text);
+    }
+  }
+  if (text_textures != NULL)
+  {
+    text_cache_sweep(text_textures);
+  }
+  phase_end(RENDER_PHASE_TEXT, start);
+
+  sdl_show();
+  presented_signature = signature;
+  frame_dirty = false;
+
+  if (asset_progress_changed && asset_progress != NULL)
+  {
+    asset_progress(assets_uploaded, assets_total, asset_progress_aux);
+  }
+  asset_progress_changed = false;
+}
+
+void sdl_render_scene(scene_t *scene)
+{
+  if (scene_snapshot == NULL)
+  {
+    scene_snapshot = render_snapshot_init();
+  }
+  frame_begin();
+  double start = frame_clock_now();
+  size_t allocations = render_snapshot_allocations(scene_snapshot);
+  render_snapshot_capture(scene_snapshot, scene, frames_shown);
+  frame_stats.allocations +=
+      render_snapshot_allocations(scene_snapshot) - allocations;
+  phase_end(RENDER_PHASE_CAPTURE, start);
+  sdl_render_snapshot(scene_snapshot);
+}
+
+int simulation_worker_run(void *data)
+{
+  simulation_worker_t *worker = data;
+  SDL_LockMutex(worker->lock);
+  while (true)
+  {
+    while (!worker->busy && !worker->quit)
+    {
+      SDL_CondWait(worker->changed, worker->lock);
+    }
+    if (worker->quit)
+    {
+      break;
+    }
+    // The main thread does not touch the simulation until busy is cleared
+    SDL_UnlockMutex(worker->lock);
+    scene_t *scene = worker->step(worker->aux);
+    if (scene != NULL)
+    {
+      render_snapshot_capture(worker->target, scene, worker->frame);
+    }
+    SDL_LockMutex(worker->lock);
+    worker->finished = scene == NULL;
+    worker->busy = false;
+    SDL_CondBroadcast(worker->changed);
+  }
+  SDL_UnlockMutex(worker->lock);
+  return 0;
+}
+
+/** Starts the worker on the next step, to be captured into a snapshot */
+void simulation_worker_start(simulation_worker_t *worker,
+                             render_snapshot_t *target, size_t frame)
+{
+  SDL_LockMutex(worker->lock);
+  worker->target = target;
+  worker->frame = frame;
+  worker->busy = true;
+  SDL_CondBroadcast(worker->changed);
+  SDL_UnlockMutex(worker->lock);
+}
+
+/** Waits for the worker's step to finish and returns whether it ended */
+bool simulation_worker_wait(simulation_worker_t *worker)
+{
+  SDL_LockMutex(worker->lock);
+  while (worker->busy)
+  {
+    SDL_CondWait(worker->changed, worker->lock);
+  }
+  bool finished = worker->finished;
+  SDL_UnlockMutex(worker->lock);
+  return finished;
+}
+
+void sdl_run_simulation(simulation_step_t step, void *aux)
+{
+  render_snapshot_t *snapshots[2] = {render_snapshot_init(),
+                                     render_snapshot_init()};
+  simulation_worker_t worker = {.lock = SDL_CreateMutex(),
+                                .changed = SDL_CreateCond(),
+                                .step = step,
+                                .aux = aux};
+  assert(worker.lock != NULL);
+  assert(worker.changed != NULL);
+  worker.thread =
+      SDL_CreateThread(simulation_worker_run, "simulation", &worker);
+  assert(worker.thread != NULL);
+
+  // The first step has no frame to overlap with
+  simulation_worker_start(&worker, snapshots[0], frames_shown);
+  bool finished = simulation_worker_wait(&worker);
+  size_t front = 0;
+  bool handled_input = false;
+  // Whether the scene last drawn had been ticked since the one before it,
+  // and its tick count
+  bool ticked = true;
+  size_t tick_calls = 0;
+  // Each snapshot's allocations as of the last time it was drawn; growth
+  // since then happened while capturing it, for the frame that draws it
+  size_t allocations[2] = {0, 0};
+  // Key handlers run in sdl_is_done(), while the worker is idle,
+  // so they can change the simulation's state
+  while (!finished)
+  {
+    // Static screens only change in response to input, so wait for input
+    // rather than stepping them again at once. The frame just drawn was
+    // stepped before the last input was handled, so never wait right after
+    // input; the next frame has to show that nothing changed too.
+    // Assets that finish loading change the screen without any input.
+    // A running scene is never waited on: a frame too short for a fixed
+    // step draws the same thing, but the next one will not.
+    bool wait = last_frame_stats.idle && !ticked && !handled_input &&
+                sdl_assets_loaded();
+    size_t events = handled_events;
+    if (wait ? sdl_is_done_wait(IDLE_WAIT_TIMEOUT) : sdl_is_done())
+    {
+      break;
+    }
+    handled_input = handled_events != events;
+
+    // Drawn after the frame that is drawn while it is stepped
+    simulation_worker_start(&worker, snapshots[1 - front], frames_shown + 1);
+    size_t drawn_tick_calls = render_snapshot_tick_calls(snapshots[front]);
+    ticked = drawn_tick_calls != tick_calls;
+    tick_calls = drawn_tick_calls;
+    frame_begin();
+    size_t captured = render_snapshot_allocations(snapshots[front]);
+    frame_stats.allocations += captured - allocations[front];
+    allocations[front] = captured;
+    sdl_render_snapshot(snapshots[front]);
+    finished = simulation_worker_wait(&worker);
+    front = 1 - front;
+  }
+
+  SDL_LockMutex(worker.lock);
+  worker.quit = true;
+  SDL_CondBroadcast(worker.changed);
+  SDL_UnlockMutex(worker.lock);
+  SDL_WaitThread(worker.thread, NULL);
+  SDL_DestroyCond(worker.changed);
+  SDL_DestroyMutex(worker.lock);
+  render_snapshot_free(snapshots[0]);
+  render_snapshot_free(snapshots[1]);
+}
+
+void sdl_set_render_mode(render_mode_t mode)
+{
+  render_mode = mode;
+  frame_dirty = true;
+}
+
+render_stats_t sdl_get_frame_stats(void) { return last_frame_stats; }
+
+void sdl_on_key(key_handler_t handler) { key_handler = handler; }
+
+void sdl_event_args(void *args) { event_args = args; }
+
+double time_since_last_tick(void)
+{
+  if (tick_clock == NULL)
+  {
+    tick_clock = frame_clock_init();
+  }
+  // Returns 0 the first time this is called
+  return frame_clock_tick(tick_clock);
 }
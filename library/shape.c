@@ -0,0 +1,229 @@
+#include "shape.h"
+#include "polygon.h"
+#include "sprite.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t SHAPE_TABLE_INITIAL_CAPACITY = 16;
+
+typedef struct shape
+{
+  uint32_t hash;
+  size_t refs;
+  size_t count;
+  vector_t vertices[];
+} shape_t;
+
+/**
+ * Every live shape, in an open-addressing hash table keyed by the shapes'
+ * hashes, so finding a shape with the same vertices only compares it with
+ * shapes of the same hash. Collisions go in the next free slot. The
+ * capacity is a power of two, at least twice the number of shapes.
+ * NULL while there are none.
+ */
+shape_t **shape_table = NULL;
+size_t shape_table_capacity = 0, shape_table_count = 0;
+
+/** Folds one coordinate into an FNV-1a hash */
+uint32_t shape_hash_add(uint32_t hash, double coordinate)
+{
+  // -0.0 == 0.0, so both must hash the same
+  coordinate += 0.0;
+  uint64_t bits;
+  memcpy(&bits, &coordinate, sizeof(bits));
+  for (size_t i = 0; i < sizeof(bits); i++)
+  {
+    hash ^= (uint8_t)(bits >> (8 * i));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/** Hashes vertices, so most shapes that differ are not compared */
+uint32_t shape_hash(vector_t *vertices, size_t count)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < count; i++)
+  {
+    hash = shape_hash_add(hash, vertices[i].x);
+    hash = shape_hash_add(hash, vertices[i].y);
+  }
+  return hash;
+}
+
+/** Checks whether a shape has exactly the given vertices */
+bool shape_equals(shape_t *shape, uint32_t hash, vector_t *vertices,
+                  size_t count)
+{
+  if (shape->hash != hash || shape->count != count)
+  {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    if (shape->vertices[i].x != vertices[i].x ||
+        shape->vertices[i].y != vertices[i].y)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Gets the slot of the table where a hash is looked for first */
+size_t shape_table_home(uint32_t hash)
+{
+  return hash & (shape_table_capacity - 1);
+}
+
+/** Doubles the capacity of the table, or creates it */
+void shape_table_grow(void)
+{
+  shape_t **old_table = shape_table;
+  size_t old_capacity = shape_table_capacity;
+  shape_table_capacity =
+      old_capacity > 0 ? 2 * old_capacity : SHAPE_TABLE_INITIAL_CAPACITY;
+  shape_table = calloc(shape_table_capacity, sizeof(shape_t *));
+  assert(shape_table != NULL);
+  for (size_t i = 0; i < old_capacity; i++)
+  {
+    shape_t *shape = old_table[i];
+    if (shape == NULL)
+    {
+      continue;
+    }
+    size_t slot = shape_table_home(shape->hash);
+    while (shape_table[slot] != NULL)
+    {
+      slot = (slot + 1) & (shape_table_capacity - 1);
+    }
+    shape_table[slot] = shape;
+  }
+  free(old_table);
+}
+
+/**
+ * Takes a shape out of the table. The shapes after it that were pushed
+ * past their home slots are shifted back, so no lookup stops early at the
+ * emptied slot.
+ */
+void shape_table_remove(shape_t *shape)
+{
+  size_t mask = shape_table_capacity - 1;
+  size_t slot = shape_table_home(shape->hash);
+  while (shape_table[slot] != shape)
+  {
+    assert(shape_table[slot] != NULL);
+    slot = (slot + 1) & mask;
+  }
+  shape_table[slot] = NULL;
+  for (size_t next = (slot + 1) & mask; shape_table[next] != NULL;
+       next = (next + 1) & mask)
+  {
+    size_t home = shape_table_home(shape_table[next]->hash);
+    // Moves the shape if the emptied slot is between its home and it
+    if (((next - home) & mask) >= ((next - slot) & mask))
+    {
+      shape_table[slot] = shape_table[next];
+      shape_table[next] = NULL;
+      slot = next;
+    }
+  }
+  shape_table_count--;
+}
+
+shape_t *shape_intern(vector_t *vertices, size_t count)
+{
+  assert(count >= 3);
+  uint32_t hash = shape_hash(vertices, count);
+  if (2 * (shape_table_count + 1) > shape_table_capacity)
+  {
+    shape_table_grow();
+  }
+  size_t slot = shape_table_home(hash);
+  while (shape_table[slot] != NULL)
+  {
+    if (shape_equals(shape_table[slot], hash, vertices, count))
+    {
+      return shape_retain(shape_table[slot]);
+    }
+    slot = (slot + 1) & (shape_table_capacity - 1);
+  }
+
+  shape_t *shape = malloc(sizeof(shape_t) + count * sizeof(vector_t));
+  assert(shape != NULL);
+  shape->hash = hash;
+  shape->refs = 1;
+  shape->count = count;
+  memcpy(shape->vertices, vertices, count * sizeof(vector_t));
+  shape_table[slot] = shape;
+  shape_table_count++;
+  return shape;
+}
+
+shape_t *shape_intern_polygon(list_t *polygon, vector_t *centroid)
+{
+  size_t count = list_size(polygon);
+  vector_t origin = polygon_centroid(polygon);
+  vector_t *vertices = malloc(count * sizeof(vector_t));
+  assert(vertices != NULL);
+  for (size_t i = 0; i < count; i++)
+  {
+    vertices[i] = vec_subtract(*(vector_t *)list_get(polygon, i), origin);
+  }
+  list_free(polygon);
+  shape_t *shape = shape_intern(vertices, count);
+  free(vertices);
+  if (centroid != NULL)
+  {
+    *centroid = origin;
+  }
+  return shape;
+}
+
+shape_t *shape_intern_circle(double radius, size_t count)
+{
+  vector_t *vertices = malloc(count * sizeof(vector_t));
+  assert(vertices != NULL);
+  sprite_fill_circle(vertices, count, VEC_ZERO, radius, 0);
+  shape_t *shape = shape_intern(vertices, count);
+  free(vertices);
+  return shape;
+}
+
+shape_t *shape_retain(shape_t *shape)
+{
+  shape->refs++;
+  return shape;
+}
+
+void shape_release(shape_t *shape)
+{
+  assert(shape->refs > 0);
+  if (--shape->refs > 0)
+  {
+    return;
+  }
+  shape_table_remove(shape);
+  free(shape);
+  if (shape_table_count == 0)
+  {
+    free(shape_table);
+    shape_table = NULL;
+    shape_table_capacity = 0;
+  }
+}
+
+size_t shape_vertex_count(shape_t *shape) { return shape->count; }
+
+vector_t *shape_get_vertices(shape_t *shape) { return shape->vertices; }
+
+size_t shape_refs(shape_t *shape) { return shape->refs; }
+
+size_t shape_interned_count(void)
+{
+  return shape_table_count;
+}
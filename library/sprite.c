@@ -7,10 +7,15 @@
 
 #include "sprite.h"
 #include "vector.h"
+#include <assert.h>
 #include <stdlib.h>
 
 const size_t SPRITE_CIRCLE_POINTS_PER_RADIAN = 12;
 const double SPRITE_PACMAN_MOUTH_ANGLE = M_PI / 3.0;
+const size_t SPRITE_CIRCLE_PROXY_POINTS = 16;
+const size_t SPRITE_CIRCLE_MIN_POINTS = 8;
+const size_t SPRITE_CIRCLE_MAX_POINTS = 128;
+const double SPRITE_CIRCLE_MAX_ERROR = 0.5;
 
 void sprite_add_radial_point(list_t *sprite, double radius, double angle) {
   vector_t new_side = (vector_t){.x = radius, .y = 0};
@@ -87,6 +92,45 @@ list_t *sprite_make_circle(double radius) {
   return circle;
 }
 
+list_t *sprite_make_circle_points(double radius, size_t num_points) {
+  assert(num_points >= 3);
+  list_t *circle = list_init(num_points, (free_func_t)vec_free);
+  for (size_t i = 0; i < num_points; i++) {
+    sprite_add_radial_point(circle, radius, 2 * M_PI * i / num_points);
+  }
+  return circle;
+}
+
+size_t sprite_circle_points_for_radius(double pixel_radius) {
+  // An edge of a regular n-gon falls r * (1 - cos(pi / n)) inside its circle
+  if (pixel_radius <= SPRITE_CIRCLE_MAX_ERROR) {
+    return SPRITE_CIRCLE_MIN_POINTS;
+  }
+  double points = ceil(M_PI / acos(1 - SPRITE_CIRCLE_MAX_ERROR / pixel_radius));
+  if (points < SPRITE_CIRCLE_MIN_POINTS) {
+    return SPRITE_CIRCLE_MIN_POINTS;
+  }
+  if (points > SPRITE_CIRCLE_MAX_POINTS) {
+    return SPRITE_CIRCLE_MAX_POINTS;
+  }
+  return points;
+}
+
+void sprite_fill_circle(vector_t *vertices, size_t num_points, vector_t center,
+                        double radius, double angle) {
+  assert(num_points >= 3);
+  // Each vertex is the last one rotated by the same step, so only the step
+  // needs a cos() and sin()
+  double step = 2 * M_PI / num_points;
+  double step_cos = cos(step), step_sin = sin(step);
+  vector_t offset = {.x = radius * cos(angle), .y = radius * sin(angle)};
+  for (size_t i = 0; i < num_points; i++) {
+    vertices[i] = vec_add(center, offset);
+    offset = (vector_t){.x = offset.x * step_cos - offset.y * step_sin,
+                        .y = offset.x * step_sin + offset.y * step_cos};
+  }
+}
+
 list_t *sprite_make_rect(double min_x, double max_x, double min_y,
                          double max_y) {
   list_t *rectangle = list_init(4, (free_func_t)vec_free);
@@ -4,8 +4,16 @@
 #include <math.h>
 #include <stdio.h>
 
+/**
+ * The version given to the next text created or changed.
+ * Versions are unique across all texts, so a renderer cache keyed by a
+ * text's address cannot mistake a new text for a freed one.
+ */
+size_t next_text_version = 1;
+
 typedef struct text
 {
+  size_t version;
   char *words;
   vector_t text_position;
   double text_size;
@@ -25,7 +33,8 @@ text_t *text_init(char *words, vector_t text_position, double text_size,
                   double numbers, vector_t text_dimensions)
 {
   text_t *params = malloc(sizeof(text_t));
-  *params = (text_t){.words = words,
+  *params = (text_t){.version = next_text_version++,
+                     .words = words,
                      .text_position = text_position,
                      .text_size = text_size,
                      .numbers = numbers,
@@ -40,7 +49,13 @@ void text_free(text_t *text)
   free(text);
 }
 
-void text_set_words(text_t *text, char *words) { text->words = words; }
+void text_set_words(text_t *text, char *words)
+{
+  // The text does not own its words, so a caller may have rewritten the
+  // same buffer; the words always count as changed
+  text->words = words;
+  text->version = next_text_version++;
+}
 
 void text_set_text_position(text_t *text, vector_t text_position)
 {
@@ -52,7 +67,14 @@ void text_set_text_size(text_t *text, double text_size)
   text->text_size = text_size;
 }
 
-void text_set_numbers(text_t *text, double numbers) { text->numbers = numbers; }
+void text_set_numbers(text_t *text, double numbers)
+{
+  if (text->numbers != numbers)
+  {
+    text->numbers = numbers;
+    text->version = next_text_version++;
+  }
+}
 
 void text_set_text_dimensions(text_t *text, vector_t text_dimensions)
 {
@@ -82,3 +104,5 @@ vector_t text_get_text_dimensions(text_t *text)
 }
 
 void *text_get_type(text_t *text) { return text->info; }
+
+size_t text_get_version(text_t *text) { return text->version; }
@@ -0,0 +1,195 @@
+#include "text_cache.h"
+#include "list.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEXT_CACHE_MAX_LENGTH 500
+
+const size_t TEXT_CACHE_DEFAULT_CAPACITY = 8;
+
+typedef struct text_texture
+{
+  text_t *text;
+  size_t version;
+  glyph_atlas_t *atlas;
+  char string[TEXT_CACHE_MAX_LENGTH];
+  // NULL if the string is empty or the renderer has no render targets,
+  // in which case the string is drawn straight from the atlas
+  SDL_Texture *texture;
+  SDL_Point size;
+  size_t last_drawn;
+} text_texture_t;
+
+typedef struct text_cache
+{
+  SDL_Renderer *renderer;
+  list_t *entries;
+  size_t frame;
+  // Counted since the cache was created
+  size_t rasterizations, uploads;
+} text_cache_t;
+
+void text_texture_free(text_texture_t *entry)
+{
+  if (entry->texture != NULL)
+  {
+    SDL_DestroyTexture(entry->texture);
+  }
+  free(entry);
+}
+
+text_cache_t *text_cache_init(SDL_Renderer *renderer)
+{
+  text_cache_t *cache = malloc(sizeof(text_cache_t));
+  assert(cache != NULL);
+  cache->renderer = renderer;
+  cache->entries =
+      list_init(TEXT_CACHE_DEFAULT_CAPACITY, (free_func_t)text_texture_free);
+  cache->frame = 0;
+  cache->rasterizations = 0;
+  cache->uploads = 0;
+  return cache;
+}
+
+void text_cache_free(text_cache_t *cache)
+{
+  list_free(cache->entries);
+  free(cache);
+}
+
+void text_cache_format(text_record_t *text, char *buffer, size_t size)
+{
+  if (text->numbers > -1)
+  {
+    snprintf(buffer, size, "%s%d", text->words, (int)text->numbers);
+  }
+  else
+  {
+    snprintf(buffer, size, "%s", text->words);
+  }
+}
+
+/**
+ * Draws the entry's string into its texture at the atlas's native size,
+ * (re)creating the texture if the size of the string changed.
+ */
+void text_texture_render(text_cache_t *cache, text_texture_t *entry)
+{
+  SDL_Point size = glyph_atlas_measure(entry->atlas, entry->string);
+  if (entry->texture != NULL &&
+      (size.x != entry->size.x || size.y != entry->size.y))
+  {
+    SDL_DestroyTexture(entry->texture);
+    entry->texture = NULL;
+  }
+  entry->size = size;
+  if (size.x == 0 || size.y == 0)
+  {
+    return;
+  }
+  if (entry->texture == NULL)
+  {
+    entry->texture =
+        SDL_CreateTexture(cache->renderer, SDL_PIXELFORMAT_RGBA8888,
+                          SDL_TEXTUREACCESS_TARGET, size.x, size.y);
+    if (entry->texture == NULL)
+    {
+      return;
+    }
+    SDL_SetTextureBlendMode(entry->texture, SDL_BLENDMODE_BLEND);
+    cache->uploads++;
+  }
+  cache->rasterizations++;
+
+  SDL_Texture *previous_target = SDL_GetRenderTarget(cache->renderer);
+  SDL_SetRenderTarget(cache->renderer, entry->texture);
+  // The glyphs are white, so clearing to transparent white keeps their
+  // edges white when they are alpha blended onto the texture
+  SDL_SetRenderDrawColor(cache->renderer, 255, 255, 255, 0);
+  SDL_RenderClear(cache->renderer);
+  SDL_Rect bounds = {.x = 0, .y = 0, .w = size.x, .h = size.y};
+  glyph_atlas_draw(entry->atlas, cache->renderer, entry->string, bounds);
+  SDL_SetRenderTarget(cache->renderer, previous_target);
+}
+
+text_texture_t *text_cache_lookup(text_cache_t *cache, text_t *text)
+{
+  size_t count = list_size(cache->entries);
+  for (size_t i = 0; i < count; i++)
+  {
+    text_texture_t *entry = list_get(cache->entries, i);
+    if (entry->text == text)
+    {
+      return entry;
+    }
+  }
+
+  text_texture_t *entry = malloc(sizeof(text_texture_t));
+  assert(entry != NULL);
+  entry->text = text;
+  // Versions start at 1, so a new entry is always out of date
+  entry->version = 0;
+  entry->atlas = NULL;
+  entry->string[0] = '\0';
+  entry->texture = NULL;
+  entry->size = (SDL_Point){.x = 0, .y = 0};
+  list_add(cache->entries, entry);
+  return entry;
+}
+
+void text_cache_draw(text_cache_t *cache, glyph_atlas_t *atlas,
+                     text_record_t *text, SDL_Rect bounds)
+{
+  text_texture_t *entry = text_cache_lookup(cache, text->text);
+  entry->last_drawn = cache->frame;
+
+  size_t version = text->version;
+  if (entry->version != version || entry->atlas != atlas)
+  {
+    char string[TEXT_CACHE_MAX_LENGTH];
+    text_cache_format(text, string, sizeof(string));
+    // A new number often formats the same (e.g. a timer between seconds)
+    bool changed = entry->atlas != atlas || strcmp(string, entry->string) != 0;
+    entry->version = version;
+    entry->atlas = atlas;
+    if (changed)
+    {
+      strcpy(entry->string, string);
+      text_texture_render(cache, entry);
+    }
+  }
+
+  if (entry->texture != NULL)
+  {
+    SDL_RenderCopy(cache->renderer, entry->texture, NULL, &bounds);
+  }
+  else if (entry->size.x > 0)
+  {
+    glyph_atlas_draw(atlas, cache->renderer, entry->string, bounds);
+  }
+}
+
+void text_cache_sweep(text_cache_t *cache)
+{
+  for (size_t i = 0; i < list_size(cache->entries); i++)
+  {
+    text_texture_t *entry = list_get(cache->entries, i);
+    if (entry->last_drawn != cache->frame)
+    {
+      list_remove(cache->entries, i);
+      text_texture_free(entry);
+      i--;
+    }
+  }
+  cache->frame++;
+}
+
+size_t text_cache_rasterizations(text_cache_t *cache)
+{
+  return cache->rasterizations;
+}
+
+size_t text_cache_uploads(text_cache_t *cache) { return cache->uploads; }
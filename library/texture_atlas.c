@@ -0,0 +1,194 @@
+#include "texture_atlas.h"
+#include <SDL2/SDL_image.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t TEXTURE_ATLAS_NOT_FOUND = -1;
+const int TEXTURE_ATLAS_MIN_WIDTH = 1024;
+// Transparent pixels between images, so filtering never samples a neighbor
+const int TEXTURE_ATLAS_PADDING = 1;
+
+typedef struct atlas_image
+{
+  char *path;
+  SDL_Rect source;
+} atlas_image_t;
+
+typedef struct loaded_image
+{
+  char *path;
+  SDL_Surface *surface;
+} loaded_image_t;
+
+typedef struct texture_atlas
+{
+  SDL_Texture *texture;
+  SDL_Point size;
+  atlas_image_t *images;
+  size_t image_count;
+} texture_atlas_t;
+
+/** Sorts images from tallest to shortest, so shelves waste less space */
+int compare_image_heights(const void *a, const void *b)
+{
+  const loaded_image_t *image_a = a, *image_b = b;
+  return image_b->surface->h - image_a->surface->h;
+}
+
+texture_atlas_t *texture_atlas_init(SDL_Renderer *renderer, char **paths,
+                                    size_t count)
+{
+  SDL_Surface **surfaces = malloc(sizeof(SDL_Surface *) * count);
+  assert(count == 0 || surfaces != NULL);
+  for (size_t i = 0; i < count; i++)
+  {
+    surfaces[i] = IMG_Load(paths[i]);
+    if (surfaces[i] == NULL)
+    {
+      fprintf(stderr, "texture_atlas: could not load %s: %s\n", paths[i],
+              SDL_GetError());
+    }
+  }
+  texture_atlas_t *atlas = texture_atlas_pack(renderer, paths, surfaces, count);
+  for (size_t i = 0; i < count; i++)
+  {
+    if (surfaces[i] != NULL)
+    {
+      SDL_FreeSurface(surfaces[i]);
+    }
+  }
+  free(surfaces);
+  return atlas;
+}
+
+texture_atlas_t *texture_atlas_pack(SDL_Renderer *renderer, char **paths,
+                                    SDL_Surface **surfaces, size_t count)
+{
+  texture_atlas_t *atlas = malloc(sizeof(texture_atlas_t));
+  assert(atlas != NULL);
+  atlas->images = malloc(sizeof(atlas_image_t) * count);
+  loaded_image_t *loaded_images = malloc(sizeof(loaded_image_t) * count);
+  assert(atlas->images != NULL);
+  assert(loaded_images != NULL);
+
+  size_t loaded = 0;
+  int width = TEXTURE_ATLAS_MIN_WIDTH;
+  for (size_t i = 0; i < count; i++)
+  {
+    SDL_Surface *surface = surfaces[i];
+    if (surface == NULL)
+    {
+      continue;
+    }
+    loaded_images[loaded++] =
+        (loaded_image_t){.path = paths[i], .surface = surface};
+    if (surface->w > width)
+    {
+      width = surface->w;
+    }
+  }
+  qsort(loaded_images, loaded, sizeof(loaded_image_t), compare_image_heights);
+
+  // Pack the images into shelves, each as tall as its first image
+  int pen_x = 0, pen_y = 0, shelf_height = 0;
+  for (size_t i = 0; i < loaded; i++)
+  {
+    SDL_Surface *surface = loaded_images[i].surface;
+    if (pen_x + surface->w > width)
+    {
+      pen_x = 0;
+      pen_y += shelf_height + TEXTURE_ATLAS_PADDING;
+      shelf_height = 0;
+    }
+    const char *path = loaded_images[i].path;
+    atlas_image_t *image = &atlas->images[i];
+    image->path = malloc(strlen(path) + 1);
+    assert(image->path != NULL);
+    strcpy(image->path, path);
+    image->source =
+        (SDL_Rect){.x = pen_x, .y = pen_y, .w = surface->w, .h = surface->h};
+    pen_x += surface->w + TEXTURE_ATLAS_PADDING;
+    if (surface->h > shelf_height)
+    {
+      shelf_height = surface->h;
+    }
+  }
+  atlas->image_count = loaded;
+  atlas->size = (SDL_Point){.x = width, .y = pen_y + shelf_height};
+  atlas->texture = NULL;
+
+  SDL_Surface *sheet =
+      atlas->size.y > 0
+          ? SDL_CreateRGBSurfaceWithFormat(0, atlas->size.x, atlas->size.y, 32,
+                                           SDL_PIXELFORMAT_RGBA32)
+          : NULL;
+  for (size_t i = 0; i < loaded; i++)
+  {
+    if (sheet != NULL)
+    {
+      // Copy the image's pixels (including alpha) rather than blending them
+      SDL_SetSurfaceBlendMode(loaded_images[i].surface, SDL_BLENDMODE_NONE);
+      SDL_Rect dest = atlas->images[i].source;
+      SDL_BlitSurface(loaded_images[i].surface, NULL, sheet, &dest);
+    }
+  }
+  free(loaded_images);
+  if (sheet != NULL)
+  {
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    SDL_FreeSurface(sheet);
+  }
+  if (atlas->texture == NULL)
+  {
+    fprintf(stderr, "texture_atlas: could not create a %dx%d atlas: %s\n",
+            atlas->size.x, atlas->size.y, SDL_GetError());
+    texture_atlas_free(atlas);
+    return NULL;
+  }
+  SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+  return atlas;
+}
+
+void texture_atlas_free(texture_atlas_t *atlas)
+{
+  for (size_t i = 0; i < atlas->image_count; i++)
+  {
+    free(atlas->images[i].path);
+  }
+  free(atlas->images);
+  if (atlas->texture != NULL)
+  {
+    SDL_DestroyTexture(atlas->texture);
+  }
+  free(atlas);
+}
+
+size_t texture_atlas_find(texture_atlas_t *atlas, const char *path)
+{
+  for (size_t i = 0; i < atlas->image_count; i++)
+  {
+    if (strcmp(atlas->images[i].path, path) == 0)
+    {
+      return i;
+    }
+  }
+  return TEXTURE_ATLAS_NOT_FOUND;
+}
+
+SDL_Texture *texture_atlas_get_texture(texture_atlas_t *atlas)
+{
+  return atlas->texture;
+}
+
+SDL_Point texture_atlas_get_size(texture_atlas_t *atlas)
+{
+  return atlas->size;
+}
+
+SDL_Rect texture_atlas_get_source(texture_atlas_t *atlas, size_t index)
+{
+  assert(index < atlas->image_count);
+  return atlas->images[index].source;
+}
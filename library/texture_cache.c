@@ -0,0 +1,177 @@
+#include "texture_cache.h"
+#include "list.h"
+#include <SDL2/SDL_image.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t TEXTURE_CACHE_DEFAULT_CAPACITY = 16;
+const size_t TEXTURE_NOT_CACHED = -1;
+
+typedef struct texture_entry
+{
+  char *path;
+  uint32_t hash;
+  SDL_Texture *texture;
+} texture_entry_t;
+
+typedef struct texture_cache
+{
+  SDL_Renderer *renderer;
+  list_t *entries;
+  // Textures created since the cache was created
+  size_t uploads;
+} texture_cache_t;
+
+/** FNV-1a hash of a path, used to avoid strcmp() on most mismatches */
+uint32_t texture_path_hash(const char *path)
+{
+  uint32_t hash = 2166136261u;
+  for (const char *c = path; *c != '\0'; c++)
+  {
+    hash ^= (uint8_t)*c;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+texture_entry_t *texture_entry_init(const char *path, SDL_Texture *texture)
+{
+  texture_entry_t *entry = malloc(sizeof(texture_entry_t));
+  assert(entry != NULL);
+  entry->path = malloc(strlen(path) + 1);
+  assert(entry->path != NULL);
+  strcpy(entry->path, path);
+  entry->hash = texture_path_hash(path);
+  entry->texture = texture;
+  return entry;
+}
+
+void texture_entry_free(texture_entry_t *entry)
+{
+  if (entry->texture != NULL)
+  {
+    SDL_DestroyTexture(entry->texture);
+  }
+  free(entry->path);
+  free(entry);
+}
+
+texture_cache_t *texture_cache_init(SDL_Renderer *renderer)
+{
+  texture_cache_t *cache = malloc(sizeof(texture_cache_t));
+  assert(cache != NULL);
+  cache->renderer = renderer;
+  cache->entries = list_init(TEXTURE_CACHE_DEFAULT_CAPACITY,
+                             (free_func_t)texture_entry_free);
+  cache->uploads = 0;
+  return cache;
+}
+
+void texture_cache_free(texture_cache_t *cache)
+{
+  list_free(cache->entries);
+  free(cache);
+}
+
+/**
+ * Finds the index of the entry for a path,
+ * or TEXTURE_NOT_CACHED if there is none.
+ */
+size_t texture_cache_find(texture_cache_t *cache, const char *path)
+{
+  // Paths are always compared by contents: the same buffer may hold a
+  // different path by the next lookup
+  size_t count = list_size(cache->entries);
+  uint32_t hash = texture_path_hash(path);
+  for (size_t i = 0; i < count; i++)
+  {
+    texture_entry_t *entry = list_get(cache->entries, i);
+    if (entry->hash == hash && strcmp(entry->path, path) == 0)
+    {
+      return i;
+    }
+  }
+  return TEXTURE_NOT_CACHED;
+}
+
+SDL_Texture *texture_cache_add(texture_cache_t *cache, const char *path,
+                               SDL_Surface *surface)
+{
+  size_t idx = texture_cache_find(cache, path);
+  if (idx != TEXTURE_NOT_CACHED)
+  {
+    texture_entry_t *entry = list_get(cache->entries, idx);
+    return entry->texture;
+  }
+
+  SDL_Texture *texture =
+      surface != NULL ? SDL_CreateTextureFromSurface(cache->renderer, surface)
+                      : NULL;
+  if (surface != NULL && texture == NULL)
+  {
+    fprintf(stderr, "texture_cache: could not upload %s: %s\n", path,
+            SDL_GetError());
+  }
+  if (texture != NULL)
+  {
+    cache->uploads++;
+  }
+  list_add(cache->entries, texture_entry_init(path, texture));
+  return texture;
+}
+
+SDL_Texture *texture_cache_get(texture_cache_t *cache, const char *path)
+{
+  size_t idx = texture_cache_find(cache, path);
+  if (idx != TEXTURE_NOT_CACHED)
+  {
+    texture_entry_t *entry = list_get(cache->entries, idx);
+    return entry->texture;
+  }
+
+  SDL_Surface *image = IMG_Load(path);
+  if (image == NULL)
+  {
+    fprintf(stderr, "texture_cache: could not load %s: %s\n", path,
+            SDL_GetError());
+  }
+  // Failed loads are cached too, so they are not retried every frame
+  SDL_Texture *texture = texture_cache_add(cache, path, image);
+  if (image != NULL)
+  {
+    SDL_FreeSurface(image);
+  }
+  return texture;
+}
+
+bool texture_cache_evict(texture_cache_t *cache, const char *path)
+{
+  size_t idx = texture_cache_find(cache, path);
+  if (idx == TEXTURE_NOT_CACHED)
+  {
+    return false;
+  }
+  texture_entry_free(list_remove(cache->entries, idx));
+  return true;
+}
+
+void texture_cache_clear(texture_cache_t *cache)
+{
+  while (list_size(cache->entries) > 0)
+  {
+    texture_entry_free(list_remove(cache->entries, list_size(cache->entries) - 1));
+  }
+}
+
+size_t texture_cache_size(texture_cache_t *cache)
+{
+  return list_size(cache->entries);
+}
+
+size_t texture_cache_uploads(texture_cache_t *cache)
+{
+  return cache->uploads;
+}
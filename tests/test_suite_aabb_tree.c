@@ -0,0 +1,242 @@
+#include "aabb_tree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+aabb_t make_box(double min_x, double min_y, double max_x, double max_y)
+{
+    return (aabb_t){.min = {min_x, min_y}, .max = {max_x, max_y}};
+}
+
+typedef struct
+{
+    size_t found;
+    bool *seen;
+    size_t stop_after;
+} query_count_t;
+
+bool count_found(void *aux, size_t proxy, void *data)
+{
+    query_count_t *count = aux;
+    size_t index = (size_t)data;
+    assert(!count->seen[index]);
+    count->seen[index] = true;
+    count->found++;
+    return count->found != count->stop_after;
+}
+
+void test_aabb_tree_insert_remove()
+{
+    aabb_tree_t *tree = aabb_tree_init(1);
+    assert(aabb_tree_size(tree) == 0);
+    assert(aabb_tree_height(tree) == 0);
+    size_t a = aabb_tree_insert(tree, make_box(0, 0, 2, 2), (void *)1);
+    size_t b = aabb_tree_insert(tree, make_box(10, 0, 12, 2), (void *)2);
+    assert(aabb_tree_size(tree) == 2);
+    assert(aabb_tree_height(tree) == 1);
+    assert(aabb_tree_get_data(tree, a) == (void *)1);
+    assert(aabb_tree_get_data(tree, b) == (void *)2);
+    aabb_t fat = aabb_tree_get_fat_box(tree, a);
+    assert(vec_isclose(fat.min, (vector_t){-1, -1}));
+    assert(vec_isclose(fat.max, (vector_t){3, 3}));
+
+    aabb_tree_remove(tree, a);
+    assert(aabb_tree_size(tree) == 1);
+    assert(aabb_tree_height(tree) == 0);
+    assert(aabb_tree_get_data(tree, b) == (void *)2);
+    aabb_tree_remove(tree, b);
+    assert(aabb_tree_size(tree) == 0);
+    aabb_tree_free(tree);
+}
+
+void test_aabb_tree_move()
+{
+    aabb_tree_t *tree = aabb_tree_init(1);
+    size_t proxy = aabb_tree_insert(tree, make_box(0, 0, 2, 2), NULL);
+    aabb_tree_insert(tree, make_box(10, 10, 12, 12), NULL);
+    // Moves within the fat box leave the tree alone
+    assert(!aabb_tree_move(tree, proxy, make_box(0.5, -0.5, 2.5, 1.5)));
+    assert(vec_isclose(aabb_tree_get_fat_box(tree, proxy).min,
+                       (vector_t){-1, -1}));
+    // Leaving it moves the object, keeping its proxy
+    assert(aabb_tree_move(tree, proxy, make_box(5, 5, 7, 7)));
+    assert(vec_isclose(aabb_tree_get_fat_box(tree, proxy).min,
+                       (vector_t){4, 4}));
+    assert(aabb_tree_size(tree) == 2);
+    aabb_tree_free(tree);
+}
+
+void test_aabb_tree_query_matches_brute_force()
+{
+    srand(23);
+    const size_t COUNT = 500;
+    aabb_tree_t *tree = aabb_tree_init(0.5);
+    aabb_t *boxes = malloc(COUNT * sizeof(aabb_t));
+    size_t *proxies = malloc(COUNT * sizeof(size_t));
+    bool *seen = malloc(COUNT * sizeof(bool));
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        double x = rand() % 1000;
+        double y = rand() % 1000;
+        boxes[i] = make_box(x, y, x + rand() % 30, y + rand() % 30);
+        proxies[i] = aabb_tree_insert(tree, boxes[i], (void *)i);
+    }
+    // Moving and removing objects keeps the tree balanced
+    for (size_t i = 0; i < COUNT; i += 2)
+    {
+        double x = rand() % 1000;
+        double y = rand() % 1000;
+        boxes[i] = make_box(x, y, x + 10, y + 10);
+        aabb_tree_move(tree, proxies[i], boxes[i]);
+    }
+    for (size_t i = 0; i < COUNT; i += 5)
+    {
+        aabb_tree_remove(tree, proxies[i]);
+        proxies[i] = AABB_TREE_NULL;
+    }
+    assert(aabb_tree_size(tree) == COUNT - COUNT / 5);
+    assert(aabb_tree_height(tree) <= 2 * log2(COUNT) + 1);
+
+    for (size_t round = 0; round < 20; round++)
+    {
+        double x = rand() % 1000;
+        double y = rand() % 1000;
+        aabb_t query = make_box(x, y, x + 100, y + 50);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            seen[i] = false;
+        }
+        query_count_t count = {.found = 0, .seen = seen, .stop_after = 0};
+        aabb_tree_query(tree, query, count_found, &count);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            bool expected =
+                proxies[i] != AABB_TREE_NULL &&
+                aabb_overlaps(aabb_tree_get_fat_box(tree, proxies[i]), query);
+            assert(seen[i] == expected);
+            // Every object's box is in its fat box
+            if (proxies[i] != AABB_TREE_NULL)
+            {
+                assert(aabb_contains(aabb_tree_get_fat_box(tree, proxies[i]),
+                                     boxes[i]));
+            }
+        }
+    }
+
+    // Queries stop when asked to
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        seen[i] = false;
+    }
+    query_count_t count = {.found = 0, .seen = seen, .stop_after = 3};
+    aabb_tree_query(tree, make_box(0, 0, 1000, 1000), count_found, &count);
+    assert(count.found == 3);
+
+    free(seen);
+    free(proxies);
+    free(boxes);
+    aabb_tree_free(tree);
+}
+
+typedef struct nested_query
+{
+    aabb_tree_t *tree;
+    size_t outer;
+    size_t inner;
+} nested_query_t;
+
+bool count_inner(void *aux, size_t proxy, void *data)
+{
+    nested_query_t *query = aux;
+    query->inner++;
+    return true;
+}
+
+bool query_again(void *aux, size_t proxy, void *data)
+{
+    nested_query_t *query = aux;
+    query->outer++;
+    // Searches the whole tree from inside the outer query
+    aabb_tree_query(query->tree, make_box(-1, -1, 1000, 1000), count_inner,
+                    query);
+    return true;
+}
+
+void test_aabb_tree_nested_query()
+{
+    const size_t COUNT = 200;
+    aabb_tree_t *tree = aabb_tree_init(0);
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        double x = 5.0 * (i % 20);
+        double y = 5.0 * (i / 20);
+        aabb_tree_insert(tree, make_box(x, y, x + 1, y + 1), NULL);
+    }
+    nested_query_t query = {.tree = tree, .outer = 0, .inner = 0};
+    aabb_tree_query(tree, make_box(-1, -1, 1000, 1000), query_again, &query);
+    assert(query.outer == COUNT);
+    assert(query.inner == COUNT * COUNT);
+    aabb_tree_free(tree);
+}
+
+/** Treats each object as a circle of radius 1 around its data's x */
+double ray_hits_circle(void *aux, size_t proxy, void *data)
+{
+    size_t *tests = aux;
+    (*tests)++;
+    double center = (double)(size_t)data;
+    // The rays in the test run along y = 0 from x = 0
+    return center - 1;
+}
+
+void test_aabb_tree_raycast()
+{
+    aabb_tree_t *tree = aabb_tree_init(0);
+    for (size_t x = 10; x <= 100; x += 10)
+    {
+        aabb_tree_insert(tree, make_box(x - 1, -1, x + 1, 1), (void *)x);
+        // Off the ray's path
+        aabb_tree_insert(tree, make_box(x - 1, 9, x + 1, 11), (void *)x);
+    }
+    size_t tests = 0;
+    double distance = -1;
+    size_t hit = aabb_tree_raycast(tree, VEC_ZERO, (vector_t){1, 0}, 1000,
+                                   ray_hits_circle, &tests, &distance);
+    assert(hit != AABB_TREE_NULL);
+    assert(aabb_tree_get_data(tree, hit) == (void *)10);
+    assert(isclose(distance, 9));
+    assert(tests >= 1 && tests <= 10);
+
+    // Too short to reach anything
+    distance = -1;
+    hit = aabb_tree_raycast(tree, VEC_ZERO, (vector_t){1, 0}, 5,
+                            ray_hits_circle, &tests, &distance);
+    assert(hit == AABB_TREE_NULL);
+    assert(distance == -1);
+    // Pointing away
+    hit = aabb_tree_raycast(tree, VEC_ZERO, (vector_t){-1, 0}, 1000,
+                            ray_hits_circle, &tests, NULL);
+    assert(hit == AABB_TREE_NULL);
+    aabb_tree_free(tree);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_aabb_tree_insert_remove)
+    DO_TEST(test_aabb_tree_move)
+    DO_TEST(test_aabb_tree_query_matches_brute_force)
+    DO_TEST(test_aabb_tree_nested_query)
+    DO_TEST(test_aabb_tree_raycast)
+
+    puts("aabb_tree_test PASS");
+}
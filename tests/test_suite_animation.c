@@ -0,0 +1,68 @@
+#include "animation.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_animation_frames()
+{
+    animation_t *animation = animation_init(3);
+    assert(animation_frame_count(animation) == 0);
+    animation_add_frame(animation, "a.png");
+    animation_add_frame(animation, "b.png");
+    assert(animation_frame_count(animation) == 2);
+    assert(strcmp(animation_get_frame(animation, 0), "a.png") == 0);
+    assert(strcmp(animation_get_frame(animation, 1), "b.png") == 0);
+    animation_free(animation);
+}
+
+void test_animation_frame_at()
+{
+    animation_t *animation = animation_init(2);
+    animation_add_frame(animation, "a.png");
+    animation_add_frame(animation, "b.png");
+    animation_add_frame(animation, "c.png");
+    size_t expected[] = {0, 0, 1, 1, 2, 2, 0, 0, 1};
+    for (size_t tick = 0; tick < sizeof(expected) / sizeof(*expected); tick++)
+    {
+        assert(animation_frame_at(animation, tick) == expected[tick]);
+    }
+    animation_free(animation);
+
+    animation_t *still = animation_init(1);
+    animation_add_frame(still, "idle.png");
+    assert(animation_frame_at(still, 0) == 0);
+    assert(animation_frame_at(still, 12345) == 0);
+    animation_free(still);
+}
+
+void test_animation_frame_handles()
+{
+    animation_t *animation = animation_init(1);
+    animation_add_frame(animation, "a.png");
+    animation_add_frame(animation, "b.png");
+    assert(animation_get_frame_handle(animation, 0) == ANIMATION_NO_HANDLE);
+    assert(animation_get_frame_handle(animation, 1) == ANIMATION_NO_HANDLE);
+    animation_set_frame_handle(animation, 1, 7);
+    assert(animation_get_frame_handle(animation, 0) == ANIMATION_NO_HANDLE);
+    assert(animation_get_frame_handle(animation, 1) == 7);
+    animation_free(animation);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_animation_frames)
+    DO_TEST(test_animation_frame_at)
+    DO_TEST(test_animation_frame_handles)
+
+    puts("animation_test PASS");
+}
@@ -0,0 +1,146 @@
+#include "asset_bundle.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char TEST_BUNDLE[] = "test_suite_asset_bundle.tmp";
+
+void test_bundle_round_trip()
+{
+    uint8_t pixels[2 * 3 * 4];
+    for (size_t i = 0; i < sizeof(pixels); i++)
+    {
+        pixels[i] = i;
+    }
+    const char font[] = "not really a font";
+    bundle_asset_t assets[] = {
+        {.type = ASSET_IMAGE, .path = "a.png", .width = 2, .height = 3,
+         .data = pixels, .size = sizeof(pixels)},
+        {.type = ASSET_FONT, .path = "b.ttf", .data = font,
+         .size = sizeof(font)},
+    };
+    assert(asset_bundle_write(TEST_BUNDLE, assets, 2));
+
+    asset_bundle_t *bundle = asset_bundle_open(TEST_BUNDLE);
+    assert(bundle != NULL);
+    assert(asset_bundle_size(bundle) == 2);
+    bundle_asset_t image = asset_bundle_get(bundle, 0);
+    assert(image.type == ASSET_IMAGE);
+    assert(strcmp(image.path, "a.png") == 0);
+    assert(image.width == 2 && image.height == 3);
+    assert(image.size == sizeof(pixels));
+    assert(memcmp(image.data, pixels, sizeof(pixels)) == 0);
+    // Data is aligned for wide loads
+    assert((uintptr_t)image.data % 16 == 0);
+
+    bundle_asset_t found;
+    assert(asset_bundle_find(bundle, "b.ttf", &found));
+    assert(found.type == ASSET_FONT);
+    assert(found.size == sizeof(font));
+    assert(memcmp(found.data, font, sizeof(font)) == 0);
+    assert((uintptr_t)found.data % 16 == 0);
+    assert(!asset_bundle_find(bundle, "c.png", &found));
+    asset_bundle_close(bundle);
+    remove(TEST_BUNDLE);
+}
+
+void test_bundle_empty()
+{
+    assert(asset_bundle_write(TEST_BUNDLE, NULL, 0));
+    asset_bundle_t *bundle = asset_bundle_open(TEST_BUNDLE);
+    assert(bundle != NULL);
+    assert(asset_bundle_size(bundle) == 0);
+    asset_bundle_close(bundle);
+    remove(TEST_BUNDLE);
+}
+
+void test_bundle_rejects_bad_assets()
+{
+    uint8_t pixels[4] = {0};
+    bundle_asset_t wrong_size = {.type = ASSET_IMAGE, .path = "a.png",
+                                 .width = 2, .height = 2, .data = pixels,
+                                 .size = sizeof(pixels)};
+    assert(!asset_bundle_write(TEST_BUNDLE, &wrong_size, 1));
+
+    char long_path[200];
+    memset(long_path, 'a', sizeof(long_path) - 1);
+    long_path[sizeof(long_path) - 1] = '\0';
+    bundle_asset_t long_name = {.type = ASSET_FONT, .path = long_path,
+                                .data = pixels, .size = sizeof(pixels)};
+    assert(!asset_bundle_write(TEST_BUNDLE, &long_name, 1));
+}
+
+void test_bundle_rejects_bad_files()
+{
+    assert(asset_bundle_open("no/such/bundle") == NULL);
+
+    FILE *file = fopen(TEST_BUNDLE, "wb");
+    assert(file != NULL);
+    fputs("image a.png\n", file);
+    fclose(file);
+    assert(asset_bundle_open(TEST_BUNDLE) == NULL);
+
+    // A bundle cut short must not be read past its end
+    uint8_t pixels[64 * 64 * 4] = {0};
+    bundle_asset_t image = {.type = ASSET_IMAGE, .path = "a.png", .width = 64,
+                            .height = 64, .data = pixels,
+                            .size = sizeof(pixels)};
+    assert(asset_bundle_write(TEST_BUNDLE, &image, 1));
+    file = fopen(TEST_BUNDLE, "r+b");
+    assert(file != NULL);
+    uint8_t header[512];
+    size_t read = fread(header, 1, sizeof(header), file);
+    fclose(file);
+    file = fopen(TEST_BUNDLE, "wb");
+    fwrite(header, 1, read, file);
+    fclose(file);
+    assert(asset_bundle_open(TEST_BUNDLE) == NULL);
+    remove(TEST_BUNDLE);
+}
+
+void test_read_file()
+{
+    size_t size = 1;
+    assert(asset_read_file("no/such/file", &size) == NULL);
+    assert(size == 0);
+
+    FILE *file = fopen(TEST_BUNDLE, "wb");
+    assert(file != NULL);
+    fclose(file);
+    size = 1;
+    assert(asset_read_file(TEST_BUNDLE, &size) == NULL);
+    assert(size == 0);
+
+    file = fopen(TEST_BUNDLE, "wb");
+    fputs("font b.ttf 12\n", file);
+    fclose(file);
+    char *data = asset_read_file(TEST_BUNDLE, &size);
+    assert(data != NULL);
+    assert(size == strlen("font b.ttf 12\n"));
+    assert(memcmp(data, "font b.ttf 12\n", size) == 0);
+    free(data);
+    remove(TEST_BUNDLE);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_bundle_round_trip)
+    DO_TEST(test_bundle_empty)
+    DO_TEST(test_bundle_rejects_bad_assets)
+    DO_TEST(test_bundle_rejects_bad_files)
+    DO_TEST(test_read_file)
+
+    puts("asset_bundle_test PASS");
+}
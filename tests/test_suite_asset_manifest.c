@@ -0,0 +1,84 @@
+#include "asset_manifest.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_manifest_parse()
+{
+    asset_manifest_t *manifest = asset_manifest_parse(
+        "# Startup assets\n"
+        "image a.png\n"
+        "\n"
+        "   font  b.ttf 24\r\n"
+        "image c/d.png");
+    assert(asset_manifest_size(manifest) == 3);
+    assert(asset_manifest_get_type(manifest, 0) == ASSET_IMAGE);
+    assert(strcmp(asset_manifest_get_path(manifest, 0), "a.png") == 0);
+    assert(asset_manifest_get_point_size(manifest, 0) == 0);
+    assert(asset_manifest_get_type(manifest, 1) == ASSET_FONT);
+    assert(strcmp(asset_manifest_get_path(manifest, 1), "b.ttf") == 0);
+    assert(asset_manifest_get_point_size(manifest, 1) == 24);
+    assert(strcmp(asset_manifest_get_path(manifest, 2), "c/d.png") == 0);
+    asset_manifest_free(manifest);
+}
+
+void test_manifest_skips_invalid_lines()
+{
+    asset_manifest_t *manifest = asset_manifest_parse("sound a.wav\n"
+                                                      "image\n"
+                                                      "image a.png extra\n"
+                                                      "font b.ttf\n"
+                                                      "font b.ttf 0\n"
+                                                      "image c.png\n");
+    assert(asset_manifest_size(manifest) == 1);
+    assert(strcmp(asset_manifest_get_path(manifest, 0), "c.png") == 0);
+    asset_manifest_free(manifest);
+}
+
+void test_manifest_find()
+{
+    asset_manifest_t *manifest =
+        asset_manifest_parse("image a.png\nfont b.ttf 10\n");
+    assert(asset_manifest_find(manifest, "a.png") == 0);
+    assert(asset_manifest_find(manifest, "b.ttf") == 1);
+    assert(asset_manifest_find(manifest, "c.png") == ASSET_MANIFEST_NOT_FOUND);
+    asset_manifest_free(manifest);
+}
+
+void test_manifest_load()
+{
+    assert(asset_manifest_load("no/such/manifest") == NULL);
+
+    // Every asset the game loads must exist
+    asset_manifest_t *manifest = asset_manifest_load("game/assets.manifest");
+    assert(manifest != NULL);
+    assert(asset_manifest_size(manifest) > 0);
+    for (size_t i = 0; i < asset_manifest_size(manifest); i++)
+    {
+        FILE *file = fopen(asset_manifest_get_path(manifest, i), "rb");
+        assert(file != NULL);
+        fclose(file);
+    }
+    asset_manifest_free(manifest);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_manifest_parse)
+    DO_TEST(test_manifest_skips_invalid_lines)
+    DO_TEST(test_manifest_find)
+    DO_TEST(test_manifest_load)
+
+    puts("asset_manifest_test PASS");
+}
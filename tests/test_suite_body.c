@@ -1,4 +1,5 @@
 #include "body.h"
+#include "sprite.h"
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
@@ -249,6 +250,144 @@ void test_body_info_freer()
     body_free(body);
 }
 
+void test_body_static_background()
+{
+    body_t *body1 = body_init(sprite_make_rect(0, 1, 0, 1), 1,
+                              (rgb_color_t){0, 0, 0});
+    body_t *body2 = body_init(sprite_make_rect(0, 1, 0, 1), 1,
+                              (rgb_color_t){0, 0, 0});
+    assert(body_get_id(body1) != body_get_id(body2));
+    assert(!body_is_static_background(body1));
+    body_set_static_background(body1, true);
+    assert(body_is_static_background(body1));
+    assert(!body_is_static_background(body2));
+    body_set_static_background(body1, false);
+    assert(!body_is_static_background(body1));
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_body_render_layer()
+{
+    body_t *body = body_init(sprite_make_rect(0, 1, 0, 1), 1,
+                             (rgb_color_t){0, 0, 0});
+    assert(body_get_render_layer(body) == 0);
+    body_set_render_layer(body, 3);
+    assert(body_get_render_layer(body) == 3);
+    body_set_render_layer(body, -2);
+    assert(body_get_render_layer(body) == -2);
+    body_free(body);
+}
+
+void test_body_circle_lod()
+{
+    body_t *body = body_init(sprite_make_circle(5), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(body, (vector_t){10, 20});
+    assert(body_get_circle_radius(body) == 0);
+    body_set_circle_lod(body, 5);
+    assert(body_get_circle_radius(body) == 5);
+    assert(body_vertex_count(body) == SPRITE_CIRCLE_PROXY_POINTS);
+    assert(vec_isclose(body_get_centroid(body), (vector_t){10, 20}));
+    for (size_t i = 0; i < SPRITE_CIRCLE_PROXY_POINTS; i++)
+    {
+        vector_t offset = vec_subtract(body_get_vertex(body, i),
+                                       (vector_t){10, 20});
+        assert(isclose(vec_magnitude(offset), 5));
+    }
+    // The proxy moves with the body
+    body_set_centroid(body, (vector_t){0, 0});
+    assert(vec_isclose(body_get_vertex(body, 0), (vector_t){5, 0}));
+    body_free(body);
+}
+
+void test_body_shared_shape()
+{
+    rgb_color_t black = {0, 0, 0};
+    body_t *first = body_init(sprite_make_rect(0, 2, 0, 2), 1, black);
+    body_t *second = body_init(sprite_make_rect(4, 6, 0, 2), 1, black);
+    assert(body_get_local_shape(first) == body_get_local_shape(second));
+    // Rotating one body does not move the other's vertices
+    body_set_rotation(first, M_PI / 2);
+    assert(vec_isclose(body_get_vertex(first, 0), (vector_t){0, 2}));
+    assert(vec_isclose(body_get_vertex(second, 0), (vector_t){6, 2}));
+
+    shape_t *shape = shape_intern_circle(3, 8);
+    body_t *third = body_init_with_shape(shape, (vector_t){10, 10}, 1, black,
+                                         NULL, NULL);
+    assert(shape_refs(shape) == 2);
+    assert(vec_isclose(body_get_centroid(third), (vector_t){10, 10}));
+    assert(vec_isclose(body_get_vertex(third, 0), (vector_t){13, 10}));
+    body_free(third);
+    assert(shape_refs(shape) == 1);
+    shape_release(shape);
+    body_free(first);
+    body_free(second);
+}
+
+void test_body_aabb()
+{
+    body_t *body =
+        body_init(sprite_make_rect(0, 4, 0, 2), 1, (rgb_color_t){0, 0, 0});
+    aabb_t box = body_get_aabb(body);
+    assert(vec_isclose(box.min, (vector_t){0, 0}));
+    assert(vec_isclose(box.max, (vector_t){4, 2}));
+    SDL_Rect rect = body_get_bounding_rect(body);
+    assert(rect.x == 0 && rect.y == 0 && rect.w == 4 && rect.h == 2);
+
+    // The box follows the body as it moves and turns
+    body_set_centroid(body, (vector_t){10, 10});
+    box = body_get_aabb(body);
+    assert(vec_isclose(box.min, (vector_t){8, 9}));
+    assert(vec_isclose(box.max, (vector_t){12, 11}));
+    body_set_rotation(body, M_PI / 2);
+    box = body_get_aabb(body);
+    assert(vec_isclose(box.min, (vector_t){9, 8}));
+    assert(vec_isclose(box.max, (vector_t){11, 12}));
+    body_set_velocity(body, (vector_t){1, 0});
+    body_tick(body, 2);
+    box = body_get_aabb(body);
+    assert(vec_isclose(box.min, (vector_t){11, 8}));
+    assert(vec_isclose(box.max, (vector_t){13, 12}));
+
+    // and when its shape changes
+    body_set_circle_lod(body, 3);
+    box = body_get_aabb(body);
+    assert(isclose(box.max.x, 15));
+    assert(box.min.x >= 9 && box.min.x < 9.1);
+    body_free(body);
+}
+
+void test_body_shape_view()
+{
+    body_t *body =
+        body_init(sprite_make_rect(0, 4, 0, 2), 1, (rgb_color_t){0, 0, 0});
+    polygon_view_t view = body_get_shape_view(body);
+    list_t *shape = body_get_shape(body);
+    assert(view.count == list_size(shape));
+    for (size_t i = 0; i < view.count; i++)
+    {
+        assert(vec_isclose(view.vertices[i], *(vector_t *)list_get(shape, i)));
+    }
+    list_free(shape);
+    assert(isclose(polygon_view_area(view), 8));
+    assert(vec_isclose(polygon_view_centroid(view), (vector_t){2, 1}));
+
+    // Moving the body places the vertices again
+    body_set_centroid(body, (vector_t){10, 10});
+    view = body_get_shape_view(body);
+    assert(vec_isclose(polygon_view_centroid(view), (vector_t){10, 10}));
+    body_set_rotation(body, M_PI / 2);
+    view = body_get_shape_view(body);
+    aabb_t box = body_get_aabb(body);
+    for (size_t i = 0; i < view.count; i++)
+    {
+        assert(view.vertices[i].x >= box.min.x - 1e-7 &&
+               view.vertices[i].x <= box.max.x + 1e-7);
+    }
+    assert(vec_isclose(polygon_view_centroid(view), (vector_t){10, 10}));
+    body_free(body);
+}
+
 int main(int argc, char *argv[])
 {
     // Run all tests if there are no command-line arguments
@@ -268,6 +407,12 @@ int main(int argc, char *argv[])
     DO_TEST(test_body_remove)
     DO_TEST(test_body_info)
     DO_TEST(test_body_info_freer)
+    DO_TEST(test_body_static_background)
+    DO_TEST(test_body_render_layer)
+    DO_TEST(test_body_circle_lod)
+    DO_TEST(test_body_shared_shape)
+    DO_TEST(test_body_aabb)
+    DO_TEST(test_body_shape_view)
 
     puts("body_test PASS");
 }
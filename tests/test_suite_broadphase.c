@@ -0,0 +1,174 @@
+#include "broadphase.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+aabb_t make_box(double min_x, double min_y, double max_x, double max_y)
+{
+    return (aabb_t){.min = {min_x, min_y}, .max = {max_x, max_y}};
+}
+
+void test_aabb_overlaps()
+{
+    aabb_t box = make_box(0, 0, 10, 10);
+    assert(aabb_overlaps(box, make_box(5, 5, 15, 15)));
+    assert(aabb_overlaps(box, make_box(2, 2, 3, 3)));
+    // Touching edges count
+    assert(aabb_overlaps(box, make_box(10, 0, 20, 10)));
+    assert(!aabb_overlaps(box, make_box(11, 0, 20, 10)));
+    assert(!aabb_overlaps(box, make_box(0, -5, 10, -1)));
+}
+
+void test_broadphase_pairs()
+{
+    broadphase_t *broadphase = broadphase_init(10);
+    assert(broadphase_add(broadphase, make_box(0, 0, 4, 4)) == 0);
+    assert(broadphase_add(broadphase, make_box(100, 100, 104, 104)) == 1);
+    assert(broadphase_add(broadphase, make_box(3, 3, 6, 6)) == 2);
+    // Spans many cells, including all of box 0's and box 2's
+    assert(broadphase_add(broadphase, make_box(-35, -35, 45, 45)) == 3);
+    assert(broadphase_size(broadphase) == 4);
+
+    assert(broadphase_find_pairs(broadphase) == 3);
+    broadphase_pair_t *pairs = broadphase_get_pairs(broadphase);
+    assert(pairs[0].first == 0 && pairs[0].second == 2);
+    assert(pairs[1].first == 0 && pairs[1].second == 3);
+    assert(pairs[2].first == 2 && pairs[2].second == 3);
+    assert(broadphase_has_pair(broadphase, 2, 0));
+    assert(broadphase_has_pair(broadphase, 3, 2));
+    assert(!broadphase_has_pair(broadphase, 0, 1));
+    assert(!broadphase_has_pair(broadphase, 1, 3));
+
+    broadphase_clear(broadphase);
+    assert(broadphase_size(broadphase) == 0);
+    assert(broadphase_find_pairs(broadphase) == 0);
+    assert(!broadphase_has_pair(broadphase, 0, 2));
+    broadphase_free(broadphase);
+}
+
+void test_broadphase_large_boxes()
+{
+    broadphase_t *broadphase = broadphase_init(1);
+    // Far too many cells to hash, like a wall across the whole arena
+    broadphase_add(broadphase, make_box(-1000, 0, 1000, 1000));
+    broadphase_add(broadphase, make_box(500, 500, 501, 501));
+    broadphase_add(broadphase, make_box(0, -10, 1, -9));
+    broadphase_add(broadphase, make_box(-INFINITY, 999, INFINITY, 2000));
+    assert(broadphase_find_pairs(broadphase) == 2);
+    assert(broadphase_has_pair(broadphase, 0, 1));
+    assert(broadphase_has_pair(broadphase, 0, 3));
+    assert(!broadphase_has_pair(broadphase, 0, 2));
+    assert(!broadphase_has_pair(broadphase, 1, 3));
+    broadphase_free(broadphase);
+}
+
+void check_matches_brute_force(broadphase_mode_t mode)
+{
+    srand(21);
+    broadphase_t *broadphase = broadphase_init(0);
+    broadphase_set_mode(broadphase, mode);
+    assert(broadphase_get_mode(broadphase) == mode);
+    const size_t COUNT = 300;
+    aabb_t *boxes = malloc(COUNT * sizeof(aabb_t));
+    for (size_t round = 0; round < 3; round++)
+    {
+        broadphase_clear(broadphase);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            double x = rand() % 2000 - 1000;
+            double y = rand() % 2000 - 1000;
+            double size = rand() % 200 + 0.5;
+            boxes[i] = make_box(x, y, x + size, y + size / 2);
+            broadphase_add(broadphase, boxes[i]);
+        }
+        size_t expected = 0;
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            for (size_t j = i + 1; j < COUNT; j++)
+            {
+                expected += aabb_overlaps(boxes[i], boxes[j]);
+            }
+        }
+        assert(broadphase_find_pairs(broadphase) == expected);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            for (size_t j = i + 1; j < COUNT; j++)
+            {
+                assert(broadphase_has_pair(broadphase, i, j) ==
+                       aabb_overlaps(boxes[i], boxes[j]));
+            }
+        }
+    }
+    free(boxes);
+    broadphase_free(broadphase);
+}
+
+void test_broadphase_matches_brute_force()
+{
+    check_matches_brute_force(BROADPHASE_GRID);
+    check_matches_brute_force(BROADPHASE_SWEEP_AND_PRUNE);
+}
+
+void test_sweep_and_prune_across_ticks()
+{
+    broadphase_t *broadphase = broadphase_init(0);
+    broadphase_set_mode(broadphase, BROADPHASE_SWEEP_AND_PRUNE);
+    aabb_t boxes[21];
+    // A row of boxes sliding past a column of boxes, one tick at a time
+    for (size_t tick = 0; tick < 40; tick++)
+    {
+        broadphase_clear(broadphase);
+        size_t count = 0;
+        for (size_t i = 0; i < 10; i++)
+        {
+            double x = 10.0 * i + 2.0 * tick;
+            boxes[count++] = make_box(x, 0, x + 5, 5);
+        }
+        for (size_t i = 0; i < 10; i++)
+        {
+            double y = 10.0 * i - 50;
+            boxes[count++] = make_box(60, y, 65, y + 5);
+        }
+        // Boxes come and go, so the order is sometimes rebuilt
+        if (tick % 7 == 3)
+        {
+            boxes[count++] = make_box(-100, -100, 200, 1);
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            broadphase_add(broadphase, boxes[i]);
+        }
+
+        broadphase_find_pairs(broadphase);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t j = i + 1; j < count; j++)
+            {
+                assert(broadphase_has_pair(broadphase, i, j) ==
+                       aabb_overlaps(boxes[i], boxes[j]));
+            }
+        }
+    }
+    broadphase_free(broadphase);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_aabb_overlaps)
+    DO_TEST(test_broadphase_pairs)
+    DO_TEST(test_broadphase_large_boxes)
+    DO_TEST(test_broadphase_matches_brute_force)
+    DO_TEST(test_sweep_and_prune_across_ticks)
+
+    puts("broadphase_test PASS");
+}
@@ -10,8 +10,10 @@ const int RADIUS = 10;
 
 void test_collision()
 {
+    // body_init() frees the list it is given, so keep a copy to compare
     list_t *star = sprite_make_star(10, 10, 20);
     body_t *b = body_init(star, 2, rgb_init_random_bright());
+    star = body_get_shape(b);
 
     // Tests the same shape overlaps
     assert(find_collision(star, star).collided);
@@ -45,9 +47,28 @@ void test_collision()
 
     list_free(circle);
     list_free(circle2);
+    list_free(star);
     body_free(b);
 }
 
+void test_collision_large_polygons()
+{
+    // More vertices than find_collision() copies onto the stack
+    list_t *circle = sprite_make_circle_points(RADIUS, 100);
+    list_t *circle2 = sprite_make_circle_points(RADIUS, 100);
+    list_t *small = sprite_make_circle_points(RADIUS, 8);
+    polygon_translate(circle2, (vector_t){.x = 2 * RADIUS - 1, .y = 0});
+    polygon_translate(small, (vector_t){.x = 2 * RADIUS - 1, .y = 0});
+    assert(find_collision(circle, circle2).collided);
+    assert(find_collision(circle, small).collided);
+    assert(find_collision(small, circle).collided);
+    polygon_translate(circle2, (vector_t){.x = 2, .y = 0});
+    assert(!find_collision(circle, circle2).collided);
+    list_free(circle);
+    list_free(circle2);
+    list_free(small);
+}
+
 int main(int argc, char *argv[])
 {
     // Run all tests? True if there are no command-line arguments
@@ -60,6 +81,7 @@ int main(int argc, char *argv[])
     }
 
     DO_TEST(test_collision)
+    DO_TEST(test_collision_large_polygons)
 
     puts("test_collision PASS");
 }
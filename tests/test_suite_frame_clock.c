@@ -0,0 +1,48 @@
+#include "frame_clock.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+const double WAIT_TIME = 0.01;
+
+void test_frame_clock_monotonic()
+{
+    double previous = frame_clock_now();
+    for (int i = 0; i < 1000; i++)
+    {
+        double now = frame_clock_now();
+        assert(now >= previous);
+        previous = now;
+    }
+}
+
+void test_frame_clock_tick()
+{
+    frame_clock_t *clock = frame_clock_init();
+    assert(frame_clock_tick(clock) == 0);
+
+    double start = frame_clock_now();
+    while (frame_clock_now() - start < WAIT_TIME)
+    {
+    }
+    assert(frame_clock_tick(clock) >= WAIT_TIME);
+    assert(frame_clock_tick(clock) >= 0);
+    frame_clock_free(clock);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests? True if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_frame_clock_monotonic)
+    DO_TEST(test_frame_clock_tick)
+
+    puts("frame_clock_test PASS");
+}
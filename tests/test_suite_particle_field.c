@@ -0,0 +1,134 @@
+#include "particle_field.h"
+#include "scene.h"
+#include "sprite.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const rgb_color_t WHITE = {1, 1, 1};
+
+void test_particle_field_add()
+{
+    particle_field_t *field = particle_field_init();
+    assert(particle_field_size(field) == 0);
+    assert(vec_isclose(particle_field_get_origin(field), VEC_ZERO));
+    size_t version = particle_field_get_version(field);
+
+    // Enough particles to grow the array a few times
+    for (size_t i = 0; i < 1000; i++)
+    {
+        particle_field_add(field, (vector_t){i, 2 * i}, 1.5, WHITE);
+    }
+    assert(particle_field_size(field) == 1000);
+    assert(particle_field_get_version(field) != version);
+    particle_t *particles = particle_field_get_particles(field);
+    for (size_t i = 0; i < 1000; i++)
+    {
+        assert(vec_isclose(particles[i].position, (vector_t){i, 2 * i}));
+        assert(isclose(particles[i].size, 1.5));
+    }
+    particle_field_free(field);
+}
+
+void test_particle_field_moves_origin()
+{
+    particle_field_t *field = particle_field_init();
+    particle_field_add(field, (vector_t){1, 1}, 1, WHITE);
+    particle_field_set_velocity(field, (vector_t){10, 0});
+    particle_field_tick(field, 0.5);
+    assert(vec_isclose(particle_field_get_origin(field), (vector_t){5, 0}));
+    // Particles are stored relative to the origin, so they did not change
+    particle_t *particle = particle_field_get_particles(field);
+    assert(vec_isclose(particle->position, (vector_t){1, 1}));
+
+    // Particles added later are placed where they are asked to be
+    particle_field_add(field, (vector_t){6, 1}, 1, WHITE);
+    particle = &particle_field_get_particles(field)[1];
+    assert(vec_isclose(particle->position, (vector_t){1, 1}));
+    particle_field_free(field);
+}
+
+void test_particle_field_remove_outside()
+{
+    particle_field_t *field = particle_field_init();
+    for (size_t i = 0; i < 10; i++)
+    {
+        particle_field_add(field, (vector_t){10 * i, 0}, 1, WHITE);
+    }
+    size_t version = particle_field_get_version(field);
+    // The particle at x = 40 reaches into the rectangle, so it is kept
+    size_t removed = particle_field_remove_outside(
+        field, (vector_t){-5, -5}, (vector_t){39.5, 5});
+    assert(removed == 5);
+    assert(particle_field_size(field) == 5);
+    assert(particle_field_get_version(field) != version);
+    particle_t *particles = particle_field_get_particles(field);
+    for (size_t i = 0; i < 5; i++)
+    {
+        assert(vec_isclose(particles[i].position, (vector_t){10 * i, 0}));
+    }
+
+    version = particle_field_get_version(field);
+    assert(particle_field_remove_outside(field, (vector_t){-5, -5},
+                                         (vector_t){100, 5}) == 0);
+    assert(particle_field_get_version(field) == version);
+    particle_field_free(field);
+}
+
+vector_t camera_offset(body_t *focal_body, void *aux)
+{
+    return vec_negate(body_get_centroid(focal_body));
+}
+
+vector_t camera_mover(vector_t offset, body_t *body)
+{
+    return body_get_camera_mode(body) == SCENE ? offset : VEC_ZERO;
+}
+
+void test_particle_field_in_scene()
+{
+    scene_t *scene = scene_init();
+    body_t *focus = body_init(sprite_make_rect(0, 2, 0, 2), 1, WHITE);
+    body_set_camera_mode(focus, SCENE);
+    scene_add_body(scene, focus);
+    scene_add_camera_management(scene, camera_offset, camera_mover, NULL,
+                                NULL);
+    scene_set_focal_body(scene, focus);
+
+    particle_field_t *moving = particle_field_init();
+    particle_field_set_velocity(moving, (vector_t){1, 0});
+    scene_add_particle_field(scene, moving);
+    particle_field_t *following = particle_field_init();
+    particle_field_set_camera_mode(following, SCENE);
+    scene_add_particle_field(scene, following);
+    assert(scene_particle_fields(scene) == 2);
+    assert(scene_get_particle_field(scene, 1) == following);
+
+    scene_tick(scene, 2);
+    assert(vec_isclose(particle_field_get_origin(moving), (vector_t){2, 0}));
+    // The camera moved the focus from (1, 1) to the origin, and the field
+    // along with it
+    assert(vec_isclose(particle_field_get_origin(following),
+                       (vector_t){-1, -1}));
+    scene_free(scene);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_particle_field_add)
+    DO_TEST(test_particle_field_moves_origin)
+    DO_TEST(test_particle_field_remove_outside)
+    DO_TEST(test_particle_field_in_scene)
+
+    puts("particle_field_test PASS");
+}
@@ -0,0 +1,83 @@
+#include "projection.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const view_t TEST_VIEW = {
+    .center = {500, 250}, .pixel_center = {640, 360}, .scale = 1.37};
+#define MAX_POINTS 37
+
+void test_view_project()
+{
+    assert(vec_isclose(view_project(TEST_VIEW, TEST_VIEW.center),
+                       TEST_VIEW.pixel_center));
+    // y is flipped, and pixels are rounded
+    vector_t pixel = view_project(TEST_VIEW, (vector_t){510, 260});
+    assert(vec_isclose(pixel, (vector_t){654, 346}));
+    // Halfway cases round to even
+    view_t unit = {.center = VEC_ZERO, .pixel_center = VEC_ZERO, .scale = 1};
+    assert(vec_isclose(view_project(unit, (vector_t){2.5, -1.5}),
+                       (vector_t){2, 2}));
+}
+
+/** Checks every kernel against view_project() for arrays of every length */
+void test_view_project_arrays()
+{
+    vector_t points[MAX_POINTS];
+    for (size_t i = 0; i < MAX_POINTS; i++)
+    {
+        points[i] = (vector_t){rand() % 2000 - 500 + rand() / (double)RAND_MAX,
+                               rand() % 1000 - 250 + i * 0.5};
+    }
+
+    for (size_t n = 0; n <= MAX_POINTS; n++)
+    {
+        int16_t xs[MAX_POINTS + 1], ys[MAX_POINTS + 1];
+        // Check that nothing past the end is written
+        xs[n] = ys[n] = 12345;
+        view_project_pixels(TEST_VIEW, points, n, xs, ys);
+        assert(xs[n] == 12345 && ys[n] == 12345);
+
+        float floats[3 * MAX_POINTS];
+        view_project_floats(TEST_VIEW, points, n, floats, 3 * sizeof(float));
+
+        for (size_t i = 0; i < n; i++)
+        {
+            vector_t pixel = view_project(TEST_VIEW, points[i]);
+            assert(xs[i] == pixel.x);
+            assert(ys[i] == pixel.y);
+            assert(fabs(floats[3 * i] - pixel.x) <= 0.5 + 1e-3);
+            assert(fabs(floats[3 * i + 1] - pixel.y) <= 0.5 + 1e-3);
+        }
+    }
+}
+
+void test_view_project_pixels_saturate()
+{
+    vector_t points[] = {{1e6, -1e6}, {-1e9, 1e9}, {0, 0}, {1e300, 0}, {5, 5}};
+    int16_t xs[5], ys[5];
+    view_project_pixels(TEST_VIEW, points, 5, xs, ys);
+    assert(xs[0] == INT16_MAX && ys[0] == INT16_MAX);
+    assert(xs[1] == INT16_MIN && ys[1] == INT16_MIN);
+    assert(xs[3] == INT16_MAX);
+    assert(xs[4] == view_project(TEST_VIEW, points[4]).x);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests? True if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_view_project)
+    DO_TEST(test_view_project_arrays)
+    DO_TEST(test_view_project_pixels_saturate)
+
+    printf("projection_test PASS (%s kernels)\n", projection_kernel());
+}
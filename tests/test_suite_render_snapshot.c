@@ -0,0 +1,347 @@
+#include "render_snapshot.h"
+#include "sprite.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_render_snapshot_bodies()
+{
+    scene_t *scene = scene_init();
+    body_t *square = body_init(sprite_make_rect(0, 2, 0, 2), 1,
+                               (rgb_color_t){1, 0, 0});
+    body_set_static_texture_path(square, "square.png");
+    scene_add_body(scene, square);
+    body_t *rect = body_init(sprite_make_rect(10, 14, 20, 21), 1,
+                                 (rgb_color_t){0, 1, 0});
+    body_set_camera_mode(rect, SCENE);
+    body_set_static_background(rect, true);
+    scene_add_body(scene, rect);
+
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_bodies(snapshot) == 2);
+
+    body_record_t *record = render_snapshot_get_body(snapshot, 0);
+    assert(record->id == body_get_id(square));
+    assert(vec_isclose(record->centroid, (vector_t){1, 1}));
+    assert(vec_isclose(record->min, (vector_t){0, 0}));
+    assert(vec_isclose(record->max, (vector_t){2, 2}));
+    assert(strcmp(record->texture_path, "square.png") == 0);
+    assert(record->vertex_count == 4);
+    assert(!record->static_background);
+
+    record = render_snapshot_get_body(snapshot, 1);
+    assert(record->texture_path == NULL);
+    assert(record->camera_mode == SCENE);
+    assert(record->static_background);
+    assert(isclose(record->color.g, 1));
+    vector_t *vertices = render_snapshot_get_vertices(snapshot, record);
+    for (size_t i = 0; i < record->vertex_count; i++)
+    {
+        assert(vec_isclose(vertices[i], body_get_vertex(rect, i)));
+    }
+
+    // The snapshot keeps the old positions until it is captured again
+    body_set_centroid(square, (vector_t){5, 5});
+    assert(vec_isclose(render_snapshot_get_body(snapshot, 0)->centroid,
+                       (vector_t){1, 1}));
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(vec_isclose(render_snapshot_get_body(snapshot, 0)->centroid,
+                       (vector_t){5, 5}));
+
+    render_snapshot_free(snapshot);
+    scene_free(scene);
+}
+
+void test_render_snapshot_outlives_scene()
+{
+    scene_t *scene = scene_init();
+    for (size_t i = 0; i < 100; i++)
+    {
+        scene_add_body(scene, body_init(sprite_make_circle(3), 1,
+                                        (rgb_color_t){0, 0, 1}));
+    }
+    text_t *text = text_init("SCORE: ", VEC_ZERO, 10, 5, (vector_t){100, 30});
+    scene_add_text(scene, text);
+    size_t version = text_get_version(text);
+
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 0);
+    scene_free(scene);
+
+    assert(render_snapshot_bodies(snapshot) == 100);
+    assert(render_snapshot_texts(snapshot) == 1);
+    text_record_t *record = render_snapshot_get_text(snapshot, 0);
+    assert(record->version == version);
+    assert(strcmp(record->words, "SCORE: ") == 0);
+    assert(record->numbers == 5);
+    assert(record->type == WORDS_STAY);
+    assert(vec_isclose(record->dimensions, (vector_t){100, 30}));
+    render_snapshot_free(snapshot);
+}
+
+void test_render_snapshot_reuses_arrays()
+{
+    scene_t *scene = scene_init();
+    for (size_t i = 0; i < 100; i++)
+    {
+        scene_add_body(scene, body_init(sprite_make_circle(3), 1,
+                                        (rgb_color_t){0, 0, 1}));
+    }
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 0);
+    size_t allocations = render_snapshot_allocations(snapshot);
+    assert(allocations > 0);
+
+    // A scene of the same size or smaller fits in the existing arrays
+    for (size_t i = 0; i < 10; i++)
+    {
+        render_snapshot_capture(snapshot, scene, 0);
+    }
+    scene_remove_body(scene, 0);
+    scene_tick(scene, 0);
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_bodies(snapshot) == 99);
+    assert(render_snapshot_allocations(snapshot) == allocations);
+
+    render_snapshot_free(snapshot);
+    scene_free(scene);
+}
+
+void test_render_snapshot_double_buffered()
+{
+    scene_t *scene = scene_init();
+    for (size_t i = 0; i < 50; i++)
+    {
+        body_t *body = body_init(sprite_make_circle(3), 1,
+                                 (rgb_color_t){0, 0, 1});
+        body_set_velocity(body, (vector_t){1, 0});
+        body_set_static_texture_path(body, i % 2 == 0 ? "a.png" : "b.png");
+        scene_add_body(scene, body);
+    }
+    scene_add_text(scene, text_init("SCORE: ", VEC_ZERO, 10, 5,
+                                    (vector_t){100, 30}));
+
+    // Like sdl_run_simulation(), capture each step into the other snapshot
+    render_snapshot_t *snapshots[2] = {render_snapshot_init(),
+                                       render_snapshot_init()};
+    render_snapshot_capture(snapshots[0], scene, 0);
+    scene_tick(scene, 0.1);
+    render_snapshot_capture(snapshots[1], scene, 1);
+    size_t allocations[2] = {render_snapshot_allocations(snapshots[0]),
+                             render_snapshot_allocations(snapshots[1])};
+    for (size_t frame = 2; frame < 100; frame++)
+    {
+        scene_tick(scene, 0.1);
+        render_snapshot_capture(snapshots[frame % 2], scene, frame);
+    }
+    // A steady scene allocates nothing after the first captures
+    assert(render_snapshot_allocations(snapshots[0]) == allocations[0]);
+    assert(render_snapshot_allocations(snapshots[1]) == allocations[1]);
+
+    render_snapshot_free(snapshots[0]);
+    render_snapshot_free(snapshots[1]);
+    scene_free(scene);
+}
+
+void test_render_snapshot_signature()
+{
+    scene_t *scene = scene_init();
+    body_t *body = body_init(sprite_make_rect(0, 10, 0, 10), 1,
+                             (rgb_color_t){1, 0, 0});
+    scene_add_body(scene, body);
+    text_t *text = text_init("SCORE: ", VEC_ZERO, 10, 5, (vector_t){100, 30});
+    scene_add_text(scene, text);
+
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 0);
+    uint64_t signature = render_snapshot_signature(snapshot);
+    // Nothing changed, so neither did the signature
+    scene_tick(scene, 1);
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_signature(snapshot) == signature);
+
+    body_set_centroid(body, (vector_t){5, 6});
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_signature(snapshot) != signature);
+    signature = render_snapshot_signature(snapshot);
+
+    text_set_numbers(text, 6);
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_signature(snapshot) != signature);
+    signature = render_snapshot_signature(snapshot);
+
+    body_set_color(body, (rgb_color_t){0, 1, 0});
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_signature(snapshot) != signature);
+    signature = render_snapshot_signature(snapshot);
+
+    // A tick too short for a fixed step draws the same frame, but the
+    // snapshot shows that the scene is running
+    size_t tick_calls = render_snapshot_tick_calls(snapshot);
+    assert(scene_tick_fixed(scene, 0.001) == 0);
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_signature(snapshot) == signature);
+    assert(render_snapshot_tick_calls(snapshot) != tick_calls);
+
+    render_snapshot_free(snapshot);
+    scene_free(scene);
+}
+
+void test_render_snapshot_circle()
+{
+    scene_t *scene = scene_init();
+    body_t *body = body_init(sprite_make_circle(4), 1, (rgb_color_t){0, 0, 1});
+    body_set_circle_lod(body, 4);
+    body_set_centroid(body, (vector_t){10, 10});
+    body_set_rotation(body, M_PI / 8);
+    scene_add_body(scene, body);
+
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 0);
+    body_record_t *record = render_snapshot_get_body(snapshot, 0);
+    assert(record->circle_radius == 4);
+    assert(record->vertex_count == SPRITE_CIRCLE_PROXY_POINTS);
+    // The bounds are the circle's, not the rotated proxy's
+    assert(vec_isclose(record->min, (vector_t){6, 6}));
+    assert(vec_isclose(record->max, (vector_t){14, 14}));
+
+    render_snapshot_free(snapshot);
+    scene_free(scene);
+}
+
+void test_render_snapshot_particle_fields()
+{
+    scene_t *scene = scene_init();
+    particle_field_t *field = particle_field_init();
+    particle_field_add(field, (vector_t){1, 2}, 3, (rgb_color_t){1, 1, 1});
+    particle_field_add(field, (vector_t){4, 5}, 6, (rgb_color_t){0, 1, 0});
+    particle_field_set_render_layer(field, -1);
+    particle_field_set_velocity(field, (vector_t){1, 0});
+    scene_add_particle_field(scene, field);
+
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 0);
+    uint64_t signature = render_snapshot_signature(snapshot);
+    assert(render_snapshot_particle_fields(snapshot) == 1);
+    particle_field_record_t *record =
+        render_snapshot_get_particle_field(snapshot, 0);
+    assert(record->id == particle_field_get_id(field));
+    assert(record->layer == -1);
+    assert(record->particle_count == 2);
+    particle_t *particles = render_snapshot_get_particles(snapshot, record);
+    assert(vec_isclose(particles[1].position, (vector_t){4, 5}));
+    assert(isclose(particles[1].size, 6));
+
+    // Moving the field or changing its particles changes the signature
+    scene_tick(scene, 1);
+    render_snapshot_capture(snapshot, scene, 0);
+    record = render_snapshot_get_particle_field(snapshot, 0);
+    assert(vec_isclose(record->origin, (vector_t){1, 0}));
+    assert(render_snapshot_signature(snapshot) != signature);
+    signature = render_snapshot_signature(snapshot);
+    particle_field_add(field, (vector_t){7, 8}, 1, (rgb_color_t){1, 1, 1});
+    render_snapshot_capture(snapshot, scene, 0);
+    assert(render_snapshot_signature(snapshot) != signature);
+
+    render_snapshot_free(snapshot);
+    scene_free(scene);
+}
+
+void test_render_snapshot_owns_strings()
+{
+    scene_t *scene = scene_init();
+    char path[] = "first.png";
+    body_t *body = body_init(sprite_make_rect(0, 2, 0, 2), 1,
+                             (rgb_color_t){1, 0, 0});
+    body_set_static_texture_path(body, path);
+    scene_add_body(scene, body);
+    char words[] = "LIVES: ";
+    text_t *text = text_init(words, VEC_ZERO, 10, 3, (vector_t){100, 30});
+    scene_add_text(scene, text);
+
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 0);
+    // Changing the strings the scene borrows leaves the snapshot alone
+    strcpy(path, "other.png");
+    strcpy(words, "SCORE: ");
+    body_record_t *record = render_snapshot_get_body(snapshot, 0);
+    assert(strcmp(record->texture_path, "first.png") == 0);
+    assert(record->texture_path != path);
+    assert(strcmp(render_snapshot_get_text(snapshot, 0)->words, "LIVES: ") ==
+           0);
+
+    // but a new capture sees them, and they change the signature
+    uint64_t signature = render_snapshot_signature(snapshot);
+    render_snapshot_capture(snapshot, scene, 0);
+    record = render_snapshot_get_body(snapshot, 0);
+    assert(strcmp(record->texture_path, "other.png") == 0);
+    assert(render_snapshot_signature(snapshot) != signature);
+
+    render_snapshot_free(snapshot);
+    scene_free(scene);
+}
+
+void test_render_snapshot_animation()
+{
+    scene_t *scene = scene_init();
+    animation_t *animation = animation_init(2);
+    animation_add_frame(animation, "a.png");
+    animation_add_frame(animation, "b.png");
+    for (size_t i = 0; i < 3; i++)
+    {
+        body_t *body = body_init(sprite_make_rect(0, 2, 0, 2), 1,
+                                 (rgb_color_t){1, 0, 0});
+        body_set_animation(body, animation);
+        scene_add_body(scene, body);
+    }
+
+    // Each animation becomes the path of the frame shown at the given frame
+    render_snapshot_t *snapshot = render_snapshot_init();
+    render_snapshot_capture(snapshot, scene, 1);
+    uint64_t signature = render_snapshot_signature(snapshot);
+    for (size_t i = 0; i < 3; i++)
+    {
+        body_record_t *record = render_snapshot_get_body(snapshot, i);
+        assert(strcmp(record->texture_path, "a.png") == 0);
+    }
+    render_snapshot_capture(snapshot, scene, 2);
+    assert(strcmp(render_snapshot_get_body(snapshot, 2)->texture_path,
+                  "b.png") == 0);
+    assert(render_snapshot_signature(snapshot) != signature);
+    render_snapshot_capture(snapshot, scene, 4);
+    assert(render_snapshot_signature(snapshot) == signature);
+
+    // The animation can go away while the snapshot is drawn
+    scene_free(scene);
+    animation_free(animation);
+    assert(strcmp(render_snapshot_get_body(snapshot, 0)->texture_path,
+                  "a.png") == 0);
+    render_snapshot_free(snapshot);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_render_snapshot_bodies)
+    DO_TEST(test_render_snapshot_outlives_scene)
+    DO_TEST(test_render_snapshot_reuses_arrays)
+    DO_TEST(test_render_snapshot_double_buffered)
+    DO_TEST(test_render_snapshot_signature)
+    DO_TEST(test_render_snapshot_circle)
+    DO_TEST(test_render_snapshot_particle_fields)
+    DO_TEST(test_render_snapshot_owns_strings)
+    DO_TEST(test_render_snapshot_animation)
+
+    puts("render_snapshot_test PASS");
+}
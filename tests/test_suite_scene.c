@@ -251,6 +251,171 @@ void test_reaping()
     scene_free(scene);
 }
 
+typedef struct
+{
+    int calls;
+    int may_collide_calls;
+} collision_count_t;
+void count_collider_calls(void *aux, bool may_collide)
+{
+    collision_count_t *count = aux;
+    count->calls++;
+    count->may_collide_calls += may_collide;
+}
+
+// Tests that collision force creators only may collide while their boxes meet
+void check_collision_creator(broadphase_mode_t mode)
+{
+    scene_t *scene = scene_init();
+    assert(scene_get_broadphase_mode(scene) == BROADPHASE_GRID);
+    scene_set_broadphase_mode(scene, mode);
+    assert(scene_get_broadphase_mode(scene) == mode);
+    body_t *still = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_t *mover = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_t *far = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(mover, (vector_t){-50, 0});
+    body_set_velocity(mover, (vector_t){5, 0});
+    body_set_centroid(far, (vector_t){500, 500});
+    scene_add_body(scene, still);
+    scene_add_body(scene, mover);
+    scene_add_body(scene, far);
+    collision_count_t near_count = {0, 0};
+    collision_count_t far_count = {0, 0};
+    scene_add_collision_creator(scene, still, mover, count_collider_calls,
+                                &near_count, NULL);
+    scene_add_collision_creator(scene, still, far, count_collider_calls,
+                                &far_count, NULL);
+    assert(scene_forces(scene) == 2);
+
+    // The mover's box only meets the still body's at x = 0
+    for (int i = 0; i < 20; i++)
+    {
+        scene_tick(scene, 1);
+    }
+    assert(near_count.calls == 20);
+    if (mode == BROADPHASE_AABB_TREE)
+    {
+        // The trees hold fat boxes, which meet for longer
+        assert(near_count.may_collide_calls >= 1);
+        assert(near_count.may_collide_calls < 10);
+    }
+    else
+    {
+        assert(near_count.may_collide_calls == 1);
+    }
+    assert(far_count.calls == 20);
+    assert(far_count.may_collide_calls == 0);
+
+    // Removing a body removes its collision force creators
+    body_remove(far);
+    scene_tick(scene, 1);
+    assert(scene_forces(scene) == 1);
+    assert(far_count.calls == 21);
+    scene_free(scene);
+}
+
+void test_collision_creator()
+{
+    check_collision_creator(BROADPHASE_GRID);
+    check_collision_creator(BROADPHASE_SWEEP_AND_PRUNE);
+    check_collision_creator(BROADPHASE_AABB_TREE);
+}
+
+bool count_query(body_t *body, void *aux)
+{
+    (*(int *)aux)++;
+    return true;
+}
+
+// Tests finding bodies by box and by ray, as they move and are removed
+void test_scene_queries()
+{
+    scene_t *scene = scene_init();
+    body_t *rock = body_init(make_shape(), INFINITY, (rgb_color_t){0, 0, 0});
+    body_set_movable(rock, false);
+    body_set_centroid(rock, (vector_t){10, 0});
+    body_t *ship = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(ship, (vector_t){20, 0});
+    scene_add_body(scene, rock);
+    scene_add_body(scene, ship);
+
+    int found = 0;
+    scene_query_aabb(scene, (aabb_t){{8, -1}, {12, 1}}, count_query, &found);
+    assert(found == 1);
+    found = 0;
+    scene_query_aabb(scene, (aabb_t){{0, -5}, {30, 5}}, count_query, &found);
+    assert(found == 2);
+
+    double distance;
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){2, 0}, 100, &distance) ==
+           rock);
+    assert(isclose(distance, 9));
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){1, 0}, 5, NULL) == NULL);
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){0, 1}, 100, NULL) ==
+           NULL);
+
+    // The ship moves in front of the rock, and the rock itself moves away
+    body_set_centroid(ship, (vector_t){5, 0});
+    body_set_centroid(rock, (vector_t){100, 100});
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){1, 0}, 100, &distance) ==
+           ship);
+    assert(isclose(distance, 4));
+    found = 0;
+    scene_query_aabb(scene, (aabb_t){{99, 99}, {101, 101}}, count_query,
+                     &found);
+    assert(found == 1);
+
+    // Bodies added later are found, and removed ones are not
+    body_t *late = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_centroid(late, (vector_t){2, 0});
+    scene_add_body(scene, late);
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){1, 0}, 100, NULL) ==
+           late);
+    body_remove(late);
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){1, 0}, 100, NULL) ==
+           ship);
+    scene_tick(scene, 0);
+    assert(scene_bodies(scene) == 2);
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){1, 0}, 100, NULL) ==
+           ship);
+    scene_free(scene);
+}
+
+void test_tick_fixed()
+{
+    scene_t *scene = scene_init();
+    scene_set_fixed_step(scene, 0.25, 4);
+    body_t *body = body_init(make_shape(), 1, (rgb_color_t){0, 0, 0});
+    body_set_velocity(body, (vector_t){1, 0});
+    scene_add_body(scene, body);
+
+    // Part of a step is carried over to the next call
+    assert(isclose(scene_tick_fixed(scene, 0.625), 0.5));
+    assert(vec_isclose(body_get_centroid(body), (vector_t){0.5, 0}));
+    assert(isclose(scene_get_interpolation_alpha(scene), 0.5));
+    assert(isclose(scene_tick_fixed(scene, 0.125), 0.25));
+    assert(isclose(scene_get_interpolation_alpha(scene), 0));
+
+    // At most 4 steps are caught up after a stall
+    assert(isclose(scene_tick_fixed(scene, 10.0625), 1));
+    assert(vec_isclose(body_get_centroid(body), (vector_t){1.75, 0}));
+    assert(isclose(scene_get_interpolation_alpha(scene), 0.25));
+    scene_free(scene);
+}
+
+void test_tick_calls()
+{
+    scene_t *scene = scene_init();
+    assert(scene_get_tick_calls(scene) == 0);
+    scene_tick(scene, 0.1);
+    assert(scene_get_tick_calls(scene) == 1);
+    // A frame too short for a fixed step still counts as a tick
+    size_t calls = scene_get_tick_calls(scene);
+    assert(scene_tick_fixed(scene, 0.001) == 0);
+    assert(scene_get_tick_calls(scene) != calls);
+    scene_free(scene);
+}
+
 int main(int argc, char *argv[])
 {
     // Run all tests if there are no command-line arguments
@@ -267,6 +432,10 @@ int main(int argc, char *argv[])
     DO_TEST(test_force_creator)
     DO_TEST(test_force_creator_aux)
     DO_TEST(test_reaping)
+    DO_TEST(test_collision_creator)
+    DO_TEST(test_scene_queries)
+    DO_TEST(test_tick_fixed)
+    DO_TEST(test_tick_calls)
 
     puts("scene_test PASS");
 }
@@ -0,0 +1,151 @@
+#include "shape.h"
+#include "sprite.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_shape_intern_shares()
+{
+    vector_t square[] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+    size_t interned = shape_interned_count();
+    shape_t *shape = shape_intern(square, 4);
+    assert(shape_interned_count() == interned + 1);
+    assert(shape_vertex_count(shape) == 4);
+    assert(shape_refs(shape) == 1);
+    // The vertices were copied
+    square[0] = (vector_t){5, 5};
+    assert(vec_isclose(shape_get_vertices(shape)[0], (vector_t){1, 1}));
+
+    square[0] = (vector_t){1, 1};
+    shape_t *same = shape_intern(square, 4);
+    assert(same == shape);
+    assert(shape_refs(shape) == 2);
+    assert(shape_interned_count() == interned + 1);
+
+    // Any difference makes a new shape
+    square[2] = (vector_t){-1, -1.5};
+    shape_t *other = shape_intern(square, 4);
+    assert(other != shape);
+    assert(shape_interned_count() == interned + 2);
+    shape_t *fewer = shape_intern(square, 3);
+    assert(fewer != shape && fewer != other);
+
+    shape_release(fewer);
+    shape_release(other);
+    shape_release(same);
+    assert(shape_refs(shape) == 1);
+    shape_release(shape);
+    assert(shape_interned_count() == interned);
+}
+
+void test_shape_released_is_forgotten()
+{
+    vector_t triangle[] = {{0, 0}, {1, 0}, {0, 1}};
+    shape_t *shape = shape_intern(triangle, 3);
+    assert(shape_retain(shape) == shape);
+    shape_release(shape);
+    shape_release(shape);
+    assert(shape_interned_count() == 0);
+    // Interning the same vertices again makes a fresh shape
+    shape = shape_intern(triangle, 3);
+    assert(shape_refs(shape) == 1);
+    shape_release(shape);
+}
+
+void test_shape_intern_many()
+{
+    const size_t COUNT = 1000;
+    shape_t **shapes = malloc(COUNT * sizeof(shape_t *));
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        vector_t triangle[] = {{0, 0}, {i + 1, 0}, {0, 1}};
+        shapes[i] = shape_intern(triangle, 3);
+    }
+    assert(shape_interned_count() == COUNT);
+    // Releasing some shapes leaves the others findable
+    for (size_t i = 0; i < COUNT; i += 3)
+    {
+        shape_release(shapes[i]);
+    }
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        vector_t triangle[] = {{0, 0}, {i + 1, 0}, {0, 1}};
+        shape_t *shape = shape_intern(triangle, 3);
+        if (i % 3 == 0)
+        {
+            assert(shape_refs(shape) == 1);
+            shapes[i] = shape;
+        }
+        else
+        {
+            assert(shape == shapes[i]);
+            shape_release(shape);
+        }
+    }
+    assert(shape_interned_count() == COUNT);
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        shape_release(shapes[i]);
+    }
+    assert(shape_interned_count() == 0);
+    free(shapes);
+}
+
+void test_shape_intern_polygon()
+{
+    vector_t centroid;
+    shape_t *shape =
+        shape_intern_polygon(sprite_make_rect(2, 6, 1, 3), &centroid);
+    assert(vec_isclose(centroid, (vector_t){4, 2}));
+    vector_t *vertices = shape_get_vertices(shape);
+    assert(vec_isclose(vertices[0], (vector_t){2, 1}));
+    assert(vec_isclose(vertices[2], (vector_t){-2, -1}));
+
+    // The same outline elsewhere shares the shape
+    shape_t *moved =
+        shape_intern_polygon(sprite_make_rect(12, 16, 11, 13), &centroid);
+    assert(moved == shape);
+    assert(vec_isclose(centroid, (vector_t){14, 12}));
+    shape_release(moved);
+    shape_release(shape);
+}
+
+void test_shape_intern_circle()
+{
+    shape_t *shape = shape_intern_circle(5, 16);
+    assert(shape_vertex_count(shape) == 16);
+    vector_t *vertices = shape_get_vertices(shape);
+    assert(vec_isclose(vertices[0], (vector_t){5, 0}));
+    for (size_t i = 0; i < 16; i++)
+    {
+        assert(isclose(vec_magnitude(vertices[i]), 5));
+    }
+    assert(shape_intern_circle(5, 16) == shape);
+    shape_t *larger = shape_intern_circle(6, 16);
+    assert(larger != shape);
+    shape_release(larger);
+    shape_release(shape);
+    shape_release(shape);
+    assert(shape_interned_count() == 0);
+}
+
+int main(int argc, char *argv[])
+{
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests)
+    {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_shape_intern_shares)
+    DO_TEST(test_shape_released_is_forgotten)
+    DO_TEST(test_shape_intern_many)
+    DO_TEST(test_shape_intern_polygon)
+    DO_TEST(test_shape_intern_circle)
+
+    puts("shape_test PASS");
+}
@@ -28,6 +28,48 @@ void test_make_rect()
     list_free(rect);
 }
 
+void test_make_circle_points()
+{
+    list_t *circle = sprite_make_circle_points(2, 4);
+    assert(list_size(circle) == 4);
+    assert(vec_isclose(*(vector_t *)list_get(circle, 0), (vector_t){2, 0}));
+    assert(vec_isclose(*(vector_t *)list_get(circle, 1), (vector_t){0, 2}));
+    assert(vec_isclose(*(vector_t *)list_get(circle, 3), (vector_t){0, -2}));
+    list_free(circle);
+}
+
+void test_circle_points_for_radius()
+{
+    assert(sprite_circle_points_for_radius(0) == SPRITE_CIRCLE_MIN_POINTS);
+    assert(sprite_circle_points_for_radius(1) == SPRITE_CIRCLE_MIN_POINTS);
+    assert(sprite_circle_points_for_radius(1e6) == SPRITE_CIRCLE_MAX_POINTS);
+    // Bigger circles never get fewer vertices
+    size_t last = 0;
+    for (double radius = 1; radius < 1000; radius *= 1.5)
+    {
+        size_t points = sprite_circle_points_for_radius(radius);
+        assert(points >= last);
+        // The edges stay within the allowed error, unless capped
+        assert(points == SPRITE_CIRCLE_MAX_POINTS ||
+               radius * (1 - cos(M_PI / points)) <=
+                   SPRITE_CIRCLE_MAX_ERROR + 1e-9);
+        last = points;
+    }
+}
+
+void test_fill_circle()
+{
+    vector_t vertices[6];
+    vector_t center = {10, 20};
+    sprite_fill_circle(vertices, 6, center, 3, M_PI / 2);
+    for (size_t i = 0; i < 6; i++)
+    {
+        double angle = M_PI / 2 + 2 * M_PI * i / 6;
+        vector_t expected = {10 + 3 * cos(angle), 20 + 3 * sin(angle)};
+        assert(vec_isclose(vertices[i], expected));
+    }
+}
+
 int main(int argc, char *argv[])
 {
     // Run all tests? True if there are no command-line arguments
@@ -41,6 +83,9 @@ int main(int argc, char *argv[])
 
     DO_TEST(test_make_star);
     DO_TEST(test_make_rect);
+    DO_TEST(test_make_circle_points);
+    DO_TEST(test_circle_points_for_radius);
+    DO_TEST(test_fill_circle);
 
     puts("make_star PASS");
 }
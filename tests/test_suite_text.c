@@ -1,7 +1,47 @@
 #include "test_util.h"
+#include "text.h"
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+
+void test_text_version()
+{
+    text_t *text = text_init("SCORE: ", VEC_ZERO, 10, 5, (vector_t){100, 30});
+    size_t version = text_get_version(text);
+
+    // Setting the same contents does not invalidate the text
+    text_set_numbers(text, 5);
+    assert(text_get_version(text) == version);
+    text_set_text_position(text, (vector_t){10, 10});
+    assert(text_get_version(text) == version);
+
+    text_set_numbers(text, 6);
+    assert(text_get_version(text) != version);
+    version = text_get_version(text);
+    text_set_words(text, "HEALTH: ");
+    assert(text_get_version(text) != version);
+
+    // Words rewritten in the same buffer are new words
+    char words[] = "LIVES: ";
+    text_set_words(text, words);
+    version = text_get_version(text);
+    strcpy(words, "LEVEL: ");
+    text_set_words(text, words);
+    assert(text_get_version(text) != version);
+    text_free(text);
+}
+
+void test_text_versions_unique()
+{
+    text_t *text1 = text_init("A", VEC_ZERO, 10, 0, (vector_t){100, 30});
+    text_t *text2 = text_init("A", VEC_ZERO, 10, 0, (vector_t){100, 30});
+    assert(text_get_version(text1) != text_get_version(text2));
+    text_set_numbers(text1, 1);
+    assert(text_get_version(text1) != text_get_version(text2));
+    text_free(text1);
+    text_free(text2);
+}
 
 int main(int argc, char *argv[])
 {
@@ -14,6 +54,8 @@ int main(int argc, char *argv[])
         read_testname(argv[1], testname, sizeof(testname));
     }
 
+    DO_TEST(test_text_version)
+    DO_TEST(test_text_versions_unique)
     // DO_TEST(test_make_star);
     // DO_TEST(test_make_rect);
 
@@ -0,0 +1,95 @@
+#include "asset_bundle.h"
+#include "asset_manifest.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Packs the assets listed in a manifest into a bundle (see asset_bundle.h),
+ * decoding images into RGBA pixels so the game never has to decode them.
+ * Run at build time:
+ *
+ *   bin/pack_assets game/assets.manifest game/assets.bundle
+ */
+
+/**
+ * Decodes an image into RGBA pixels, row by row with no padding.
+ * Returns NULL if the image cannot be loaded.
+ */
+void *decode_image(const char *path, int *width, int *height, size_t *size) {
+  SDL_Surface *image = IMG_Load(path);
+  if (image == NULL) {
+    return NULL;
+  }
+  SDL_Surface *rgba = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_RGBA32, 0);
+  SDL_FreeSurface(image);
+  if (rgba == NULL) {
+    return NULL;
+  }
+
+  size_t row_size = (size_t)rgba->w * 4;
+  uint8_t *pixels = malloc(row_size * rgba->h);
+  if (pixels != NULL) {
+    SDL_LockSurface(rgba);
+    for (int y = 0; y < rgba->h; y++) {
+      memcpy(pixels + y * row_size, (uint8_t *)rgba->pixels + y * rgba->pitch,
+             row_size);
+    }
+    SDL_UnlockSurface(rgba);
+    *width = rgba->w;
+    *height = rgba->h;
+    *size = row_size * rgba->h;
+  }
+  SDL_FreeSurface(rgba);
+  return pixels;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <manifest> <bundle>\n", argv[0]);
+    return 1;
+  }
+  asset_manifest_t *manifest = asset_manifest_load(argv[1]);
+  if (manifest == NULL) {
+    fprintf(stderr, "pack_assets: could not read %s\n", argv[1]);
+    return 1;
+  }
+  IMG_Init(IMG_INIT_PNG);
+
+  size_t count = asset_manifest_size(manifest);
+  bundle_asset_t *assets = calloc(count > 0 ? count : 1, sizeof(bundle_asset_t));
+  bool ok = assets != NULL;
+  for (size_t i = 0; i < count && ok; i++) {
+    bundle_asset_t *asset = &assets[i];
+    asset->type = asset_manifest_get_type(manifest, i);
+    asset->path = asset_manifest_get_path(manifest, i);
+    asset->data =
+        asset->type == ASSET_IMAGE
+            ? decode_image(asset->path, &asset->width, &asset->height,
+                           &asset->size)
+            : asset_read_file(asset->path, &asset->size);
+    if (asset->data == NULL) {
+      // A bundle missing an asset would silently fall back to the file
+      fprintf(stderr, "pack_assets: could not load %s: %s\n", asset->path,
+              SDL_GetError());
+      ok = false;
+    }
+  }
+  if (ok) {
+    ok = asset_bundle_write(argv[2], assets, count);
+  }
+  if (ok) {
+    printf("Packed %zu assets into %s\n", count, argv[2]);
+  }
+
+  for (size_t i = 0; i < count && assets != NULL; i++) {
+    free((void *)assets[i].data);
+  }
+  free(assets);
+  IMG_Quit();
+  asset_manifest_free(manifest);
+  return ok ? 0 : 1;
+}